@@ -0,0 +1,38 @@
+# (C) Copyright 2011- ECMWF.
+#
+# This software is licensed under the terms of the Apache Licence Version 2.0
+# which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+# In applying this licence, ECMWF does not waive the privileges and immunities
+# granted to it by virtue of its status as an intergovernmental organisation
+# nor does it submit to any jurisdiction.
+
+# - Try to find Zstandard (https://facebook.github.io/zstd)
+
+# Once done this will define
+#  ZSTD_FOUND        - System has Zstandard
+#  ZSTD_INCLUDE_DIRS - The Zstandard include directories
+#  ZSTD_LIBRARIES    - The libraries needed to use Zstandard
+#
+# The following paths will be searched with priority if set in CMake or env
+#
+#  ZSTD_DIR          - prefix path of the Zstandard installation
+#  ZSTD_PATH         - prefix path of the Zstandard installation
+
+find_path( ZSTD_INCLUDE_DIR zstd.h
+           PATHS ${ZSTD_DIR} ${ZSTD_PATH} ENV ZSTD_DIR ENV ZSTD_PATH
+           PATH_SUFFIXES include NO_DEFAULT_PATH )
+find_path( ZSTD_INCLUDE_DIR zstd.h PATH_SUFFIXES include )
+
+find_library( ZSTD_LIBRARY  NAMES zstd
+              PATHS ${ZSTD_DIR} ${ZSTD_PATH} ENV ZSTD_DIR ENV ZSTD_PATH
+              PATH_SUFFIXES lib lib64 NO_DEFAULT_PATH )
+find_library( ZSTD_LIBRARY NAMES zstd PATH_SUFFIXES lib lib64 )
+
+set( ZSTD_LIBRARIES    ${ZSTD_LIBRARY} )
+set( ZSTD_INCLUDE_DIRS ${ZSTD_INCLUDE_DIR} )
+
+include(FindPackageHandleStandardArgs)
+
+find_package_handle_standard_args(Zstd  DEFAULT_MSG ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
+
+mark_as_advanced(ZSTD_INCLUDE_DIR ZSTD_LIBRARY )
@@ -42,12 +42,10 @@ public:
 };
 
 template <class Traits, class Partition>
-class BSPTreeMemory : public BSPTreeX<TT<Traits, KDMemory>, Partition> {
-    KDMemory alloc_;
-
+class BSPTreeMemory : private KDMemoryHolder, public BSPTreeX<TT<Traits, KDMemory>, Partition> {
 public:
     BSPTreeMemory() :
-        BSPTreeX<TT<Traits, KDMemory>, Partition>(alloc_) {}
+        BSPTreeX<TT<Traits, KDMemory>, Partition>(memory_) {}
 };
 
 template <class Traits, class Partition>
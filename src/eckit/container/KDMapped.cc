@@ -26,8 +26,15 @@
 namespace eckit {
 
 
-KDMapped::KDMapped(const PathName& path, size_t itemCount, size_t itemSize, size_t metadataSize) :
-    path_(path), header_(itemCount, itemSize, metadataSize), size_(0), base_(0), root_(0), addr_(0), fd_(-1) {
+KDMapped::KDMapped(const PathName& path, size_t itemCount, size_t itemSize, size_t metadataSize, Layout layout) :
+    path_(path),
+    header_(itemCount, itemSize, metadataSize),
+    layout_(layout),
+    size_(0),
+    base_(0),
+    root_(0),
+    addr_(0),
+    fd_(-1) {
 
     int oflags = O_RDWR | O_CREAT;
     int mflags = PROT_READ | PROT_WRITE;
@@ -49,12 +56,23 @@ KDMapped::KDMapped(const PathName& path, size_t itemCount, size_t itemSize, size
 
         int n;
         SYSCALL(n = ::read(fd_, &header_, sizeof(header_)));
-        ASSERT(n == sizeof(header_));
+        ASSERT(n >= int(KDMappedHeader::HEADER_SIZE_V0));
         lseek(fd_, 0, SEEK_SET);
 
         root_ = 1;
 
-        ASSERT(header_.headerSize_ == sizeof(header_));
+        if (header_.headerSize_ == KDMappedHeader::HEADER_SIZE_V0) {
+            // unversioned header, nodes in creation order
+            header_.version_ = 0;
+            header_.layout_  = CREATION_ORDER;
+        }
+        else {
+            ASSERT(n == sizeof(header_));
+            ASSERT(header_.headerSize_ == sizeof(header_));
+            ASSERT(header_.version_ <= KDMappedHeader::VERSION);
+        }
+
+        layout_ = Layout(header_.layout_);
 
         base   = ((header_.headerSize_ + header_.metadataSize_ + header_.itemSize_ - 1) / header_.itemSize_) * header_.itemSize_;
         count_ = header_.itemCount_;
@@ -81,6 +99,30 @@ KDMapped::KDMapped(const PathName& path, size_t itemCount, size_t itemSize, size
     }
 
     base_ = reinterpret_cast<char*>(addr_) + base;
+
+    if (readonly_) {
+        prefetch();
+    }
+}
+
+
+void KDMapped::prefetch() {
+    if (layout_ != VAN_EMDE_BOAS || count_ == 0) {
+        return;
+    }
+
+    // the top half-height subtree is stored first, and every search goes through it
+    size_t levels = 0;
+    for (size_t n = count_; n > 0; n >>= 1) {
+        ++levels;
+    }
+
+    size_t top   = std::min(count_, (size_t(1) << ((levels + 1) / 2)) - 1);
+    size_t bytes = (base_ - reinterpret_cast<char*>(addr_)) + (top + 1) * header_.itemSize_;
+
+    if (::madvise(addr_, std::min(bytes, size_t(size_)), MADV_WILLNEED) != 0) {
+        Log::warning() << "KDMapped: madvise(" << path_ << ')' << Log::syserr << std::endl;
+    }
 }
 
 KDMapped::~KDMapped() {
@@ -96,6 +138,7 @@ KDMapped::~KDMapped() {
 KDMapped::KDMapped(const KDMapped& other) :
     path_(other.path_),
     header_(other.header_),
+    layout_(other.layout_),
     count_(other.count_),
     size_(other.size_),
     base_(other.base_),
@@ -116,6 +159,7 @@ KDMapped& KDMapped::operator=(const KDMapped& other) {
     root_  = other.root_;
 
     header_ = other.header_;
+    layout_ = other.layout_;
     base_   = other.base_;
 
     const_cast<KDMapped&>(other).addr_ = 0;
@@ -127,13 +171,13 @@ KDMapped& KDMapped::operator=(const KDMapped& other) {
 void KDMapped::setMetadata(const void* addr, size_t size) {
     ASSERT(size == header_.metadataSize_);
     char* start = static_cast<char*>(addr_);
-    ::memcpy(start + sizeof(header_), addr, size);
+    ::memcpy(start + header_.headerSize_, addr, size);
 }
 
 void KDMapped::getMetadata(void* addr, size_t size) {
     ASSERT(size == header_.metadataSize_);
     char* start = static_cast<char*>(addr_);
-    ::memcpy(addr, start + sizeof(header_), size);
+    ::memcpy(addr, start + header_.headerSize_, size);
 }
 
 
@@ -11,6 +11,10 @@
 #ifndef KDMapped_H
 #define KDMapped_H
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include "eckit/container/StatCollector.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
@@ -22,15 +26,32 @@ struct KDMappedHeader {
     size_t itemCount_;
     size_t itemSize_;
     size_t metadataSize_;
+    size_t version_;  ///< files written before versioning (shorter header) are version 0
+    size_t layout_;   ///< node layout (KDMapped::Layout)
+
+    static constexpr size_t VERSION        = 1;
+    static constexpr size_t HEADER_SIZE_V0 = 4 * sizeof(size_t);
 
     KDMappedHeader(size_t itemCount, size_t itemSize, size_t metadataSize) :
-        headerSize_(sizeof(KDMappedHeader)), itemCount_(itemCount), itemSize_(itemSize), metadataSize_(metadataSize) {}
+        headerSize_(sizeof(KDMappedHeader)),
+        itemCount_(itemCount),
+        itemSize_(itemSize),
+        metadataSize_(metadataSize),
+        version_(VERSION),
+        layout_(0) {}
 };
 
 
 class KDMapped : public StatCollector {
 public:
-    KDMapped(const PathName&, size_t itemCount, size_t itemSize, size_t metadataSize);
+    enum Layout : size_t
+    {
+        CREATION_ORDER = 0,  ///< nodes in the order they are created (pre-order, for a tree built at once)
+        VAN_EMDE_BOAS  = 1,  ///< cache-oblivious: top half-height subtree, then each bottom subtree, recursively
+    };
+
+    /// @param layout node layout to write (after a tree is built), for files opened for writing (itemCount > 0)
+    KDMapped(const PathName&, size_t itemCount, size_t itemSize, size_t metadataSize, Layout layout = CREATION_ORDER);
     ~KDMapped();
 
     KDMapped(const KDMapped& other);
@@ -85,6 +106,74 @@ public:
     }
 
 
+    /// Contiguous (uninitialised) storage for n nodes, to be constructed in-place
+    template <class Node>
+    Node* newNodes(size_t n, const Node* dummy) {
+        Node* r = base(dummy);
+        ASSERT(!readonly_);
+        ASSERT(count_ + n <= header_.itemCount_);
+        Node* p = &r[count_ + 1];
+        count_ += n;
+        return p;
+    }
+
+    /// Rewrite the nodes of a built tree in the requested layout, so that a root-to-leaf path touches few pages
+    template <class Node>
+    void finalise(Ptr root, const Node* dummy) {
+        if (layout_ != VAN_EMDE_BOAS || root == 0) {
+            return;
+        }
+
+        ASSERT(!readonly_);
+        ASSERT(root == 1);
+
+        Node* r = base(dummy);
+
+        // new position of each node
+        std::vector<Ptr> order;
+        order.reserve(count_);
+        vanEmdeBoas(&r[root], height(&r[root]), order);
+        ASSERT(order.size() == count_);
+
+        std::vector<Ptr> position(count_ + 1, 0);
+        for (size_t i = 0; i < order.size(); ++i) {
+            position[order[i]] = i + 1;
+        }
+
+        // update links (null links are unchanged, position[0] == 0)
+        auto moved = [&](Node* n) { return n ? &r[position[convert(n)]] : nullptr; };
+        for (Ptr p = 1; p <= count_; ++p) {
+            Node& n = r[p];
+            n.left(*this, moved(n.left(*this)));
+            n.right(*this, moved(n.right(*this)));
+            n.next(*this, moved(n.next(*this)));
+        }
+
+        // move nodes, following the cycles of the permutation
+        std::vector<bool> done(count_ + 1, false);
+        std::vector<char> node(sizeof(Node));
+        std::vector<char> swap(sizeof(Node));
+        for (Ptr p = 1; p <= count_; ++p) {
+            if (done[p] || position[p] == p) {
+                continue;
+            }
+            ::memcpy(node.data(), &r[p], sizeof(Node));
+            Ptr q = p;
+            do {
+                q = position[q];
+                ::memcpy(swap.data(), &r[q], sizeof(Node));
+                ::memcpy(static_cast<void*>(&r[q]), node.data(), sizeof(Node));
+                node.swap(swap);
+                done[q] = true;
+            } while (q != p);
+        }
+
+        header_.layout_ = layout_;
+        reinterpret_cast<KDMappedHeader*>(addr_)->layout_ = layout_;
+    }
+
+    Layout layout() const { return Layout(header_.layout_); }
+
     template <class Node>
     void deleteNode(Ptr p, Node* n) {
         // Ignore
@@ -107,9 +196,52 @@ public:
     size_t nbItems() const { return count_; }
 
 private:
+    template <class Node>
+    size_t height(Node* n) {
+        return n ? 1 + std::max(height(n->left(*this)), height(n->right(*this))) : 0;
+    }
+
+    template <class Node>
+    void vanEmdeBoas(Node* n, size_t levels, std::vector<Ptr>& order) {
+        if (n == nullptr) {
+            return;
+        }
+
+        if (levels == 1) {
+            order.push_back(convert(n));
+            return;
+        }
+
+        size_t top = levels / 2;
+        vanEmdeBoas(n, top, order);
+
+        std::vector<Node*> bottom;
+        subtrees(n, top, bottom);
+        for (auto* b : bottom) {
+            vanEmdeBoas(b, levels - top, order);
+        }
+    }
+
+    /// Roots of the subtrees starting at depth (left to right)
+    template <class Node>
+    void subtrees(Node* n, size_t depth, std::vector<Node*>& roots) {
+        if (n == nullptr) {
+            return;
+        }
+        if (depth == 0) {
+            roots.push_back(n);
+            return;
+        }
+        subtrees(n->left(*this), depth - 1, roots);
+        subtrees(n->right(*this), depth - 1, roots);
+    }
+
+    void prefetch();
+
     PathName path_;
 
     KDMappedHeader header_;
+    Layout layout_;
 
     size_t count_{0};
     bool readonly_{true};
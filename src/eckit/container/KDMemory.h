@@ -15,6 +15,10 @@
 
 #include <cmath>
 #include <limits>
+#include <map>
+#include <memory>
+#include <new>
+#include <vector>
 
 #include "eckit/container/StatCollector.h"
 
@@ -58,13 +62,31 @@ struct KDMemory : public StatCollector {
         return new Node(a, b, c);
     }
 
+    /// Contiguous (uninitialised) storage for n nodes, to be constructed in-place
+    template <class Node>
+    Node* newNodes(size_t n, const Node*) {
+        const size_t size = n * sizeof(Node);
+        std::shared_ptr<char> data(static_cast<char*>(::operator new(size)), [](char* p) { ::operator delete(p); });
+        arenas_.emplace(data.get(), Arena{data, size});
+        nbItems_ += n;
+        return reinterpret_cast<Node*>(data.get());
+    }
+
+    template <class Node>
+    void finalise(Ptr, const Node*) {}
+
     template <class Node>
     void deleteNode(Ptr p, const Node*) {
         Node* n = static_cast<Node*>(p);
         if (n) {
             deleteNode(n->left(*this), n);
             deleteNode(n->right(*this), n);
-            delete n;
+            if (inArena(n)) {
+                n->~Node();
+            }
+            else {
+                delete n;
+            }
             nbItems_--;
         }
     }
@@ -72,7 +94,30 @@ struct KDMemory : public StatCollector {
     size_t nbItems() const { return nbItems_; }
 
 private:
+    bool inArena(const void* p) const {
+        // The arena starting at or before p
+        auto a = arenas_.upper_bound(static_cast<const char*>(p));
+        if (a == arenas_.begin()) {
+            return false;
+        }
+        --a;
+        return static_cast<const char*>(p) < a->first + a->second.size;
+    }
+
+    struct Arena {
+        std::shared_ptr<char> data;
+        size_t size;
+    };
+
     size_t nbItems_{0};
+    /// Storage from newNodes, by address, released with the last copy of the allocator
+    std::map<const char*, Arena> arenas_;
+};
+
+/// Allocator of the in-memory trees, as their first base class, so that it is constructed before and destroyed after
+/// the SPTree base class, which uses it
+struct KDMemoryHolder {
+    KDMemory memory_;
 };
 
 template <class T, class A>
@@ -35,13 +35,14 @@ public:
     KDTreeX(Alloc& alloc) :
         SPTreeType(alloc) {}
 
-    /// ITER must be a random access iterator
+    /// ITER must be a random access iterator, nodes are stored contiguously and large trees are built in parallel
     /// WARNING: container is changed (sorted)
     template <typename ITER>
     void build(ITER begin, ITER end) {
         Alloc& a    = this->alloc_;
         this->root_ = a.convert(Node::build(a, begin, end));
         a.root(this->root_);
+        a.finalise(this->root_, (Node*)0);
     }
 
     /// Container must be a random access
@@ -67,9 +68,7 @@ public:
 
 
 template <class Traits>
-class KDTreeMemory : public KDTreeX<TT<Traits, KDMemory> > {
-    KDMemory alloc_;
-
+class KDTreeMemory : private KDMemoryHolder, public KDTreeX<TT<Traits, KDMemory> > {
 public:
     typedef KDTreeX<TT<Traits, KDMemory> > KDTree;
     typedef typename KDTree::Value Value;
@@ -78,7 +77,7 @@ public:
 
 public:
     KDTreeMemory() :
-        KDTree(alloc_) {}
+        KDTree(memory_) {}
 };
 
 template <class Traits>
@@ -93,8 +92,9 @@ public:
     typedef typename KDTree::Node Node;
 
 public:
-    KDTreeMapped(const eckit::PathName& path, size_t itemCount, size_t metadataSize) :
-        KDTree(alloc_), alloc_(path, itemCount, sizeof(Node), metadataSize) {}
+    KDTreeMapped(const eckit::PathName& path, size_t itemCount, size_t metadataSize,
+                 KDMapped::Layout layout = KDMapped::CREATION_ORDER) :
+        KDTree(alloc_), alloc_(path, itemCount, sizeof(Node), metadataSize, layout) {}
 };
 
 }  // namespace eckit
@@ -0,0 +1,329 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_container_MPMCQueue_h
+#define eckit_container_MPMCQueue_h
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Bounded multi-producer multi-consumer queue, lock-free on its fast path, with the semantics of eckit::Queue
+///
+/// Elements are stored in a ring buffer of cells, each tagged with a sequence number telling whether it can be written
+/// or read at a given position (D. Vyukov's bounded MPMC queue), so producers and consumers only contend on one atomic
+/// increment each. A thread that finds the queue full (or empty) spins for a while, then parks on a condition variable;
+/// the number of spins adapts to how long waits usually are. The mutex is only taken to park, or to wake parked
+/// threads.
+///
+/// @note capacity is rounded up to a power of 2 (at least 2), and cannot be changed (there is no resize)
+/// @note as with eckit::Queue, pushing to a closed queue is an error; close() after all pushes are complete
+template <typename ELEM>
+class MPMCQueue {
+
+public:  // public
+    MPMCQueue(size_t max) :
+        mask_(capacity(max) - 1),
+        cells_(new Cell[mask_ + 1]),
+        enqueuePos_(0),
+        dequeuePos_(0),
+        spins_(minSpins),
+        producersWaiting_(0),
+        consumersWaiting_(0),
+        interrupted_(false),
+        closed_(false) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence_.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&)            = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    MPMCQueue(MPMCQueue&& rhs)            = delete;
+    MPMCQueue& operator=(MPMCQueue&& rhs) = delete;
+
+    ~MPMCQueue() {
+        for (auto pos = dequeuePos_.load(); pos != enqueuePos_.load(); ++pos) {
+            Cell& cell = cells_[pos & mask_];
+            if (cell.sequence_.load() == pos + 1) {
+                cell.element()->~ELEM();
+            }
+        }
+    }
+
+    size_t maxSize() const { return mask_ + 1; }
+
+    void close() {
+        closed_.store(true, std::memory_order_seq_cst);
+        wakeAll();
+    }
+
+    bool closed() const {
+        return closed_.load(std::memory_order_acquire) || interrupted_.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+    /// @returns approximate number of elements (exact when there are no concurrent operations)
+    size_t size() const {
+        auto out = dequeuePos_.load(std::memory_order_acquire);
+        auto in  = enqueuePos_.load(std::memory_order_acquire);
+        return in > out ? std::min(in - out, maxSize()) : 0;
+    }
+
+    bool checkInterrupt() {
+        if (interrupted_.load(std::memory_order_acquire)) {
+            std::rethrow_exception(interrupt_);  // set before interrupted_, and not modified after
+        }
+        return true;
+    }
+
+    void interrupt(std::exception_ptr expn) {
+        {
+            std::lock_guard<std::mutex> locker(mutex_);
+            interrupt_ = expn;
+        }
+        interrupted_.store(true, std::memory_order_seq_cst);
+        wakeAll();
+    }
+
+    /// @returns the (approximate) number of elements left, or -1 if the queue is closed and empty
+    long pop(ELEM& e) {
+        if (!wait([&] { return tryPop(e); }, consumersWaiting_, consumers_, true)) {
+            return -1;
+        }
+        wake(producersWaiting_, producers_);
+        return long(size());
+    }
+
+    /// Pop as many elements as available (up to the vector size), waiting only for the first
+    /// @returns the number of elements popped, or -1 if the queue is closed and empty
+    long pop(std::vector<ELEM>& elems) {
+        if (elems.empty()) {
+            return 0;
+        }
+
+        if (!wait([&] { return tryPop(elems[0]); }, consumersWaiting_, consumers_, true)) {
+            return -1;
+        }
+
+        long count = 1;
+        while (size_t(count) < elems.size() && tryPop(elems[count])) {
+            ++count;
+        }
+
+        wake(producersWaiting_, producers_);
+        return count;
+    }
+
+    /// @returns the (approximate) number of elements in the queue
+    size_t push(const ELEM& e) { return emplace(e); }
+
+    template <typename... Args>
+    size_t emplace(Args&&... args) {
+        ASSERT(!closed_.load(std::memory_order_relaxed));
+        wait([&] { return tryEmplace(std::forward<Args>(args)...); }, producersWaiting_, producers_, false);
+        wake(consumersWaiting_, consumers_);
+        return std::max(size(), size_t(1));
+    }
+
+    /// Non-blocking push, @returns false if the queue is full
+    template <typename... Args>
+    bool tryEmplace(Args&&... args) {
+        Cell* cell;
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell     = &cells_[pos & mask_];
+            auto seq = cell->sequence_.load(std::memory_order_acquire);
+            auto dif = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (dif == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (dif < 0) {
+                return false;  // full
+            }
+            else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (cell->storage_) ELEM(std::forward<Args>(args)...);
+        cell->sequence_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Non-blocking pop, @returns false if the queue is empty
+    bool tryPop(ELEM& e) {
+        Cell* cell;
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell     = &cells_[pos & mask_];
+            auto seq = cell->sequence_.load(std::memory_order_acquire);
+            auto dif = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (dif == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (dif < 0) {
+                return false;  // empty
+            }
+            else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        ELEM* elem = cell->element();
+        e          = std::move(*elem);
+        elem->~ELEM();
+        cell->sequence_.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+private:  // types
+    static constexpr size_t cacheLine = 64;
+    static constexpr size_t minSpins  = 16;
+    static constexpr size_t maxSpins  = 4096;
+
+    struct Cell {
+        std::atomic<size_t> sequence_;
+        alignas(ELEM) unsigned char storage_[sizeof(ELEM)];
+
+        ELEM* element() { return std::launder(reinterpret_cast<ELEM*>(storage_)); }
+    };
+
+private:  // methods
+    static size_t capacity(size_t max) {
+        ASSERT(max > 0);
+        size_t n = 2;  // sequence numbers cannot tell a full from an empty cell with a single cell
+        while (n < max) {
+            n <<= 1;
+        }
+        return n;
+    }
+
+    static void relax(size_t spin) {
+        if (spin < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield" ::: "memory");
+#endif
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+
+    /// Try an operation, spinning then parking until it succeeds
+    /// @returns false if the queue is closed (only if closing ends the wait)
+    template <typename Operation>
+    bool wait(Operation op, std::atomic<size_t>& waiting, std::condition_variable& cv, bool endOnClose) {
+        const size_t spins = spins_.load(std::memory_order_relaxed);
+
+        for (size_t spin = 0; spin < spins; ++spin) {
+            checkInterrupt();
+            if (op()) {
+                adapt(spins, spin);
+                return true;
+            }
+            if (endOnClose && closed_.load(std::memory_order_acquire)) {
+                return op();  // drain elements pushed before closing
+            }
+            relax(spin);
+        }
+
+        adapt(spins, spins);
+
+        // park: the counter is incremented before retrying the operation, and the other side checks it after
+        // completing its own, so either the retry succeeds or the other side sees a waiter and notifies it
+        std::unique_lock<std::mutex> locker(mutex_);
+        waiting.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        bool result = true;
+        while (!op()) {
+            if (interrupted_.load(std::memory_order_acquire)) {
+                waiting.fetch_sub(1, std::memory_order_relaxed);
+                std::rethrow_exception(interrupt_);
+            }
+            if (endOnClose && closed_.load(std::memory_order_acquire)) {
+                result = op();
+                break;
+            }
+            cv.wait(locker);
+        }
+
+        waiting.fetch_sub(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    /// Wait longer if waits are usually short enough to succeed while spinning, shorter otherwise
+    void adapt(size_t spins, size_t spun) {
+        size_t target = spun < spins ? std::min(2 * spins, maxSpins) : std::max(spins / 2, minSpins);
+        if (target != spins) {
+            spins_.store(target, std::memory_order_relaxed);
+        }
+    }
+
+    void wake(std::atomic<size_t>& waiting, std::condition_variable& cv) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> locker(mutex_);
+            cv.notify_all();
+        }
+    }
+
+    void wakeAll() {
+        std::lock_guard<std::mutex> locker(mutex_);
+        producers_.notify_all();
+        consumers_.notify_all();
+    }
+
+private:  // members
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    alignas(cacheLine) std::atomic<size_t> enqueuePos_;
+    alignas(cacheLine) std::atomic<size_t> dequeuePos_;
+    alignas(cacheLine) std::atomic<size_t> spins_;
+
+    std::atomic<size_t> producersWaiting_;
+    std::atomic<size_t> consumersWaiting_;
+
+    std::mutex mutex_;
+    std::condition_variable producers_;
+    std::condition_variable consumers_;
+
+    std::exception_ptr interrupt_;
+    std::atomic<bool> interrupted_;
+    std::atomic<bool> closed_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif  // eckit_container_MPMCQueue_h
@@ -37,17 +37,37 @@ struct StatCollector {
 
     // -- Methods
 
-    void statsCall() { calls_++; }
-    void statsVisitNode() { nodes_++; }
+    void statsCall(size_t n = 1) { calls_ += n; }
+    void statsVisitNode() {
+        if (statsEnabled_) {
+            nodes_++;
+        }
+    }
     void statsDepth(size_t d) {
         if (d > depth_) {
             depth_ = d;
         }
     }
 
-    void statsNewCandidateOK() { newCandidateOK_++; }
-    void statsNewCandidateMiss() { newCandidateMiss_++; }
-    void statsCrossOver() { crossOvers_++; }
+    void statsNewCandidateOK() {
+        if (statsEnabled_) {
+            newCandidateOK_++;
+        }
+    }
+    void statsNewCandidateMiss() {
+        if (statsEnabled_) {
+            newCandidateMiss_++;
+        }
+    }
+    void statsCrossOver() {
+        if (statsEnabled_) {
+            crossOvers_++;
+        }
+    }
+
+    /// Suspend/resume collecting per-node statistics (counters are not thread-safe, e.g. for concurrent queries)
+    void statsEnabled(bool enabled) { statsEnabled_ = enabled; }
+    bool statsEnabled() const { return statsEnabled_; }
     void statsReset() { crossOvers_ = calls_ = newCandidateOK_ = newCandidateMiss_ = nodes_ = 0; }
 
     void print(std::ostream& s) const {
@@ -80,6 +100,8 @@ struct StatCollector {
     size_t newCandidateOK_;
     size_t crossOvers_;
 
+    bool statsEnabled_{true};
+
 
     // -- Friends
 
@@ -89,6 +111,21 @@ struct StatCollector {
     }
 };
 
+/// Suspends collecting statistics for its lifetime, restoring them even if an exception is thrown
+class StatsSuspended {
+public:
+    explicit StatsSuspended(StatCollector& stats) :
+        stats_(stats), enabled_(stats.statsEnabled()) {
+        stats_.statsEnabled(false);
+    }
+
+    ~StatsSuspended() { stats_.statsEnabled(enabled_); }
+
+private:
+    StatCollector& stats_;
+    bool enabled_;
+};
+
 //-----------------------------------------------------------------------------
 //
 }  // namespace eckit
@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <cstdio>
 #include <limits>
+#include <new>
 
 #include "KDNode.h"
 
@@ -133,14 +134,36 @@ KDNode<Traits>* KDNode<Traits>::build(Alloc& a, const ITER& begin, const ITER& e
     if (end == begin)
         return 0;
 
-    a.statsDepth(depth);
+    // Nodes are stored in the order a recursive build would create them: the median, then the left and right
+    // subtrees; subtree storage is known in advance, so subtrees can be built concurrently
+    size_t size   = end - begin;
+    KDNode* nodes = a.newNodes(size, (KDNode*)0);
 
+    // median splits halve ranges, so the deepest node is at depth + floor(log2(size))
+    size_t levels = 0;
+    for (size_t s = size; s > 1; s /= 2) {
+        ++levels;
+    }
+    a.statsDepth(depth + levels);
+
+    // This file is compiled by the users of the trees, so test the compiler's OpenMP rather than eckit's
+#ifdef _OPENMP
+#pragma omp parallel
+#pragma omp single
+#endif
+    build(&a, nodes, begin, end, depth);
+
+    return nodes;
+}
+
+
+template <class Traits>
+template <typename ITER>
+void KDNode<Traits>::build(Alloc* a, KDNode* node, ITER begin, ITER end, int depth) {
     // size_t k    = Point::size(*begin);
     size_t k    = Point::DIMS;
     size_t axis = depth % k;
 
-    // std::sort(begin, end, sorter<Point>(axis));
-
     size_t median = (end - begin) / 2;
 
     std::nth_element(begin, begin + median, end, sorter<Value>(axis));
@@ -148,13 +171,25 @@ KDNode<Traits>* KDNode<Traits>::build(Alloc& a, const ITER& begin, const ITER& e
     ITER e2 = begin + median;
     ITER b2 = begin + median + 1;
 
+    new (node) KDNode(*e2, axis);
 
-    KDNode* n = a.newNode2(*e2, axis, (KDNode*)0);
+    KDNode* left  = e2 != begin ? node + 1 : 0;
+    KDNode* right = b2 != end ? node + 1 + median : 0;
 
-    n->left(a, build(a, begin, e2, depth + 1));
-    n->right(a, build(a, b2, end, depth + 1));
+    node->left(*a, left);
+    node->right(*a, right);
 
-    return n;
+    if (left) {
+#ifdef _OPENMP
+        constexpr size_t minimumTaskSize = 1 << 14;
+#pragma omp task if (median > minimumTaskSize)
+#endif
+        build(a, left, begin, e2, depth + 1);
+    }
+
+    if (right) {
+        build(a, right, b2, end, depth + 1);
+    }
 }
 
 
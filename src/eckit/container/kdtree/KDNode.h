@@ -39,6 +39,7 @@ public:
     KDNode(const Value& value, size_t axis);
     ~KDNode() {}
 
+    /// Build a balanced tree (median splits), with nodes stored contiguously in pre-order
     template <typename ITER>
     static KDNode* build(Alloc& a, const ITER& begin, const ITER& end, int depth = 0);
 
@@ -47,6 +48,10 @@ public:
     /// Return the axis along which this node is split.
     size_t axis() const { return axis_; }
 
+private:
+    template <typename ITER>
+    static void build(Alloc* a, KDNode* node, ITER begin, ITER end, int depth);
+
 public:
     void nearestNeighbourX(Alloc& a, const Point& p, Node*& best, double& max, int depth);
     void findInSphereX(Alloc& a, const Point& p, double radius, NodeList& result, int depth);
@@ -13,7 +13,7 @@
 
 #include <algorithm>
 #include <limits>
-#include <queue>
+#include <vector>
 
 
 namespace eckit {
@@ -46,31 +46,39 @@ public:
 
 private:
     size_t k_;
-    std::priority_queue<NodeInfo> queue_;
+    std::vector<NodeInfo> queue_;  ///< max-heap on distance, storage is kept across reset()
 
 public:
     SPNodeQueue(size_t k) :
         k_(k) {}
 
     void push(Node* n, ID id, double d) {
-        NodeInfo info(n, id, d);
-        queue_.push(info);
+        queue_.emplace_back(n, id, d);
+        std::push_heap(queue_.begin(), queue_.end());
         while (queue_.size() > k_) {
-            queue_.pop();
+            std::pop_heap(queue_.begin(), queue_.end());
+            queue_.pop_back();
         }
     }
 
-    double largest() const { return queue_.size() ? queue_.top().distance_ : std::numeric_limits<double>::max(); }
+    double largest() const { return queue_.size() ? queue_.front().distance_ : std::numeric_limits<double>::max(); }
 
     void fill(NodeList& v) {
         v.reserve(k_);
         while (!queue_.empty()) {
-            v.push_back(queue_.top());
-            queue_.pop();
+            std::pop_heap(queue_.begin(), queue_.end());
+            v.push_back(queue_.back());
+            queue_.pop_back();
         }
         std::sort(v.begin(), v.end());
     }
 
+    /// Empty the queue for another query (keeping the allocated storage)
+    void reset(size_t k) {
+        k_ = k;
+        queue_.clear();
+    }
+
     bool incomplete() const { return queue_.size() < k_; }
 };
 
@@ -11,10 +11,22 @@
 #ifndef SPTree_H
 #define SPTree_H
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "eckit/container/StatCollector.h"
 #include "eckit/container/sptree/SPIterator.h"
 #include "eckit/container/sptree/SPMetadata.h"
 #include "eckit/container/sptree/SPNode.h"
 #include "eckit/exception/Exceptions.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/thread/Mutex.h"
 
 namespace eckit {
 
@@ -93,6 +105,119 @@ public:
         return alloc_.convert(root_, (Node*)0)->kNearestNeighbours(alloc_, p, k);
     }
 
+    /// k nearest neighbours of each point in [begin, end), queries run in parallel
+    /// @param result sized (end - begin) * k, neighbours of the i-th point are at [i * k, (i + 1) * k), sorted by
+    ///        distance (if the tree has less than k points, remaining entries have a null node and maximum distance)
+    /// @param sort process points in space-filling curve order, so consecutive queries visit similar nodes
+    template <typename ITER>
+    void kNearestNeighbours(ITER begin, ITER end, size_t k, NodeInfo* result, bool sort = true) {
+        if (!root_) {
+            root_ = alloc_.root();
+        }
+        ASSERT(root_);
+
+        const size_t n   = end - begin;
+        const auto order = queryOrder(begin, end, sort);
+        Node* root       = alloc_.convert(root_, (Node*)0);
+
+        alloc_.statsCall(n);
+        StatsSuspended suspended(alloc_);
+        ParallelErrors errors;
+
+        // This header is compiled by the users of the trees, so test the compiler's OpenMP rather than eckit's
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            typename Node::NodeQueue queue(k);
+            NodeList found;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+            for (size_t j = 0; j < n; ++j) {
+                errors.run([&] {
+                    const auto i = order[j];
+
+                    queue.reset(k);
+                    found.clear();
+                    root->kNearestNeighboursX(alloc_, begin[i], k, queue, 0);
+                    queue.fill(found);
+
+                    auto* r = result + i * k;
+                    std::copy(found.begin(), found.end(), r);
+                    std::fill(r + found.size(), r + k, NodeInfo(nullptr, ID(), std::numeric_limits<double>::max()));
+                });
+            }
+        }
+
+        errors.rethrow();
+    }
+
+    /// Points within radius of each point in [begin, end), queries run in parallel
+    /// @param offsets sized (end - begin) + 1, points found for the i-th point are at [offsets[i], offsets[i + 1])
+    /// @param result points found, for each point sorted by distance
+    /// @param sort process points in space-filling curve order, so consecutive queries visit similar nodes
+    template <typename ITER>
+    void findInSphere(ITER begin, ITER end, double radius, std::vector<size_t>& offsets, NodeList& result,
+                      bool sort = true) {
+        if (!root_) {
+            root_ = alloc_.root();
+        }
+        ASSERT(root_);
+
+        const size_t n   = end - begin;
+        const auto order = queryOrder(begin, end, sort);
+        Node* root       = alloc_.convert(root_, (Node*)0);
+
+        offsets.assign(n + 1, 0);
+
+        alloc_.statsCall(n);
+        StatsSuspended suspended(alloc_);
+        ParallelErrors errors;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            NodeList found;
+            NodeList local;                                  // results of the points queried by this thread
+            std::vector<std::pair<size_t, size_t>> queries;  // point and start of its results in local
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+            for (size_t j = 0; j < n; ++j) {
+                errors.run([&] {
+                    const auto i = order[j];
+
+                    found.clear();
+                    root->findInSphereX(alloc_, begin[i], radius, found, 0);
+                    std::sort(found.begin(), found.end());
+
+                    queries.emplace_back(i, local.size());
+                    local.insert(local.end(), found.begin(), found.end());
+                    offsets[i + 1] = found.size();
+                });
+            }
+
+#ifdef _OPENMP
+#pragma omp single
+#endif
+            {
+                std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+                result.resize(offsets.back());
+            }
+
+            for (const auto& [i, start] : queries) {
+                std::copy(local.begin() + start, local.begin() + start + (offsets[i + 1] - offsets[i]),
+                          result.begin() + offsets[i]);
+            }
+        }
+
+        errors.rethrow();
+    }
+
     // For testing only...
     NodeInfo nearestNeighbourBruteForce(const Point& p) {
         if (!root_) {
@@ -162,6 +287,91 @@ public:
     bool empty() const { return size() == 0; }
 
     size_t size() const { return alloc_.nbItems(); }
+
+private:
+    /// Keeps the first exception thrown by the threads of a parallel region, to rethrow it after the region (an
+    /// exception leaving an OpenMP region terminates the program, without unwinding the caller)
+    class ParallelErrors {
+    public:
+        /// Runs f, unless an exception was already thrown
+        template <typename F>
+        void run(F f) {
+            if (failed_) {
+                return;
+            }
+            try {
+                f();
+            }
+            catch (...) {
+                AutoLock<Mutex> lock(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                failed_ = true;
+            }
+        }
+
+        void rethrow() const {
+            if (error_) {
+                std::rethrow_exception(error_);
+            }
+        }
+
+    private:
+        std::atomic<bool> failed_{false};
+        std::exception_ptr error_;
+        Mutex mutex_;
+    };
+
+    /// Order to process query points: as given, or sorted along a space-filling (Morton, or Z-order) curve
+    template <typename ITER>
+    static std::vector<size_t> queryOrder(ITER begin, ITER end, bool sort) {
+        const size_t n = end - begin;
+
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        if (!sort || n < 2) {
+            return order;
+        }
+
+        constexpr size_t dims = Point::DIMS;
+        constexpr size_t bits = 63 / dims;
+
+        std::vector<double> min(dims, std::numeric_limits<double>::max());
+        std::vector<double> max(dims, std::numeric_limits<double>::lowest());
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t d = 0; d < dims; ++d) {
+                min[d] = std::min(min[d], begin[i].x(d));
+                max[d] = std::max(max[d], begin[i].x(d));
+            }
+        }
+
+        std::vector<std::uint64_t> code(n);
+        ParallelErrors errors;
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (size_t i = 0; i < n; ++i) {
+            errors.run([&] {
+                std::uint64_t c = 0;
+                for (size_t d = 0; d < dims; ++d) {
+                    const double range = max[d] - min[d];
+                    const double scale = range > 0 ? (begin[i].x(d) - min[d]) / range : 0;
+                    const auto q       = static_cast<std::uint64_t>(scale * double((std::uint64_t(1) << bits) - 1));
+                    for (size_t b = 0; b < bits; ++b) {
+                        c |= ((q >> b) & 1) << (b * dims + d);
+                    }
+                }
+                code[i] = c;
+            });
+        }
+
+        errors.rethrow();
+
+        std::sort(order.begin(), order.end(), [&code](size_t a, size_t b) { return code[a] < code[b]; });
+        return order;
+    }
 };
 
 }  // namespace eckit
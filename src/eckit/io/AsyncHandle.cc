@@ -38,7 +38,7 @@ public:
 
 void AsyncHandleWriter::run() {
     while (!stopped()) {
-        Buffer* delme = nullptr;
+        PooledBuffer done;  // returned to the pool once written, outside the lock
         try {
             AutoLock<MutexCond> lock(owner_.cond_);
             while (owner_.buffers_.empty() && !stopped()) {
@@ -51,12 +51,12 @@ void AsyncHandleWriter::run() {
 
             ASSERT(!owner_.buffers_.empty());
 
-            std::pair<size_t, Buffer*> p = owner_.buffers_.front();
+            std::pair<size_t, PooledBuffer> p = std::move(owner_.buffers_.front());
             owner_.buffers_.pop_front();
-            owner_.used_ -= p.second->size();
-            delme = p.second;
+            owner_.used_ -= p.second.size();
+            done = std::move(p.second);
 
-            long written = owner_.handle().write(p.second->data(), p.first);
+            long written = owner_.handle().write(done.data(), p.first);
             if (written != static_cast<long>(p.first)) {
                 std::ostringstream oss;
                 oss << "AsyncHandleWriter: written " << written << " out of " << p.first << Log::syserr;
@@ -71,8 +71,6 @@ void AsyncHandleWriter::run() {
             owner_.error_ = e.what();
             owner_.cond_.signal();
         }
-        delete delme;
-        delme = nullptr;
     }
 }
 
@@ -99,10 +97,7 @@ AsyncHandle::AsyncHandle(DataHandle& h, size_t maxSize, size_t rounding) :
 AsyncHandle::~AsyncHandle() {
     {
         AutoLock<MutexCond> lock(cond_);
-        while (!buffers_.empty()) {
-            delete buffers_.front().second;
-            buffers_.pop_front();
-        }
+        buffers_.clear();
         cond_.signal();
     }
 
@@ -136,10 +131,14 @@ long AsyncHandle::read(void*, long) {
 }
 
 long AsyncHandle::write(const void* buffer, long length) {
-    AutoLock<MutexCond> lock(cond_);
-
     size_t size = eckit::round(length, rounding_);
 
+    // Not under the lock, the pool may wait for the writer to release buffers
+    PooledBuffer copy(size);
+    ::memcpy(copy.data(), buffer, length);
+
+    AutoLock<MutexCond> lock(cond_);
+
     while (used_ + size >= maxSize_ && !error_) {
         // Special case for size > maxSize_
         if (buffers_.empty()) {
@@ -152,9 +151,7 @@ long AsyncHandle::write(const void* buffer, long length) {
         throw WriteError(message_);
     }
 
-    std::pair<size_t, Buffer*> p(length, new Buffer(size));
-    ::memcpy(p.second->data(), buffer, length);
-    buffers_.push_back(p);
+    buffers_.emplace_back(length, std::move(copy));
     used_ += size;
 
     cond_.signal();
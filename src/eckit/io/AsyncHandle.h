@@ -16,7 +16,7 @@
 
 #include <deque>
 
-#include "eckit/io/Buffer.h"
+#include "eckit/io/BufferPool.h"
 #include "eckit/io/HandleHolder.h"
 #include "eckit/thread/MutexCond.h"
 #include "eckit/thread/ThreadControler.h"
@@ -89,7 +89,7 @@ private:  // members
 
     MutexCond cond_;
 
-    std::deque<std::pair<size_t, Buffer*> > buffers_;
+    std::deque<std::pair<size_t, PooledBuffer> > buffers_;
 
     ThreadControler thread_;  // must be last
 
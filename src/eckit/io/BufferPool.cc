@@ -0,0 +1,250 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <ostream>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/BufferPool.h"
+#include "eckit/memory/MMap.h"
+#include "eckit/thread/AutoLock.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr size_t MIN_CLASS_SHIFT = 12;  // 4 KiB
+constexpr size_t MAX_CLASS_SHIFT = 30;  // 1 GiB
+constexpr size_t HUGE_PAGE_SIZE  = 2 * 1024 * 1024;
+
+/// @returns size class of a request, MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1 if too large to be pooled
+size_t sizeClass(size_t size) {
+    size_t shift = MIN_CLASS_SHIFT;
+    while (shift <= MAX_CLASS_SHIFT && (size_t(1) << shift) < size) {
+        ++shift;
+    }
+    return shift - MIN_CLASS_SHIFT;
+}
+
+constexpr size_t CLASSES = MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1;
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void BufferPool::Statistics::print(std::ostream& s) const {
+    s << "BufferPool[acquired=" << acquired_ << ",reused=" << reused_ << ",allocated=" << allocated_
+      << ",freed=" << freed_ << ",waits=" << waits_ << ",inUse=" << inUse_ << ",retained=" << retained_
+      << ",reuseRatio=" << reuseRatio() << "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+BufferPool::BufferPool(size_t capacity, size_t retained, size_t alignment, bool hugePages, size_t largest) :
+    capacity_(capacity),
+    retained_(retained),
+    alignment_(std::max(alignment, sizeof(void*))),
+    hugePages_(hugePages),
+    largest_(largest),
+    allocatedBytes_(0),
+    free_(CLASSES) {
+    ASSERT((alignment_ & (alignment_ - 1)) == 0);
+}
+
+BufferPool::~BufferPool() {
+    AutoLock<MutexCond> lock(cond_);
+    ASSERT(stats_.inUse_ == 0);
+    trim(0);
+}
+
+BufferPool& BufferPool::instance() {
+    static size_t capacity  = Resource<size_t>("bufferPoolCapacity;$ECKIT_BUFFER_POOL_CAPACITY", 0);
+    static size_t retained  = Resource<size_t>("bufferPoolRetained;$ECKIT_BUFFER_POOL_RETAINED", 64 * 1024 * 1024);
+    static size_t largest   = Resource<size_t>("bufferPoolRetainedLargest;$ECKIT_BUFFER_POOL_RETAINED_LARGEST",
+                                               16 * 1024 * 1024);
+    static bool hugePages   = Resource<bool>("bufferPoolHugePages;$ECKIT_BUFFER_POOL_HUGE_PAGES", false);
+    // never destroyed, as buffers may be released during static destruction
+    static BufferPool* pool = new BufferPool(capacity, retained, 64, hugePages, largest);
+    return *pool;
+}
+
+PooledBuffer BufferPool::acquire(size_t size, Wait wait) {
+    size_t c        = sizeClass(size);
+    size_t capacity = c < CLASSES ? (size_t(1) << (c + MIN_CLASS_SHIFT)) : size;
+
+    AutoLock<MutexCond> lock(cond_);
+
+    stats_.acquired_++;
+
+    if (c < CLASSES && !free_[c].empty()) {
+        return reuse(c, size, capacity);
+    }
+
+    if (capacity_) {
+        // Make room with the retained buffers, then wait for buffers in use to be released
+        if (allocatedBytes_ + capacity > capacity_) {
+            trim(0);
+        }
+        if (wait == Wait::Yes && allocatedBytes_ + capacity > capacity_ && stats_.inUse_ > 0) {
+            stats_.waits_++;
+            while (allocatedBytes_ + capacity > capacity_ && stats_.inUse_ > 0) {
+                if (c < CLASSES && !free_[c].empty()) {
+                    return reuse(c, size, capacity);
+                }
+                trim(0);
+                cond_.wait();
+            }
+        }
+    }
+
+    char* buffer = allocate(capacity);
+    allocatedBytes_ += capacity;
+    stats_.allocated_++;
+    stats_.inUse_ += capacity;
+
+    return PooledBuffer(*this, buffer, size, capacity);
+}
+
+PooledBuffer BufferPool::reuse(size_t c, size_t size, size_t capacity) {
+    char* buffer = free_[c].back();
+    free_[c].pop_back();
+    stats_.reused_++;
+    stats_.retained_ -= capacity;
+    stats_.inUse_ += capacity;
+    return PooledBuffer(*this, buffer, size, capacity);
+}
+
+void BufferPool::release(char* buffer, size_t capacity) {
+    AutoLock<MutexCond> lock(cond_);
+
+    stats_.inUse_ -= capacity;
+
+    size_t c = sizeClass(capacity);
+    if (c < CLASSES && capacity <= largest_ && stats_.retained_ + capacity <= retained_) {
+        free_[c].push_back(buffer);
+        stats_.retained_ += capacity;
+    }
+    else {
+        deallocate(buffer, capacity);
+        allocatedBytes_ -= capacity;
+        stats_.freed_++;
+    }
+
+    cond_.broadcast();
+}
+
+void BufferPool::purge() {
+    AutoLock<MutexCond> lock(cond_);
+    trim(0);
+}
+
+void BufferPool::trim(size_t retained) {
+    for (size_t c = CLASSES; c > 0 && stats_.retained_ > retained; --c) {
+        size_t capacity = size_t(1) << (c - 1 + MIN_CLASS_SHIFT);
+        auto& list      = free_[c - 1];
+        while (!list.empty() && stats_.retained_ > retained) {
+            deallocate(list.back(), capacity);
+            list.pop_back();
+            allocatedBytes_ -= capacity;
+            stats_.retained_ -= capacity;
+            stats_.freed_++;
+        }
+    }
+}
+
+BufferPool::Statistics BufferPool::statistics() const {
+    AutoLock<MutexCond> lock(cond_);
+    return stats_;
+}
+
+char* BufferPool::allocate(size_t capacity) {
+    if (hugePages_ && capacity >= HUGE_PAGE_SIZE) {
+        void* p = MMap::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw OutOfMemory();
+        }
+#ifdef MADV_HUGEPAGE
+        ::madvise(p, capacity, MADV_HUGEPAGE);  // advisory, ignore failures
+#endif
+        return static_cast<char*>(p);
+    }
+
+    void* p = nullptr;
+    if (::posix_memalign(&p, alignment_, capacity) != 0) {
+        throw OutOfMemory();
+    }
+    return static_cast<char*>(p);
+}
+
+void BufferPool::deallocate(char* buffer, size_t capacity) {
+    if (hugePages_ && capacity >= HUGE_PAGE_SIZE) {
+        SYSCALL(MMap::munmap(buffer, capacity));
+        return;
+    }
+    ::free(buffer);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+PooledBuffer::PooledBuffer(size_t size, BufferPool& pool) :
+    PooledBuffer(pool.acquire(size)) {}
+
+PooledBuffer::PooledBuffer(size_t size, BufferPool::Wait wait, BufferPool& pool) :
+    PooledBuffer(pool.acquire(size, wait)) {}
+
+PooledBuffer::PooledBuffer(BufferPool& pool, char* buffer, size_t size, size_t capacity) :
+    pool_(&pool), buffer_(buffer), size_(size), capacity_(capacity) {}
+
+PooledBuffer::PooledBuffer(PooledBuffer&& rhs) noexcept :
+    pool_(rhs.pool_), buffer_(rhs.buffer_), size_(rhs.size_), capacity_(rhs.capacity_) {
+    rhs.pool_     = nullptr;
+    rhs.buffer_   = nullptr;
+    rhs.size_     = 0;
+    rhs.capacity_ = 0;
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& rhs) noexcept {
+    if (this != &rhs) {
+        reset();
+        pool_         = rhs.pool_;
+        buffer_       = rhs.buffer_;
+        size_         = rhs.size_;
+        capacity_     = rhs.capacity_;
+        rhs.pool_     = nullptr;
+        rhs.buffer_   = nullptr;
+        rhs.size_     = 0;
+        rhs.capacity_ = 0;
+    }
+    return *this;
+}
+
+PooledBuffer::~PooledBuffer() {
+    reset();
+}
+
+void PooledBuffer::reset() {
+    if (buffer_) {
+        pool_->release(buffer_, capacity_);
+        pool_     = nullptr;
+        buffer_   = nullptr;
+        size_     = 0;
+        capacity_ = 0;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
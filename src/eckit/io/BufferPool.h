@@ -0,0 +1,161 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_BufferPool_h
+#define eckit_io_BufferPool_h
+
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/thread/MutexCond.h"
+
+namespace eckit {
+
+class PooledBuffer;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Thread-safe pool of memory buffers, recycled instead of being freed
+///
+/// Requests are rounded up to power-of-two size classes (from 4 KiB to 1 GiB, larger requests are not pooled). Up to
+/// `retained` bytes of released buffers of at most `largest` bytes are kept for reuse, for the lifetime of the pool.
+/// With a `capacity`, acquire() waits (back-pressure) while the memory allocated by the pool would exceed it, and
+/// buffers are in use. Callers that would wait for their own buffers (e.g. DblBuffer, or a read-ahead window released
+/// by the thread that fills it) acquire with Wait::No, and allocate beyond the capacity instead. Buffers are aligned
+/// to `alignment` bytes; with `hugePages`, buffers of 2 MiB or more are mapped and advised to use transparent huge
+/// pages.
+class BufferPool : private NonCopyable {
+public:  // types
+    /// Whether acquire() may wait for buffers to be released when above the capacity
+    enum class Wait
+    {
+        Yes,
+        No
+    };
+
+    struct Statistics {
+        size_t acquired_  = 0;  ///< buffers handed out
+        size_t reused_    = 0;  ///< ... of which recycled
+        size_t allocated_ = 0;  ///< buffers allocated from the system
+        size_t freed_     = 0;  ///< buffers returned to the system
+        size_t waits_     = 0;  ///< times acquire() waited for memory
+        size_t inUse_     = 0;  ///< bytes handed out
+        size_t retained_  = 0;  ///< bytes kept for reuse
+
+        /// @returns proportion of buffers handed out that were recycled
+        double reuseRatio() const { return acquired_ ? double(reused_) / double(acquired_) : 0.; }
+
+        void print(std::ostream&) const;
+
+        friend std::ostream& operator<<(std::ostream& s, const Statistics& x) {
+            x.print(s);
+            return s;
+        }
+    };
+
+public:  // methods
+    explicit BufferPool(size_t capacity = 0, size_t retained = 0, size_t alignment = 64, bool hugePages = false,
+                        size_t largest = size_t(1) << 30);
+
+    /// @pre all buffers have been returned
+    ~BufferPool();
+
+    /// Pool used by eckit I/O, configured by bufferPoolCapacity (default 0, unbounded), bufferPoolRetained (64 MiB),
+    /// bufferPoolRetainedLargest (16 MiB) and bufferPoolHugePages (ECKIT_BUFFER_POOL_CAPACITY,
+    /// ECKIT_BUFFER_POOL_RETAINED, ECKIT_BUFFER_POOL_RETAINED_LARGEST, ECKIT_BUFFER_POOL_HUGE_PAGES)
+    static BufferPool& instance();
+
+    /// @returns a buffer of at least `size` bytes, returned to the pool when destroyed
+    PooledBuffer acquire(size_t size, Wait = Wait::Yes);
+
+    /// Free the buffers kept for reuse
+    void purge();
+
+    Statistics statistics() const;
+
+private:  // methods
+    friend class PooledBuffer;
+
+    void release(char*, size_t capacity);
+    PooledBuffer reuse(size_t c, size_t size, size_t capacity);
+
+    char* allocate(size_t capacity);
+    void deallocate(char*, size_t capacity);
+    void trim(size_t retained);
+
+private:  // members
+    size_t capacity_;
+    size_t retained_;
+    size_t alignment_;
+    bool hugePages_;
+    size_t largest_;
+
+    size_t allocatedBytes_;  ///< bytes allocated from the system, in use or retained
+
+    std::vector<std::vector<char*>> free_;  ///< released buffers, by size class
+
+    Statistics stats_;
+
+    mutable MutexCond cond_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Memory buffer drawn from a BufferPool, and returned to it when destroyed
+class PooledBuffer : private NonCopyable {
+public:  // methods
+    PooledBuffer() = default;
+
+    explicit PooledBuffer(size_t size, BufferPool& pool = BufferPool::instance());
+
+    PooledBuffer(size_t size, BufferPool::Wait, BufferPool& pool = BufferPool::instance());
+
+    PooledBuffer(PooledBuffer&&) noexcept;
+    PooledBuffer& operator=(PooledBuffer&&) noexcept;
+
+    ~PooledBuffer();
+
+    operator char*() { return buffer_; }
+    operator const char*() const { return buffer_; }
+
+    operator void*() { return buffer_; }
+    operator const void*() const { return buffer_; }
+
+    void* data() { return buffer_; }
+    const void* data() const { return buffer_; }
+
+    /// @returns size requested
+    size_t size() const { return size_; }
+
+    /// @returns size allocated, at least size()
+    size_t capacity() const { return capacity_; }
+
+    /// Return the memory to the pool
+    void reset();
+
+private:  // methods
+    friend class BufferPool;
+
+    PooledBuffer(BufferPool&, char*, size_t size, size_t capacity);
+
+private:  // members
+    BufferPool* pool_ = nullptr;
+    char* buffer_     = nullptr;
+    size_t size_      = 0;
+    size_t capacity_  = 0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
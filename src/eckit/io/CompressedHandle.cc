@@ -0,0 +1,656 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/CompressedHandle.h"
+#include "eckit/log/Log.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/thread/ThreadPool.h"
+#include "eckit/utils/Compressor.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+const char HEADER_MAGIC[]  = "ECKITCH1";
+const char TRAILER_MAGIC[] = "ECKITCHX";
+
+constexpr size_t MAGIC_SIZE   = 8;
+constexpr size_t WORD_SIZE    = 8;
+constexpr size_t BLOCK_HEADER = 2 * WORD_SIZE;
+constexpr size_t ENTRY_SIZE   = 3 * WORD_SIZE;
+constexpr size_t TRAILER_SIZE = 2 * WORD_SIZE + MAGIC_SIZE;
+
+void put(char*& p, unsigned long long value) {
+    for (size_t i = 0; i < WORD_SIZE; ++i) {
+        *p++ = char((value >> (8 * i)) & 0xff);
+    }
+}
+
+unsigned long long get(const char*& p) {
+    unsigned long long value = 0;
+    for (size_t i = 0; i < WORD_SIZE; ++i) {
+        value |= static_cast<unsigned long long>(static_cast<unsigned char>(*p++)) << (8 * i);
+    }
+    return value;
+}
+
+size_t readFully(DataHandle& h, void* buffer, size_t length) {
+    char* p      = static_cast<char*>(buffer);
+    size_t total = 0;
+    while (total < length) {
+        long n = h.read(p + total, long(length - total));
+        if (n < 0) {
+            throw ReadError("CompressedHandle: read failed");
+        }
+        if (n == 0) {
+            break;
+        }
+        total += size_t(n);
+    }
+    return total;
+}
+
+void readExactly(DataHandle& h, void* buffer, size_t length) {
+    if (readFully(h, buffer, length) != length) {
+        throw ReadError("CompressedHandle: unexpected end of stream");
+    }
+}
+
+void writeExactly(DataHandle& h, const void* buffer, size_t length) {
+    if (h.write(buffer, long(length)) != long(length)) {
+        throw WriteError("CompressedHandle: write failed");
+    }
+}
+
+std::string defaultCompressor() {
+    std::string name = Resource<std::string>("defaultCompression;ECKIT_DEFAULT_COMPRESSION", "snappy");
+    return CompressorFactory::instance().has(name) ? name : "none";
+}
+
+size_t defaultThreads() {
+    static size_t threads = Resource<size_t>("compressedHandleThreads;$ECKIT_COMPRESSED_HANDLE_THREADS",
+                                             std::max(1U, std::thread::hardware_concurrency()));
+    return std::max<size_t>(threads, 1);
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A block being compressed (in_ is the data, out_ the compressed data) or decompressed (in_ is the compressed data)
+struct CompressedBlock {
+    PooledBuffer in_;
+    size_t inLength_ = 0;
+    Buffer out_;
+    size_t outLength_ = 0;
+    bool compress_    = true;
+    bool done_        = false;
+    std::string error_;
+};
+
+class CompressedHandleTask : public ThreadPoolTask {
+    CompressedHandle& owner_;
+    CompressedBlock& block_;
+    void execute() override;
+
+public:
+    CompressedHandleTask(CompressedHandle& owner, CompressedBlock& block) :
+        owner_(owner), block_(block) {}
+};
+
+void CompressedHandleTask::execute() {
+    std::string error;
+
+    try {
+        std::unique_ptr<Compressor> compressor = owner_.takeCompressor();
+        if (block_.compress_) {
+            block_.outLength_ = compressor->compress(block_.in_.data(), block_.inLength_, block_.out_);
+        }
+        else {
+            compressor->uncompress(block_.in_.data(), block_.inLength_, block_.out_, block_.outLength_);
+        }
+        owner_.giveCompressor(std::move(compressor));
+    }
+    catch (std::exception& e) {
+        Log::error() << "CompressedHandleTask got an exception: " << e.what() << " " << owner_ << std::endl;
+        error = e.what();
+    }
+
+    AutoLock<MutexCond> lock(owner_.cond_);
+    block_.error_ = error;
+    block_.done_  = true;
+    owner_.cond_.broadcast();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CompressedHandle::CompressedHandle(DataHandle* h, const std::string& compressor, size_t blockSize, size_t threads) :
+    HandleHolder(h),
+    compressor_(compressor.empty() ? defaultCompressor() : compressor),
+    blockSize_(blockSize),
+    threads_(threads ? threads : defaultThreads()),
+    used_(0),
+    streamOffset_(0),
+    dataOffset_(0),
+    next_(0),
+    position_(0),
+    writing_(false),
+    opened_(false),
+    end_(false) {
+    ASSERT(blockSize_ > 0);
+}
+
+CompressedHandle::CompressedHandle(DataHandle& h, const std::string& compressor, size_t blockSize, size_t threads) :
+    HandleHolder(h),
+    compressor_(compressor.empty() ? defaultCompressor() : compressor),
+    blockSize_(blockSize),
+    threads_(threads ? threads : defaultThreads()),
+    used_(0),
+    streamOffset_(0),
+    dataOffset_(0),
+    next_(0),
+    position_(0),
+    writing_(false),
+    opened_(false),
+    end_(false) {
+    ASSERT(blockSize_ > 0);
+}
+
+CompressedHandle::~CompressedHandle() {
+    // Tasks refer to the pending blocks
+    cancel();
+    pool_.reset();
+}
+
+void CompressedHandle::open() {
+    pending_.clear();
+    index_.clear();
+    starts_.clear();
+    used_     = 0;
+    next_     = 0;
+    position_ = 0;
+    end_      = false;
+    opened_   = true;
+    pool_.reset(new ThreadPool("CompressedHandle", threads_));
+}
+
+std::unique_ptr<Compressor> CompressedHandle::takeCompressor() {
+    {
+        AutoLock<MutexCond> lock(cond_);
+        if (!compressors_.empty()) {
+            std::unique_ptr<Compressor> compressor = std::move(compressors_.back());
+            compressors_.pop_back();
+            return compressor;
+        }
+    }
+    return std::unique_ptr<Compressor>(CompressorFactory::instance().build(compressor_));
+}
+
+void CompressedHandle::giveCompressor(std::unique_ptr<Compressor> compressor) {
+    AutoLock<MutexCond> lock(cond_);
+    compressors_.push_back(std::move(compressor));
+}
+
+void CompressedHandle::submit(std::unique_ptr<CompressedBlock> block) {
+    block->done_ = false;
+    block->error_.clear();
+    pending_.push_back(std::move(block));
+    pool_->push(new CompressedHandleTask(*this, *pending_.back()));
+}
+
+void CompressedHandle::wait(CompressedBlock& block) {
+    AutoLock<MutexCond> lock(cond_);
+    while (!block.done_) {
+        cond_.wait();
+    }
+}
+
+void CompressedHandle::pop() {
+    std::unique_ptr<CompressedBlock> block = std::move(pending_.front());
+    pending_.pop_front();
+    block->in_.reset();
+    spare_.push_back(std::move(block));
+    used_ = 0;
+}
+
+void CompressedHandle::cancel() {
+    for (auto& block : pending_) {
+        wait(*block);
+    }
+    while (!pending_.empty()) {
+        pop();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CompressedHandle::openForWrite(const Length&) {
+    // Fail early on unknown compressors
+    giveCompressor(takeCompressor());
+
+    handle().openForWrite(0);
+    open();
+    writing_ = true;
+
+    std::vector<char> header(MAGIC_SIZE + 2 * WORD_SIZE + compressor_.size());
+    char* p = header.data();
+    ::memcpy(p, HEADER_MAGIC, MAGIC_SIZE);
+    p += MAGIC_SIZE;
+    put(p, compressor_.size());
+    ::memcpy(p, compressor_.data(), compressor_.size());
+    p += compressor_.size();
+    put(p, blockSize_);
+
+    writeExactly(handle(), header.data(), header.size());
+    streamOffset_ = dataOffset_ = header.size();
+}
+
+void CompressedHandle::openForAppend(const Length&) {
+    NOTIMP;
+}
+
+long CompressedHandle::write(const void* buffer, long length) {
+    ASSERT(writing_);
+
+    const char* p = static_cast<const char*>(buffer);
+    long left     = length;
+
+    while (left > 0) {
+        if (current_.data() == nullptr) {
+            // the blocks in flight are bounded, and only released by this thread, so the pool must not wait for them
+            current_ = PooledBuffer(blockSize_, BufferPool::Wait::No);
+        }
+
+        size_t n = std::min(size_t(left), blockSize_ - used_);
+        ::memcpy(static_cast<char*>(current_) + used_, p, n);
+
+        p += n;
+        left -= long(n);
+        used_ += n;
+        position_ += n;
+
+        if (used_ == blockSize_) {
+            writeBlock();
+        }
+    }
+
+    return length;
+}
+
+void CompressedHandle::writeBlock() {
+    if (used_ == 0) {
+        return;
+    }
+
+    std::unique_ptr<CompressedBlock> block;
+    if (spare_.empty()) {
+        block.reset(new CompressedBlock());
+    }
+    else {
+        block = std::move(spare_.back());
+        spare_.pop_back();
+    }
+
+    block->in_       = std::move(current_);
+    block->inLength_ = used_;
+    block->compress_ = true;
+    used_            = 0;
+
+    submit(std::move(block));
+
+    // Bound the memory in flight, and write what is ready
+    while (pending_.size() > 2 * threads_) {
+        writeFront();
+    }
+    for (;;) {
+        {
+            AutoLock<MutexCond> lock(cond_);
+            if (pending_.empty() || !pending_.front()->done_) {
+                break;
+            }
+        }
+        writeFront();
+    }
+}
+
+void CompressedHandle::writeFront() {
+    CompressedBlock& block = *pending_.front();
+    wait(block);
+
+    if (!block.error_.empty()) {
+        throw WriteError("CompressedHandle: " + block.error_);
+    }
+
+    char header[BLOCK_HEADER];
+    char* p = header;
+    put(p, block.outLength_);
+    put(p, block.inLength_);
+
+    writeExactly(handle(), header, sizeof(header));
+    writeExactly(handle(), block.out_, block.outLength_);
+
+    index_.push_back(Entry{streamOffset_, block.outLength_, block.inLength_});
+    streamOffset_ += BLOCK_HEADER + block.outLength_;
+
+    size_t used = used_;
+    pop();
+    used_ = used;
+}
+
+void CompressedHandle::flush() {
+    if (writing_) {
+        writeBlock();
+        while (!pending_.empty()) {
+            writeFront();
+        }
+    }
+    handle().flush();
+}
+
+void CompressedHandle::close() {
+    if (!opened_) {
+        return;
+    }
+
+    if (writing_) {
+        writeBlock();
+        while (!pending_.empty()) {
+            writeFront();
+        }
+        current_.reset();
+
+        std::vector<char> tail(BLOCK_HEADER + index_.size() * ENTRY_SIZE + TRAILER_SIZE);
+        char* p = tail.data();
+        put(p, 0);
+        put(p, 0);
+        for (const auto& e : index_) {
+            put(p, e.offset_);
+            put(p, e.compressed_);
+            put(p, e.uncompressed_);
+        }
+        put(p, streamOffset_ + BLOCK_HEADER);
+        put(p, index_.size());
+        ::memcpy(p, TRAILER_MAGIC, MAGIC_SIZE);
+
+        writeExactly(handle(), tail.data(), tail.size());
+    }
+    else {
+        cancel();
+    }
+
+    handle().close();
+
+    pool_.reset();
+    writing_ = false;
+    opened_  = false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Length CompressedHandle::openForRead() {
+    Length estimate = handle().openForRead();
+    open();
+    writing_ = false;
+
+    char magic[MAGIC_SIZE];
+    char word[WORD_SIZE];
+    const char* p;
+
+    readExactly(handle(), magic, MAGIC_SIZE);
+    if (::memcmp(magic, HEADER_MAGIC, MAGIC_SIZE) != 0) {
+        throw BadValue("CompressedHandle: not a compressed stream " + handle().title());
+    }
+
+    readExactly(handle(), word, WORD_SIZE);
+    p = word;
+    std::string name(get(p), ' ');
+    readExactly(handle(), &name[0], name.size());
+
+    readExactly(handle(), word, WORD_SIZE);
+    p = word;
+
+    compressor_   = name;
+    blockSize_    = get(p);
+    streamOffset_ = dataOffset_ = MAGIC_SIZE + 2 * WORD_SIZE + name.size();
+
+    if (handle().canSeek() && estimate > Length(dataOffset_ + TRAILER_SIZE)) {
+        readIndex();
+    }
+
+    readAhead();
+
+    return this->estimate();
+}
+
+void CompressedHandle::readIndex() {
+    Length size = handle().estimate();
+
+    char trailer[TRAILER_SIZE];
+    handle().seek(size - Length(TRAILER_SIZE));
+
+    if (readFully(handle(), trailer, TRAILER_SIZE) == TRAILER_SIZE
+        && ::memcmp(trailer + 2 * WORD_SIZE, TRAILER_MAGIC, MAGIC_SIZE) == 0) {
+        const char* p                = trailer;
+        unsigned long long offset    = get(p);
+        unsigned long long count     = get(p);
+        unsigned long long available = (unsigned long long)size - TRAILER_SIZE;
+
+        if (offset <= available && count <= (available - offset) / ENTRY_SIZE) {
+            std::vector<char> entries(count * ENTRY_SIZE);
+            handle().seek(offset);
+            readExactly(handle(), entries.data(), entries.size());
+
+            p = entries.data();
+            index_.reserve(count);
+            starts_.reserve(count + 1);
+            starts_.push_back(0);
+            for (size_t i = 0; i < count; ++i) {
+                Entry e;
+                e.offset_       = get(p);
+                e.compressed_   = get(p);
+                e.uncompressed_ = get(p);
+                index_.push_back(e);
+                starts_.push_back(starts_.back() + e.uncompressed_);
+            }
+        }
+    }
+
+    if (starts_.empty()) {
+        Log::warning() << *this << ": no block index found, the stream can only be read sequentially" << std::endl;
+    }
+
+    handle().seek(dataOffset_);
+}
+
+void CompressedHandle::readAhead() {
+    while (!end_ && pending_.size() < 2 * threads_) {
+        char header[BLOCK_HEADER];
+        readExactly(handle(), header, BLOCK_HEADER);
+
+        const char* p                   = header;
+        unsigned long long compressed   = get(p);
+        unsigned long long uncompressed = get(p);
+
+        if (compressed == 0 && uncompressed == 0) {
+            end_ = true;
+            break;
+        }
+
+        std::unique_ptr<CompressedBlock> block;
+        if (spare_.empty()) {
+            block.reset(new CompressedBlock());
+        }
+        else {
+            block = std::move(spare_.back());
+            spare_.pop_back();
+        }
+
+        block->in_        = PooledBuffer(compressed, BufferPool::Wait::No);  // see write()
+        block->inLength_  = compressed;
+        block->outLength_ = uncompressed;
+        block->compress_  = false;
+        readExactly(handle(), block->in_.data(), compressed);
+
+        streamOffset_ += BLOCK_HEADER + compressed;
+        next_++;
+
+        submit(std::move(block));
+    }
+}
+
+long CompressedHandle::read(void* buffer, long length) {
+    ASSERT(!writing_);
+
+    char* p    = static_cast<char*>(buffer);
+    long total = 0;
+
+    while (length > 0) {
+        readAhead();
+        if (pending_.empty()) {
+            break;
+        }
+
+        CompressedBlock& block = *pending_.front();
+        wait(block);
+
+        if (!block.error_.empty()) {
+            throw ReadError("CompressedHandle: " + block.error_);
+        }
+
+        size_t n = std::min(size_t(length), block.outLength_ - used_);
+        ::memcpy(p, static_cast<const char*>(block.out_) + used_, n);
+
+        p += n;
+        total += long(n);
+        length -= long(n);
+        used_ += n;
+        position_ += n;
+
+        if (used_ == block.outLength_) {
+            pop();
+        }
+    }
+
+    return total;
+}
+
+Offset CompressedHandle::seek(const Offset& offset) {
+    if (offset == position_) {
+        return position_;
+    }
+
+    ASSERT(!writing_);
+
+    if (starts_.empty()) {
+        // Sequential stream: restart if needed, then decompress up to the offset
+        if (offset < position_) {
+            ASSERT(handle().canSeek());
+            cancel();
+            handle().seek(dataOffset_);
+            streamOffset_ = dataOffset_;
+            next_         = 0;
+            position_     = 0;
+            end_          = false;
+        }
+
+        Buffer scratch(std::min<size_t>(blockSize_, 1024 * 1024));
+        while (position_ < offset) {
+            long n = std::min<long long>((long long)(offset - position_), (long long)scratch.size());
+            if (read(scratch, n) == 0) {
+                break;
+            }
+        }
+        return position_;
+    }
+
+    size_t count = index_.size();
+    ASSERT((unsigned long long)(long long)offset <= starts_.back());
+
+    size_t block = std::upper_bound(starts_.begin(), starts_.end(), (unsigned long long)(long long)offset)
+                   - starts_.begin() - 1;
+    size_t front = next_ - pending_.size();
+
+    if (block >= count) {
+        // At the end
+        cancel();
+        next_ = count;
+        end_  = true;
+    }
+    else if (front <= block && block < next_) {
+        // Already being decompressed
+        for (; front < block; ++front) {
+            wait(*pending_.front());
+            pop();
+        }
+    }
+    else {
+        cancel();
+        handle().seek(index_[block].offset_);
+        streamOffset_ = index_[block].offset_;
+        next_         = block;
+        end_          = false;
+        readAhead();
+    }
+
+    used_     = size_t((long long)offset - starts_[std::min(block, count)]);
+    position_ = offset;
+    return position_;
+}
+
+void CompressedHandle::skip(const Length& length) {
+    seek(position_ + length);
+}
+
+void CompressedHandle::rewind() {
+    seek(0);
+}
+
+bool CompressedHandle::canSeek() const {
+    return !writing_ && handle().canSeek();
+}
+
+Length CompressedHandle::estimate() {
+    return starts_.empty() ? Length(0) : Length(starts_.back());
+}
+
+Offset CompressedHandle::position() {
+    return position_;
+}
+
+void CompressedHandle::print(std::ostream& s) const {
+    s << "CompressedHandle[";
+    handle().print(s);
+    s << ",compressor=" << compressor_ << ",blockSize=" << blockSize_ << ",threads=" << threads_ << ']';
+}
+
+std::string CompressedHandle::title() const {
+    return std::string("{") + handle().title() + "}";
+}
+
+void CompressedHandle::collectMetrics(const std::string& what) const {
+    handle().collectMetrics(what);
+}
+
+DataHandle* CompressedHandle::clone() const {
+    return new CompressedHandle(handle().clone(), compressor_, blockSize_, threads_);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,149 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_CompressedHandle_h
+#define eckit_io_CompressedHandle_h
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "eckit/io/BufferPool.h"
+#include "eckit/io/HandleHolder.h"
+#include "eckit/thread/MutexCond.h"
+
+namespace eckit {
+
+class Compressor;
+class ThreadPool;
+
+struct CompressedBlock;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Compresses a stream into independent blocks, (de)compressed concurrently on a thread pool
+///
+/// Data is framed into blocks of `blockSize` bytes, compressed with any CompressorFactory backend by `threads`
+/// threads, and written in order, with at most two blocks per thread in flight. The stream ends with an index of the
+/// blocks, so that, when the underlying handle can seek, seek() only decompresses the blocks needed. When reading,
+/// the blocks following the current one are decompressed ahead.
+///
+/// Layout (integers are little-endian 64 bits):
+///     header  : "ECKITCH1", compressor name length, compressor name, block size
+///     blocks  : compressed length, uncompressed length, compressed data
+///     end     : zero, zero
+///     index   : per block, offset in the stream, compressed length, uncompressed length
+///     trailer : index offset, number of blocks, "ECKITCHX"
+class CompressedHandle : public DataHandle, public HandleHolder {
+public:
+    /// Contructor, taking ownership. Without a compressor name, the compressor is the default of CompressorFactory.
+    /// When reading, the compressor is the one recorded in the stream. Without threads, the number of threads is
+    /// compressedHandleThreads (ECKIT_COMPRESSED_HANDLE_THREADS).
+
+    CompressedHandle(DataHandle*, const std::string& compressor = std::string(), size_t blockSize = 4 * 1024 * 1024,
+                     size_t threads = 0);
+
+    /// Contructor, not taking ownership
+
+    CompressedHandle(DataHandle&, const std::string& compressor = std::string(), size_t blockSize = 4 * 1024 * 1024,
+                     size_t threads = 0);
+
+    /// Destructor
+
+    ~CompressedHandle() override;
+
+    // -- Methods
+
+    const std::string& compressor() const { return compressor_; }
+
+    // -- Overridden methods
+
+    // From DataHandle
+
+    Length openForRead() override;
+    void openForWrite(const Length&) override;
+    void openForAppend(const Length&) override;
+
+    long read(void*, long) override;
+    long write(const void*, long) override;
+    void close() override;
+    void flush() override;
+    void rewind() override;
+    void print(std::ostream&) const override;
+    void skip(const Length&) override;
+
+    Offset seek(const Offset&) override;
+    bool canSeek() const override;
+
+    Length estimate() override;
+    Offset position() override;
+
+    DataHandle* clone() const override;
+
+private:  // types
+    struct Entry {
+        unsigned long long offset_;        ///< in the underlying stream
+        unsigned long long compressed_;    ///< compressed length
+        unsigned long long uncompressed_;  ///< uncompressed length
+    };
+
+private:  // methods
+    void open();
+    void submit(std::unique_ptr<CompressedBlock>);
+    void wait(CompressedBlock&);
+    void writeFront();
+    void writeBlock();
+    void readIndex();
+    void readAhead();
+    void pop();
+    void cancel();
+
+    std::unique_ptr<Compressor> takeCompressor();
+    void giveCompressor(std::unique_ptr<Compressor>);
+
+    std::string title() const override;
+    void collectMetrics(const std::string& what) const override;
+
+private:  // members
+    std::string compressor_;
+    size_t blockSize_;
+    size_t threads_;
+
+    std::unique_ptr<ThreadPool> pool_;
+
+    std::deque<std::unique_ptr<CompressedBlock>> pending_;  ///< in stream order
+    std::vector<std::unique_ptr<CompressedBlock>> spare_;
+    std::vector<std::unique_ptr<Compressor>> compressors_;  ///< idle compressors, one per thread at most
+
+    std::vector<Entry> index_;
+    std::vector<unsigned long long> starts_;  ///< uncompressed offset of each block and of the end, if indexed
+
+    PooledBuffer current_;  ///< block being filled, when writing
+    size_t used_;           ///< bytes in the current block (writing) or consumed from the front block (reading)
+
+    unsigned long long streamOffset_;  ///< in the underlying stream
+    unsigned long long dataOffset_;    ///< of the first block
+    size_t next_;                      ///< next block to read
+    Offset position_;
+
+    bool writing_;
+    bool opened_;
+    bool end_;  ///< end marker reached when reading
+
+    MutexCond cond_;
+
+    friend class CompressedHandleTask;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
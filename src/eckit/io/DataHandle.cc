@@ -18,9 +18,11 @@
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/io/BufferPool.h"
 #include "eckit/io/DataHandle.h"
 #include "eckit/io/DblBuffer.h"
 #include "eckit/io/MoverTransfer.h"
+#include "eckit/io/NativeTransfer.h"
 #include "eckit/log/Bytes.h"
 #include "eckit/log/Progress.h"
 #include "eckit/log/Timer.h"
@@ -103,12 +105,11 @@ Length DataHandle::saveInto(DataHandle& other, TransferWatcher& watcher) {
     static const long bufsize = Resource<long>("bufferSize;$ECKIT_DATAHANDLE_SAVEINTO_BUFFER_SIZE",
                                                64 * 1024 * 1024);
 
-    Buffer buffer(bufsize);
-
     watcher.watch(0, 0);
 
     Length estimate = openForRead();
     AutoClose closer1(*this);
+    adviseSequential();
     watcher.fromHandleOpened();
     other.openForWrite(estimate);
     AutoClose closer2(other);
@@ -125,6 +126,23 @@ Length DataHandle::saveInto(DataHandle& other, TransferWatcher& watcher) {
     Timer timer("Save into");
     bool more = true;
 
+    if (NativeTransfer::possible(*this, other, watcher)) {
+        bool end = false;
+        total    = NativeTransfer::transfer(*this, other, 0, bufsize, watcher, end);
+        progress(total);
+        readTime = writeTime = lastRead = timer.elapsed();
+        if (end) {
+            length = 0;
+            more   = false;
+        }
+    }
+
+    // Only needed if the kernel did not transfer everything
+    PooledBuffer buffer;
+    if (more) {
+        buffer = PooledBuffer(bufsize);
+    }
+
     while (more) {
         more = false;
         try {
@@ -201,11 +219,11 @@ Length DataHandle::copyTo(DataHandle& other, long bufsize, Length maxsize, Trans
     if (bufsize == -1) {
         bufsize = Resource<long>("bufferSize;$ECKIT_DATAHANDLE_COPYTO_BUFFER_SIZE", 64 * 1024 * 1024);
     }
-    Buffer buffer(bufsize);
 
     Length estimate = openForRead();
     watcher.fromHandleOpened();
     AutoClose closer1(*this);
+    adviseSequential();
 
     Length toRead = ((maxsize != -1) ? std::min(estimate, maxsize) : estimate);
 
@@ -216,7 +234,21 @@ Length DataHandle::copyTo(DataHandle& other, long bufsize, Length maxsize, Trans
     Length total = 0;
     long length  = -1;
 
-    while ((toRead <= Length(0) || total < toRead) && (length = read(buffer, toRead <= Length(0) ? bufsize : std::min(bufsize, (long)(toRead - total)))) > 0) {
+    bool end = false;
+    if (NativeTransfer::possible(*this, other, watcher)) {
+        total = NativeTransfer::transfer(*this, other, toRead <= Length(0) ? Length(0) : toRead, bufsize, watcher,
+                                         end);
+        length = 0;
+    }
+
+    // Only needed if the kernel did not transfer everything
+    PooledBuffer buffer;
+    if (!end) {
+        buffer = PooledBuffer(bufsize);
+    }
+
+    while (!end && (toRead <= Length(0) || total < toRead) &&
+           (length = read(buffer, toRead <= Length(0) ? bufsize : std::min(bufsize, (long)(toRead - total)))) > 0) {
 
         if (other.write((const char*)buffer, length) != length) {
             throw WriteError(name() + " into " + other.name());
@@ -16,6 +16,8 @@
 #ifndef eckit_io_DataHandle_h
 #define eckit_io_DataHandle_h
 
+#include <sys/types.h>
+
 #include <cstdio>
 
 #include "eckit/filesystem/PathName.h"
@@ -144,6 +146,22 @@ public:
 
     virtual bool doubleBufferOK() const { return true; }
 
+    /// Hint, once open for reading, that the data will be read sequentially to the end (e.g. by saveInto or copyTo)
+    virtual void adviseSequential() {}
+
+    // For kernel transfers (copy_file_range, sendfile, splice), see NativeTransfer
+
+    /// @returns descriptor from which the next bytes can be read, or -1 if not supported
+    /// @param offset set to the file offset of the next bytes, or -1 to read at the descriptor's position (e.g. socket)
+    /// @param length set to the number of contiguous bytes from there, 0 at the end, or -1 if unknown
+    virtual int nativeReadFd(off_t& /*offset*/, long long& /*length*/) { return -1; }
+
+    /// @returns descriptor to which the next bytes can be written at its current position, or -1 if not supported
+    virtual int nativeWriteFd() { return -1; }
+
+    /// Account for bytes read from, or written to, the native descriptor
+    virtual void nativeAdvance(const Length&) {}
+
     // -- Overridden methods
 
     // From Streamble
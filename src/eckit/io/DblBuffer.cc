@@ -11,7 +11,7 @@
 
 #include "eckit/io/DblBuffer.h"
 #include "eckit/io/AutoCloser.h"
-#include "eckit/io/Buffer.h"
+#include "eckit/io/BufferPool.h"
 #include "eckit/log/Bytes.h"
 #include "eckit/log/Log.h"
 #include "eckit/log/Progress.h"
@@ -89,6 +89,7 @@ Length DblBuffer::copy(DataHandle& in, DataHandle& out) {
 
 
     Length estimate = in.openForRead();
+    in.adviseSequential();
     AutoClose c1(in);
     watcher_.fromHandleOpened();
     out.openForWrite(estimate);
@@ -128,7 +129,7 @@ Length DblBuffer::copy(DataHandle& in, DataHandle& out) {
 }
 
 Length DblBuffer::copy(DataHandle& in, DataHandle& out, const Length& estimate) {
-    Buffer bigbuf(count_ * bufSize_);
+    PooledBuffer bigbuf(count_ * bufSize_);
 
     OneBuffer* buffers = new OneBuffer[count_];
 
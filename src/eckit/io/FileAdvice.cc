@@ -0,0 +1,51 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <fcntl.h>
+
+#include "eckit/config/Resource.h"
+#include "eckit/io/FileAdvice.h"
+
+namespace eckit {
+
+
+int fadvise(int fd, FileAdvice advice, off_t offset, off_t length) {
+#ifdef POSIX_FADV_SEQUENTIAL
+    int a = POSIX_FADV_NORMAL;
+    switch (advice) {
+        case FileAdvice::Sequential:
+            a = POSIX_FADV_SEQUENTIAL;
+            break;
+        case FileAdvice::WillNeed:
+            a = POSIX_FADV_WILLNEED;
+            break;
+        case FileAdvice::DontNeed:
+            a = POSIX_FADV_DONTNEED;
+            break;
+    }
+    // Returns the error number, does not set errno
+    return ::posix_fadvise(fd, offset, length, a);
+#else
+    // e.g. Darwin (macosx), advice is only a hint
+    return 0;
+#endif
+}
+
+bool fileHandleAdviseSequential() {
+    static bool advise = Resource<bool>("fileHandleAdviseSequential;$ECKIT_FILE_HANDLE_ADVISE_SEQUENTIAL", false);
+    return advise;
+}
+
+bool fileHandleDropWrittenPages() {
+    static bool drop = Resource<bool>("fileHandleDropWrittenPages;$ECKIT_FILE_HANDLE_DROP_WRITTEN_PAGES", false);
+    return drop;
+}
+
+}  // namespace eckit
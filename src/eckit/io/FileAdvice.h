@@ -0,0 +1,40 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_FileAdvice_h
+#define eckit_io_FileAdvice_h
+
+#include <sys/types.h>
+
+namespace eckit {
+
+enum class FileAdvice
+{
+    Sequential,  ///< data will be read sequentially, read ahead more
+    WillNeed,    ///< data will be needed soon, start reading it
+    DontNeed,    ///< data will not be needed again, drop it from the page cache (only clean pages are dropped)
+};
+
+/// A platform independent posix_fadvise, a no-op where not available. A length of 0 means to the end of the file.
+/// @returns 0, or an error number
+int fadvise(int fd, FileAdvice, off_t offset = 0, off_t length = 0);
+
+/// Advise the kernel to read ahead all the files opened for reading, configured by fileHandleAdviseSequential
+/// (ECKIT_FILE_HANDLE_ADVISE_SEQUENTIAL), by default false: only the files copied whole (DataHandle::adviseSequential)
+/// are advised, as read ahead penalises random access (e.g. PooledHandle, PartFileHandle)
+bool fileHandleAdviseSequential();
+
+/// Drop the pages of files written from the page cache when the file is flushed, configured by
+/// fileHandleDropWrittenPages (ECKIT_FILE_HANDLE_DROP_WRITTEN_PAGES), by default false
+bool fileHandleDropWrittenPages();
+
+}  // namespace eckit
+
+#endif
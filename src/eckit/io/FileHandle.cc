@@ -16,6 +16,7 @@
 #include "eckit/config/Resource.h"
 #include "eckit/io/DataHandle.h"
 #include "eckit/io/FDataSync.h"
+#include "eckit/io/FileAdvice.h"
 #include "eckit/io/FileHandle.h"
 #include "eckit/io/cluster/NodeInfo.h"
 #include "eckit/log/Bytes.h"
@@ -77,6 +78,10 @@ void FileHandle::open(const char* mode) {
             Buffer& b = *(buffer_.get());
             ::setvbuf(file_, b, _IOFBF, size);
         }
+
+        if (fileHandleAdviseSequential()) {
+            fadvise(fileno(file_), FileAdvice::Sequential);
+        }
     }
 
     // Log::info() << "FileHandle::open " << name_ << " " << mode << " " << fileno(file_) << std::endl;
@@ -102,6 +107,7 @@ void FileHandle::openForWrite(const Length& length) {
 }
 
 void FileHandle::openForAppend(const Length&) {
+    read_ = false;
     open("a");
 }
 
@@ -165,6 +171,11 @@ void FileHandle::flush() {
             if (fileHandleSyncsParentDir) {
                 PathName(name_).syncParentDirectory();
             }
+
+            // The data is on disk, the pages can be dropped without being written back
+            if (fileHandleDropWrittenPages()) {
+                fadvise(fileno(file_), FileAdvice::DontNeed);
+            }
         }
     }
 }
@@ -272,6 +283,39 @@ void FileHandle::skip(const Length& n) {
     }
 }
 
+int FileHandle::nativeReadFd(off_t& offset, long long& length) {
+    ASSERT(file_);
+    offset = ::ftello(file_);
+    length = -1;
+    return ::fileno(file_);
+}
+
+int FileHandle::nativeWriteFd() {
+    ASSERT(file_);
+    // Writes are not buffered, see open()
+    return ::fileno(file_);
+}
+
+void FileHandle::adviseSequential() {
+    if (file_ && read_) {
+        fadvise(::fileno(file_), FileAdvice::Sequential);
+    }
+}
+
+void FileHandle::nativeAdvance(const Length& len) {
+    if (read_) {
+        // Data was read at an explicit offset
+        advance(len);
+        return;
+    }
+
+    // Data was written at the descriptor's position, make the stream follow
+    off_t pos = ::lseek(::fileno(file_), 0, SEEK_CUR);
+    if (pos < 0 || ::fseeko(file_, pos, SEEK_SET) < 0) {
+        throw WriteError(name_);
+    }
+}
+
 void FileHandle::toRemote(Stream& s) const {
     PathName p(PathName(name_).clusterName());
     std::unique_ptr<DataHandle> remote(p.fileHandle());
@@ -65,10 +65,15 @@ public:
     Offset seek(const Offset&) override;
     bool canSeek() const override;
     void skip(const Length&) override;
+    void adviseSequential() override;
 
     DataHandle* clone() const override;
     void hash(MD5& md5) const override;
 
+    int nativeReadFd(off_t& offset, long long& length) override;
+    int nativeWriteFd() override;
+    void nativeAdvance(const Length&) override;
+
     // From Streamable
 
     void encode(Stream&) const override;
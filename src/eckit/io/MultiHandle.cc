@@ -8,18 +8,278 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
 #include <numeric>
+#include <utility>
 
 #include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/BufferPool.h"
 #include "eckit/io/MultiHandle.h"
 #include "eckit/log/Timer.h"
+#include "eckit/memory/NonCopyable.h"
 #include "eckit/runtime/Metrics.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/thread/MutexCond.h"
+#include "eckit/thread/ThreadPool.h"
 #include "eckit/types/Types.h"
 
 namespace eckit {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+size_t defaultPrefetch() {
+    static size_t count = Resource<size_t>("multiHandlePrefetch;$ECKIT_MULTI_HANDLE_PREFETCH", 0);
+    return count;
+}
+
+size_t defaultPrefetchBufferSize() {
+    static size_t size = Resource<size_t>("multiHandlePrefetchBufferSize;$ECKIT_MULTI_HANDLE_PREFETCH_BUFFER_SIZE",
+                                          4 * 1024 * 1024);
+    return size;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// A handle being read ahead, into chunks consumed in order
+struct MultiHandlePart {
+    DataHandle& handle_;
+    Offset skip_;
+    std::deque<std::pair<PooledBuffer, size_t>> chunks_;
+    size_t bytes_   = 0;  ///< bytes in chunks_
+    bool done_      = false;
+    bool cancelled_ = false;
+    std::string error_;
+
+    MultiHandlePart(DataHandle& handle, const Offset& skip) :
+        handle_(handle), skip_(skip) {}
+};
+
+/// Reads a window of consecutive handles concurrently, and hands out their data in order
+class MultiHandleReader : private NonCopyable {
+public:
+    MultiHandleReader(const MultiHandle::HandleList& handles, size_t count, size_t bufferSize);
+    ~MultiHandleReader();
+
+    /// Read from handle `index`, starting at `skip` in that handle, which is at `position` in the MultiHandle
+    void start(size_t index, const Offset& skip, const Offset& position);
+    void cancel();
+
+    long read(char*, long);
+
+    Offset position() const { return position_; }
+
+private:
+    void fill();
+
+    const MultiHandle::HandleList& handles_;
+    size_t count_;
+    size_t bufferSize_;
+    size_t chunkSize_;
+
+    size_t next_;  ///< next handle to read ahead
+    size_t used_;  ///< bytes consumed from the first chunk of the first part
+    Offset position_;
+
+    std::deque<std::unique_ptr<MultiHandlePart>> parts_;  ///< in handle order
+
+    MutexCond cond_;
+
+    std::unique_ptr<ThreadPool> pool_;  // must be last
+
+    friend class MultiHandleReaderTask;
+};
+
+class MultiHandleReaderTask : public ThreadPoolTask {
+    MultiHandleReader& owner_;
+    MultiHandlePart& part_;
+    void execute() override;
+
+public:
+    MultiHandleReaderTask(MultiHandleReader& owner, MultiHandlePart& part) :
+        owner_(owner), part_(part) {}
+};
+
+void MultiHandleReaderTask::execute() {
+    DataHandle& handle = part_.handle_;
+    bool opened        = false;
+    std::string error;
+
+    try {
+        handle.openForRead();
+        opened = true;
+
+        if (part_.skip_ > Offset(0)) {
+            handle.seek(part_.skip_);
+        }
+
+        for (;;) {
+            {
+                AutoLock<MutexCond> lock(owner_.cond_);
+                while (!part_.cancelled_ && part_.bytes_ >= owner_.bufferSize_) {
+                    owner_.cond_.wait();
+                }
+                if (part_.cancelled_) {
+                    break;
+                }
+            }
+
+            // Bounded by the window, and the chunks of the other handles may only be consumed after this one's, so
+            // the pool must not wait for them
+            PooledBuffer buffer(owner_.chunkSize_, BufferPool::Wait::No);
+            long n = handle.read(buffer, long(owner_.chunkSize_));
+            if (n <= 0) {
+                break;
+            }
+
+            AutoLock<MutexCond> lock(owner_.cond_);
+            part_.chunks_.emplace_back(std::move(buffer), size_t(n));
+            part_.bytes_ += size_t(n);
+            owner_.cond_.broadcast();
+        }
+
+        opened = false;
+        handle.close();
+    }
+    catch (std::exception& e) {
+        Log::error() << "MultiHandleReaderTask got an exception: " << e.what() << " " << handle << std::endl;
+        error = e.what();
+        if (opened) {
+            try {
+                handle.close();
+            }
+            catch (std::exception& e) {
+                Log::error() << "MultiHandleReaderTask got an exception: " << e.what() << " " << handle << std::endl;
+            }
+        }
+    }
+
+    AutoLock<MutexCond> lock(owner_.cond_);
+    part_.error_ = error;
+    part_.done_  = true;
+    owner_.cond_.broadcast();
+}
+
+MultiHandleReader::MultiHandleReader(const MultiHandle::HandleList& handles, size_t count, size_t bufferSize) :
+    handles_(handles),
+    count_(count),
+    bufferSize_(bufferSize),
+    chunkSize_(std::min<size_t>(bufferSize, 1024 * 1024)),
+    next_(handles.size()),
+    used_(0),
+    position_(0),
+    pool_(new ThreadPool("MultiHandleReader", count + 1)) {
+    ASSERT(bufferSize_ > 0);
+}
+
+MultiHandleReader::~MultiHandleReader() {
+    // Tasks refer to the parts
+    cancel();
+    pool_.reset();
+}
+
+void MultiHandleReader::start(size_t index, const Offset& skip, const Offset& position) {
+    cancel();
+
+    next_     = index;
+    position_ = position;
+
+    if (next_ < handles_.size()) {
+        parts_.emplace_back(new MultiHandlePart(*handles_[next_++], skip));
+        pool_->push(new MultiHandleReaderTask(*this, *parts_.back()));
+    }
+
+    fill();
+}
+
+void MultiHandleReader::fill() {
+    // The current handle, and count_ more
+    while (parts_.size() <= count_ && next_ < handles_.size()) {
+        parts_.emplace_back(new MultiHandlePart(*handles_[next_++], 0));
+        pool_->push(new MultiHandleReaderTask(*this, *parts_.back()));
+    }
+}
+
+void MultiHandleReader::cancel() {
+    AutoLock<MutexCond> lock(cond_);
+
+    for (auto& part : parts_) {
+        part->cancelled_ = true;
+    }
+    cond_.broadcast();
+
+    for (auto& part : parts_) {
+        while (!part->done_) {
+            cond_.wait();
+        }
+    }
+
+    parts_.clear();
+    used_ = 0;
+}
+
+long MultiHandleReader::read(char* buffer, long length) {
+    long total = 0;
+
+    while (length > 0 && !parts_.empty()) {
+        MultiHandlePart& part = *parts_.front();
+        const std::pair<PooledBuffer, size_t>* chunk = nullptr;
+
+        {
+            AutoLock<MutexCond> lock(cond_);
+            while (part.chunks_.empty() && !part.done_) {
+                cond_.wait();
+            }
+
+            if (part.chunks_.empty() && !part.error_.empty()) {
+                if (total > 0) {
+                    break;  // return the data read so far, the error is reported on the next call
+                }
+                throw ReadError(part.error_);
+            }
+
+            if (!part.chunks_.empty()) {
+                chunk = &part.chunks_.front();
+            }
+        }
+
+        // End of this handle, read ahead the next one
+        if (!chunk) {
+            parts_.pop_front();
+            fill();
+            continue;
+        }
+
+        // The first chunk is not touched by the task until consumed
+        long n = std::min(length, long(chunk->second - used_));
+        ::memcpy(buffer, static_cast<const char*>(chunk->first) + used_, size_t(n));
+
+        buffer += n;
+        total += n;
+        length -= n;
+        position_ += n;
+
+        AutoLock<MutexCond> lock(cond_);
+        used_ += size_t(n);
+        if (used_ == chunk->second) {
+            part.bytes_ -= chunk->second;
+            part.chunks_.pop_front();
+            used_ = 0;
+            cond_.broadcast();
+        }
+    }
+
+    return total;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 ClassSpec MultiHandle::classSpec_ = {
     &DataHandle::classSpec(),
     "MultiHandle",
@@ -27,13 +287,20 @@ ClassSpec MultiHandle::classSpec_ = {
 Reanimator<MultiHandle> MultiHandle::reanimator_;
 
 MultiHandle::MultiHandle() :
-    current_(datahandles_.end()), read_(false) {}
+    current_(datahandles_.end()),
+    read_(false),
+    prefetch_(defaultPrefetch()),
+    prefetchBufferSize_(defaultPrefetchBufferSize()) {}
 
 MultiHandle::MultiHandle(const std::vector<DataHandle*>& v) :
-    datahandles_(v), current_(datahandles_.end()), read_(false) {}
+    datahandles_(v),
+    current_(datahandles_.end()),
+    read_(false),
+    prefetch_(defaultPrefetch()),
+    prefetchBufferSize_(defaultPrefetchBufferSize()) {}
 
 MultiHandle::MultiHandle(Stream& s) :
-    DataHandle(s), read_(false) {
+    DataHandle(s), read_(false), prefetch_(defaultPrefetch()), prefetchBufferSize_(defaultPrefetchBufferSize()) {
     unsigned long size;
     s >> size;
 
@@ -58,6 +325,8 @@ void MultiHandle::encode(Stream& s) const {
 }
 
 MultiHandle::~MultiHandle() {
+    // The reader refers to the handles
+    reader_.reset();
     for (size_t i = 0; i < datahandles_.size(); i++) {
         delete datahandles_[i];
     }
@@ -90,10 +359,32 @@ void MultiHandle::operator+=(const Length& length) {
     length_.push_back(length);
 }
 
+void MultiHandle::prefetch(size_t count, size_t bufferSize) {
+    ASSERT(bufferSize > 0);
+    prefetch_           = count;
+    prefetchBufferSize_ = bufferSize;
+}
+
+void MultiHandle::startReader(size_t index, const Offset& skip, const Offset& position) {
+    if (!reader_) {
+        reader_.reset(new MultiHandleReader(datahandles_, prefetch_, prefetchBufferSize_));
+    }
+    reader_->start(index, skip, position);
+}
+
 Length MultiHandle::openForRead() {
 
     read_ = true;
 
+    if (prefetch_ > 0) {
+        // Before the handles are opened by the reader
+        Length estimate = this->estimate();
+        current_        = datahandles_.end();
+        reader_.reset();
+        startReader(0, 0, 0);
+        return estimate;
+    }
+
     current_ = datahandles_.begin();
     openCurrent();
 
@@ -159,6 +450,10 @@ long MultiHandle::read1(char* buffer, long length) {
 }
 
 long MultiHandle::read(void* buffer, long length) {
+    if (reader_) {
+        return reader_->read(static_cast<char*>(buffer), length);
+    }
+
     char* p    = static_cast<char*>(buffer);
     long n     = 0;
     long total = 0;
@@ -219,6 +514,7 @@ long MultiHandle::write(const void* buffer, long length) {
 }
 
 void MultiHandle::close() {
+    reader_.reset();
     if (current_ != datahandles_.end()) {
         (*current_)->close();
     }
@@ -233,6 +529,10 @@ void MultiHandle::flush() {
 
 void MultiHandle::rewind() {
     ASSERT(read_);
+    if (reader_) {
+        startReader(0, 0, 0);
+        return;
+    }
     if (current_ != datahandles_.end()) {
         (*current_)->close();
     }
@@ -306,6 +606,7 @@ DataHandle* MultiHandle::clone() const {
     for (size_t i = 0; i < datahandles_.size(); i++) {
         (*mh) += datahandles_[i]->clone();
     }
+    mh->prefetch(prefetch_, prefetchBufferSize_);
     return mh;
 }
 
@@ -320,6 +621,9 @@ bool MultiHandle::canSeek() const {
 }
 
 Offset MultiHandle::position() {
+    if (reader_) {
+        return reader_->position();
+    }
     long long accumulated = 0;
     for (HandleList::iterator it = datahandles_.begin(); it != current_ && it != datahandles_.end(); ++it) {
         accumulated += (*it)->size();
@@ -330,6 +634,10 @@ Offset MultiHandle::position() {
 Offset MultiHandle::seek(const Offset& offset) {
     ASSERT(read_);  /// seek only allowed on read mode
 
+    if (reader_) {
+        reader_->cancel();
+    }
+
     if (current_ != datahandles_.end()) {
         (*current_)->close();
     }
@@ -339,12 +647,20 @@ Offset MultiHandle::seek(const Offset& offset) {
     for (current_ = datahandles_.begin(); current_ != datahandles_.end(); ++current_) {
         long long size = (*current_)->size();
         if (accumulated <= seekto && seekto < accumulated + size) {
+            if (reader_) {
+                startReader(current_ - datahandles_.begin(), seekto - accumulated, offset);
+                current_ = datahandles_.end();
+                return offset;
+            }
             openCurrent();
             (*current_)->seek(seekto - accumulated);
             return offset;
         }
         accumulated += size;
     }
+    if (reader_) {
+        startReader(datahandles_.size(), 0, accumulated);
+    }
     // check if we went beyond EOF which is POSIX compliant, but we ASSERT so we find possible bugs
     Offset beyond = seekto - accumulated;
     ASSERT(not beyond);
@@ -354,6 +670,10 @@ Offset MultiHandle::seek(const Offset& offset) {
 void MultiHandle::restartReadFrom(const Offset& offset) {
     Log::warning() << *this << " restart read from " << offset << std::endl;
     ASSERT(read_);
+
+    // Carry on without reading ahead
+    reader_.reset();
+
     if (current_ != datahandles_.end()) {
         (*current_)->close();
     }
@@ -464,8 +784,35 @@ void MultiHandle::collectMetrics(const std::string& what) const {
 }
 
 
-bool MultiHandle::compress(bool) {
-    return false;
+bool MultiHandle::compress(bool sorted) {
+    // lengths refer to the handles as given, and the handles may be open
+    if (!length_.empty() || current_ != datahandles_.end() || reader_) {
+        return false;
+    }
+
+    bool changed = false;
+
+    // merge consecutive handles, e.g. parts of the same file, so that they can be read together
+    std::vector<DataHandle*> v;
+    v.reserve(datahandles_.size());
+    for (auto* dh : datahandles_) {
+        if (!v.empty() && v.back()->merge(dh)) {
+            delete dh;
+            changed = true;
+            continue;
+        }
+        v.push_back(dh);
+    }
+    std::swap(datahandles_, v);
+    current_ = datahandles_.end();
+
+    for (auto* dh : datahandles_) {
+        if (dh->compress(sorted)) {
+            changed = true;
+        }
+    }
+
+    return changed;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
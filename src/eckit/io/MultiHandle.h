@@ -17,12 +17,24 @@
 #ifndef eckit_filesystem_MultiHandle_h
 #define eckit_filesystem_MultiHandle_h
 
+#include <memory>
+
 #include "eckit/io/DataHandle.h"
 
 namespace eckit {
 
+class MultiHandleReader;
+
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Concatenation of DataHandles
+///
+/// By default, the handles are read one after the other, each being opened when the previous one is exhausted. With
+/// prefetch(count), the current handle and the `count` following ones are opened and read concurrently, each into up
+/// to `bufferSize` bytes of buffers, while the data is consumed in order; this hides the latency of remote or slow
+/// handles. The defaults are given by multiHandlePrefetch (0, no prefetching) and multiHandlePrefetchBufferSize, or
+/// ECKIT_MULTI_HANDLE_PREFETCH and ECKIT_MULTI_HANDLE_PREFETCH_BUFFER_SIZE. Writing, and the lengths used to split the
+/// data written, are not affected.
 class MultiHandle : public DataHandle {
 public:
     typedef std::vector<DataHandle*> HandleList;
@@ -44,6 +56,11 @@ public:
     virtual void operator+=(DataHandle*);
     virtual void operator+=(const Length&);
 
+    // -- Methods
+
+    /// Read ahead the `count` handles following the current one, from the next openForRead()
+    void prefetch(size_t count, size_t bufferSize = 4 * 1024 * 1024);
+
     // -- Overridden methods
 
     // From DataHandle
@@ -98,11 +115,16 @@ private:
     mutable std::set<std::string> requiredAttributes_;
     bool read_;
 
+    size_t prefetch_;
+    size_t prefetchBufferSize_;
+    std::unique_ptr<MultiHandleReader> reader_;
+
     // -- Methods
 
     void openCurrent();
     void open();
     long read1(char*, long);
+    void startReader(size_t index, const Offset& skip, const Offset& position);
 
     // -- Class members
 
@@ -0,0 +1,234 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include "eckit/eckit_config.h"
+
+#if eckit_HAVE_SENDFILE
+#include <sys/sendfile.h>
+#endif
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/io/NativeTransfer.h"
+#include "eckit/io/TransferWatcher.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// Kernel calls, tried in this order until one is supported by the descriptors
+enum class Method {
+    CopyFileRange,
+    SendFile,
+    Splice,
+    None
+};
+
+/// Errors with which the kernel refuses a call for these descriptors, before any data was transferred
+/// (EINVAL is ambiguous, e.g. sendfile from a descriptor without mmap, so a call that worked once is not retried)
+bool unsupported(int err) {
+    return err == EINVAL || err == EXDEV || err == ENOSYS || err == EOPNOTSUPP || err == ESPIPE || err == ETXTBSY;
+}
+
+class Pipe {
+public:
+    Pipe() { fd_[0] = fd_[1] = -1; }
+
+    ~Pipe() {
+        for (int fd : fd_) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+    Pipe(const Pipe&)            = delete;
+    Pipe& operator=(const Pipe&) = delete;
+
+    /// Transfer through the pipe, splicing in from `in` then out to `out`
+    ssize_t splice(int in, off_t* offset, int out, size_t length) {
+#if eckit_HAVE_SPLICE
+        if (fd_[0] < 0) {
+            SYSCALL(::pipe2(fd_, O_CLOEXEC));
+            // a larger pipe means fewer calls, ignore failures (e.g. above /proc/sys/fs/pipe-max-size)
+            ::fcntl(fd_[1], F_SETPIPE_SZ, 1024 * 1024);
+        }
+
+        ssize_t len = ::splice(in, offset, fd_[1], nullptr, length, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (len <= 0) {
+            return len;
+        }
+
+        // The data is now in the pipe, so it has to be written out
+        for (ssize_t done = 0; done < len;) {
+            ssize_t n = ::splice(fd_[0], nullptr, out, nullptr, size_t(len - done), SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                throw FailedSystemCall("splice");
+            }
+            done += n;
+        }
+
+        return len;
+#else
+        errno = ENOSYS;
+        return -1;
+#endif
+    }
+
+private:
+    int fd_[2];
+};
+
+/// @returns bytes transferred, 0 at the end of the data, or -1 if no method is supported
+/// @param probing if no data was transferred yet, so that an unsupported method falls back to the next one
+ssize_t copy(Method& method, int in, off_t offset, int out, size_t length, Pipe& pipe, bool probing) {
+    off_t* poffset = offset < 0 ? nullptr : &offset;
+
+    for (;;) {
+        ssize_t len = -1;
+        errno       = ENOSYS;
+
+        switch (method) {
+            case Method::CopyFileRange:
+#if eckit_HAVE_COPY_FILE_RANGE
+                len = ::copy_file_range(in, poffset, out, nullptr, length, 0);
+#endif
+                break;
+
+            case Method::SendFile:
+#if eckit_HAVE_SENDFILE
+                len = ::sendfile(out, in, poffset, length);
+#endif
+                break;
+
+            case Method::Splice:
+                len = pipe.splice(in, poffset, out, length);
+                break;
+
+            case Method::None:
+                return -1;
+        }
+
+        if (len >= 0) {
+            return len;
+        }
+
+        if (errno == EINTR) {
+            continue;
+        }
+
+        if (!probing || !unsupported(errno)) {
+            throw FailedSystemCall("NativeTransfer");
+        }
+
+        method = Method(int(method) + 1);
+    }
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool NativeTransfer::possible(DataHandle& from, DataHandle& to, const TransferWatcher& watcher) {
+#if eckit_HAVE_COPY_FILE_RANGE || eckit_HAVE_SENDFILE || eckit_HAVE_SPLICE
+    static bool nativeTransfer = Resource<bool>("nativeTransfer;$ECKIT_NATIVE_TRANSFER", true);
+
+    if (!nativeTransfer || watcher.needsData()) {
+        return false;
+    }
+
+    off_t offset;
+    long long length;
+    if (from.nativeReadFd(offset, length) < 0) {
+        return false;
+    }
+
+    int out = to.nativeWriteFd();
+    if (out < 0) {
+        return false;
+    }
+
+    // None of the kernel calls write to a file opened for append
+    int flags = ::fcntl(out, F_GETFL);
+    return flags >= 0 && !(flags & O_APPEND);
+#else
+    return false;
+#endif
+}
+
+Length NativeTransfer::transfer(DataHandle& from, DataHandle& to, const Length& length, long chunk,
+                                TransferWatcher& watcher, bool& end) {
+    ASSERT(chunk > 0);
+
+    end = false;
+
+    Method method = Method::CopyFileRange;
+    Pipe pipe;
+
+    int out      = to.nativeWriteFd();
+    Length total = 0;
+
+    while (length == Length(0) || total < length) {
+        off_t offset;
+        long long available;
+
+        int in = from.nativeReadFd(offset, available);
+        if (in < 0 || out < 0) {
+            break;
+        }
+
+        if (available == 0) {
+            end = true;
+            break;
+        }
+
+        long long n = chunk;
+        if (available > 0) {
+            n = std::min(n, available);
+        }
+        if (length != Length(0)) {
+            n = std::min(n, (long long)(length - total));
+        }
+
+        ssize_t len = copy(method, in, offset, out, size_t(n), pipe, total == Length(0));
+        if (len <= 0) {
+            // before any data, 0 may also mean the kernel cannot copy from this file (e.g. procfs), so read() tells
+            end = len == 0 && total > Length(0);
+            break;
+        }
+
+        from.nativeAdvance(len);
+        to.nativeAdvance(len);
+        watcher.watch(nullptr, len);
+        total += len;
+    }
+
+    if (length != Length(0) && total == length) {
+        end = true;
+    }
+
+    return total;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
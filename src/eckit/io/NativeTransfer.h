@@ -0,0 +1,45 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_NativeTransfer_h
+#define eckit_io_NativeTransfer_h
+
+#include "eckit/io/Length.h"
+
+namespace eckit {
+
+class DataHandle;
+class TransferWatcher;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Copies data between two open DataHandles within the kernel, without going through a user-space buffer
+///
+/// Uses copy_file_range (file to file), sendfile (file to anything) or splice through a pipe (socket to anything),
+/// on the descriptors exposed by DataHandle::nativeReadFd() and DataHandle::nativeWriteFd().
+class NativeTransfer {
+public:  // methods
+    /// @returns if both handles expose descriptors, the watcher does not need the data, and it is enabled
+    /// (nativeTransfer;$ECKIT_NATIVE_TRANSFER)
+    static bool possible(DataHandle& from, DataHandle& to, const TransferWatcher&);
+
+    /// Transfer up to `length` bytes, or until the end of `from` if `length` is 0, in chunks of `chunk` bytes
+    /// @returns bytes transferred, fewer if the kernel cannot transfer (more) between these descriptors, in which case
+    /// the caller should continue with read() and write() from the handles' positions, unless `end` is set (the end
+    /// of `from`, or `length`, was reached)
+    static Length transfer(DataHandle& from, DataHandle& to, const Length& length, long chunk, TransferWatcher&,
+                           bool& end);
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
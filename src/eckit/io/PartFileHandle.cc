@@ -9,6 +9,7 @@
  */
 
 
+#include <cstring>
 #include <numeric>
 
 #include "eckit/io/cluster/NodeInfo.h"
@@ -17,12 +18,30 @@
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/PartFileHandle.h"
 
+#include "eckit/config/Resource.h"
+#include "eckit/io/PooledFile.h"
 #include "eckit/io/PooledHandle.h"
+#include "eckit/io/ReadPlan.h"
 
 namespace eckit {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Ranges closer than this are read together (the bytes between them are discarded)
+static size_t coalesceGap() {
+    static size_t gap = Resource<size_t>("PartFileHandleCoalesceGap;$ECKIT_PART_FILE_HANDLE_COALESCE_GAP", 64 * 1024);
+    return gap;
+}
+
+/// Memory for reading parts ahead, 0 to read parts one by one. Only used if the parts are dense, see dense()
+static size_t windowSize() {
+    static size_t window = Resource<size_t>("PartFileHandleReadWindow;$ECKIT_PART_FILE_HANDLE_READ_WINDOW",
+                                            64 * 1024 * 1024);
+    return window;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 ClassSpec PartFileHandle::classSpec_ = {
     &DataHandle::classSpec(),
     "PartFileHandle",
@@ -47,7 +66,7 @@ void PartFileHandle::encode(Stream& s) const {
 }
 
 PartFileHandle::PartFileHandle(Stream& s) :
-    DataHandle(s), pos_(0), index_(0) {
+    DataHandle(s), pos_(0), index_(0), first_(0), last_(0) {
     s >> path_;
     s >> offset_;
     s >> length_;
@@ -56,14 +75,14 @@ PartFileHandle::PartFileHandle(Stream& s) :
 }
 
 PartFileHandle::PartFileHandle(const PathName& name, const OffsetList& offset, const LengthList& length) :
-    path_(name), handle_(), pos_(0), index_(0), offset_(offset), length_(length) {
+    path_(name), handle_(), pos_(0), index_(0), offset_(offset), length_(length), first_(0), last_(0) {
     //    Log::info() << "PartFileHandle::PartFileHandle " << name << std::endl;
     ASSERT(offset_.size() == length_.size());
     compress(false);
 }
 
 PartFileHandle::PartFileHandle(const PathName& name, const Offset& offset, const Length& length) :
-    path_(name), handle_(), pos_(0), index_(0), offset_(1, offset), length_(1, length) {}
+    path_(name), handle_(), pos_(0), index_(0), offset_(1, offset), length_(1, length), first_(0), last_(0) {}
 
 
 DataHandle* PartFileHandle::clone() const {
@@ -80,7 +99,23 @@ bool PartFileHandle::compress(bool sorted) {
 
 PartFileHandle::~PartFileHandle() {}
 
+bool PartFileHandle::dense() const {
+    // Reading ahead pays off if coalescing nearby parts at least halves the number of reads
+    return offset_.size() > 1 && 2 * ReadPlan(offset_, length_, coalesceGap()).blocks().size() <= offset_.size();
+}
+
 Length PartFileHandle::openForRead() {
+    first_ = last_ = 0;
+
+    if (windowSize() > 0 && dense()) {
+        if (!file_) {
+            file_.reset(new PooledFile(path_));
+        }
+        file_->open();
+        rewind();
+        return estimate();
+    }
+
     if (!handle_) {
         // The handle may already exists if a  restartReadFrom()
         // is requested
@@ -99,9 +134,67 @@ void PartFileHandle::openForAppend(const Length&) {
     NOTIMP;
 }
 
-long PartFileHandle::read1(char* buffer, long length) {
-    ASSERT(handle_);
+void PartFileHandle::loadWindow() {
+    ASSERT(file_);
+
+    // parts from the current one, up to the window size
+    const size_t window = windowSize();
 
+    OffsetList offset;
+    LengthList length;
+    size_t size = 0;
+
+    windowPosition_.clear();
+    for (last_ = index_; last_ < offset_.size() && size + size_t(length_[last_]) <= window; ++last_) {
+        offset.push_back(offset_[last_]);
+        length.push_back(length_[last_]);
+        windowPosition_.push_back(size);
+        size += size_t(length_[last_]);
+    }
+    first_ = index_;
+
+    if (first_ == last_) {
+        return;  // part larger than the window, read directly
+    }
+
+    ReadPlan plan(offset, length, coalesceGap());
+    if (window_.size() < size) {
+        window_.resize(size);  // not initialised
+    }
+    plan.read(file_->fileno(), path_, window_);
+}
+
+long PartFileHandle::readWindow(char* buffer, long length) {
+    if (index_ < first_ || last_ <= index_) {
+        loadWindow();
+    }
+
+    long size = std::min(length, long(length_[index_] - Length(pos_)));
+
+    if (first_ == last_) {
+        file_->seek(off_t((long long)offset_[index_] + pos_));
+        long n = file_->read(buffer, size);
+        if (n != size) {
+            std::ostringstream s;
+            s << path_ << ": cannot read " << size << ", got only " << n;
+            throw ReadError(s.str());
+        }
+    }
+    else {
+        const char* window = window_;
+        ::memcpy(buffer, window + windowPosition_[index_ - first_] + size_t(pos_), size_t(size));
+    }
+
+    pos_ += size;
+    if (pos_ >= length_[index_]) {
+        index_++;
+        pos_ = 0;
+    }
+
+    return size;
+}
+
+long PartFileHandle::read1(char* buffer, long length) {
     // skip empty entries if any
     while (index_ < offset_.size() && length_[index_] == Length(0)) {
         index_++;
@@ -111,6 +204,12 @@ long PartFileHandle::read1(char* buffer, long length) {
         return 0;
     }
 
+    if (file_) {
+        return readWindow(buffer, length);
+    }
+
+    ASSERT(handle_);
+
     Length ll = (long long)offset_[index_] + Length(pos_);
     off_t pos = ll;
 
@@ -140,6 +239,43 @@ long PartFileHandle::read1(char* buffer, long length) {
 }
 
 
+int PartFileHandle::nativeReadFd(off_t& offset, long long& length) {
+    // skip empty entries if any
+    while (index_ < offset_.size() && length_[index_] == Length(0)) {
+        index_++;
+    }
+
+    int fd = -1;
+    if (file_) {
+        fd = file_->fileno();
+    }
+    else {
+        ASSERT(handle_);
+        fd = handle_->nativeReadFd(offset, length);
+    }
+
+    if (index_ == offset_.size()) {
+        offset = 0;
+        length = 0;
+        return fd;
+    }
+
+    offset = off_t((long long)offset_[index_] + pos_);
+    length = (long long)length_[index_] - pos_;
+    return fd;
+}
+
+void PartFileHandle::nativeAdvance(const Length& len) {
+    ASSERT(index_ < offset_.size());
+    ASSERT(Length(pos_) + len <= length_[index_]);
+
+    pos_ += (long long)len;
+    if (pos_ >= length_[index_]) {
+        index_++;
+        pos_ = 0;
+    }
+}
+
 long PartFileHandle::read(void* buffer, long length) {
     char* p = (char*)buffer;
 
@@ -160,6 +296,11 @@ long PartFileHandle::write(const void*, long) {
 }
 
 void PartFileHandle::close() {
+    if (file_) {
+        file_->close();
+        window_.resize(0);
+        first_ = last_ = 0;
+    }
     if (handle_) {
         handle_->close();
         // Don't delete the handle here so the PooledHandle entry continues
@@ -18,13 +18,16 @@
 #define eckit_filesystem_PartFileHandle_h
 
 #include <memory>
+#include <vector>
 
 #include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
 #include "eckit/io/DataHandle.h"
 #include "eckit/types/Types.h"
 
 namespace eckit {
 
+class PooledFile;
 class PooledHandle;
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -55,6 +58,9 @@ public:  // methods
     void print(std::ostream&) const override;
     bool merge(DataHandle*) override;
     bool compress(bool = false) override;
+
+    int nativeReadFd(off_t& offset, long long& length) override;
+    void nativeAdvance(const Length&) override;
     Length size() override;
     Length estimate() override;
 
@@ -88,8 +94,18 @@ private:  // members
     OffsetList offset_;
     LengthList length_;
 
+    // vectored reads of many dense parts: parts [first_, last_) are read in window_, see ReadPlan
+    std::unique_ptr<PooledFile> file_;
+    Buffer window_;
+    std::vector<size_t> windowPosition_;
+    Ordinal first_;
+    Ordinal last_;
+
 private:  // methods
     long read1(char*, long);
+    long readWindow(char*, long);
+    bool dense() const;
+    void loadWindow();
 
     static ClassSpec classSpec_;
     static Reanimator<PartFileHandle> reanimator_;
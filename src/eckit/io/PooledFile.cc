@@ -8,226 +8,229 @@
  * does it submit to any jurisdiction.
  */
 
-#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
-#include <thread>
 
 #include "eckit/config/LibEcKit.h"
 #include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
-#include "eckit/io/Buffer.h"
 #include "eckit/io/PooledFile.h"
-#include "eckit/log/Bytes.h"
+#include "eckit/os/Stat.h"
 
 
 namespace eckit {
 
-class PoolFileEntry;
-
-static thread_local std::map<PathName, std::unique_ptr<PoolFileEntry>> pool_;
+class PoolFileRegistry;
 
-struct PoolFileEntryStatus {
-
-    off_t position_;
-    bool opened_;
-
-    PoolFileEntryStatus() :
-        position_(0), opened_(false) {}
-};
+static std::atomic<size_t> poolHits{0};
+static std::atomic<size_t> poolOpens{0};
+static std::atomic<size_t> poolEvictions{0};
 
 class PoolFileEntry {
 public:
     std::string name_;
-    FILE* file_;
-    size_t count_;
 
-    std::unique_ptr<Buffer> buffer_;
+    size_t count_ = 0;  // number of PooledFile attached, guarded by the registry shard
 
-    std::map<const PooledFile*, PoolFileEntryStatus> statuses_;
+    std::mutex mutex_;  // guards fd_
+    int fd_ = -1;
 
-    size_t nbOpens_ = 0;
-    size_t nbReads_ = 0;
-    size_t nbSeeks_ = 0;
+    std::atomic<size_t> nbOpens_{0};
+    std::atomic<size_t> nbReads_{0};
+    std::atomic<size_t> nbSeeks_{0};
 
 public:
-    PoolFileEntry(const std::string& name) :
-        name_(name), file_(nullptr), count_(0) {}
+    explicit PoolFileEntry(const std::string& name) :
+        name_(name) {}
 
     void doClose() {
-        if (file_) {
+        if (fd_ >= 0) {
             Log::debug<LibEcKit>() << "Closing from file " << name_ << std::endl;
-            if (::fclose(file_) != 0) {
+            int fd = fd_;
+            fd_    = -1;
+            poolEvictions++;
+            if (::close(fd) != 0) {
                 throw PooledFileError(name_, "Failed to close", Here());
             }
-            file_ = nullptr;
-            buffer_.reset();
         }
     }
 
-    void add(const PooledFile* file) {
-        ASSERT(statuses_.find(file) == statuses_.end());
-        statuses_[file] = PoolFileEntryStatus();
-    }
-
-    void remove(const PooledFile* file) {
-        auto s = statuses_.find(file);
-        ASSERT(s != statuses_.end());
+    int open() {
+        std::lock_guard<std::mutex> lock(mutex_);
 
-        statuses_.erase(s);
-
-        if (statuses_.size() == 0) {
-            doClose();
-            pool_.erase(name_);
-            // No code after !!!
+        if (fd_ >= 0) {
+            poolHits++;
+            return fd_;
         }
-    }
-
-    void open(const PooledFile* file) {
-        auto s = statuses_.find(file);
-        ASSERT(s != statuses_.end());
-        ASSERT(!s->second.opened_);
-
-        if (!file_) {
-            nbOpens_++;
-            file_ = ::fopen(name_.c_str(), "r");
-            if (!file_) {
-                throw PooledFileError(name_, "Failed to open", Here());
-            }
-
-            Log::debug<LibEcKit>() << "PooledFile::openForRead " << name_ << std::endl;
 
-            static size_t bufferSize = Resource<size_t>("FileHandleIOBufferSize;$FILEHANDLE_IO_BUFFERSIZE;-FileHandleIOBufferSize", 0);
-
-            if (bufferSize) {
-                Log::debug<LibEcKit>() << "PooledFile using " << Bytes(bufferSize) << std::endl;
-                buffer_.reset(new Buffer(bufferSize));
-                Buffer& b = *(buffer_.get());
-                ::setvbuf(file_, b, _IOFBF, bufferSize);
-            }
+        nbOpens_++;
+        poolOpens++;
+        fd_ = ::open(name_.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            throw PooledFileError(name_, "Failed to open", Here());
         }
 
-        s->second.opened_   = true;
-        s->second.position_ = 0;
-    }
-
-    void close(const PooledFile* file) {
-        auto s = statuses_.find(file);
-        ASSERT(s != statuses_.end());
-
-        ASSERT(s->second.opened_);
-        s->second.opened_ = false;
+        Log::debug<LibEcKit>() << "PooledFile::openForRead " << name_ << std::endl;
+        return fd_;
     }
 
-    int fileno(const PooledFile* file) const {
-        auto s = statuses_.find(file);
-        ASSERT(s != statuses_.end());
-        ASSERT(s->second.opened_);
-        return ::fileno(file_);
+    int fileno() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ASSERT(fd_ >= 0);
+        return fd_;
     }
 
-    long read(const PooledFile* file, void* buffer, long len) {
-        auto s = statuses_.find(file);
-        ASSERT(s != statuses_.end());
-        ASSERT(s->second.opened_);
-
-        if (::fseeko(file_, s->second.position_, SEEK_SET) < 0) {
-            throw PooledFileError(name_, "Failed to seek", Here());
-        }
-
-        //      Log::debug<LibEcKit>() < "Reading @ position " << s->second.position_ << " file : " << name_ <<
-        //      std::endl;
+    /// Read from a position, until len bytes are read or the end of file
+    long read(void* buffer, long len, off_t position) {
+        int fd = fileno();
 
+        auto* out     = static_cast<char*>(buffer);
         size_t length = size_t(len);
-        size_t n      = ::fread(buffer, 1, length, file_);
-
-        if (n != length && ::ferror(file_)) {
-            throw PooledFileError(name_, "Read error", Here());
+        size_t n      = 0;
+
+        while (n < length) {
+            ssize_t r = ::pread(fd, out + n, length - n, position + off_t(n));
+            if (r < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw PooledFileError(name_, "Read error", Here());
+            }
+            if (r == 0) {
+                break;
+            }
+            n += size_t(r);
         }
 
-        s->second.position_ = ::ftello(file_);
-
         nbReads_++;
 
-        return n;
+        return long(n);
     }
 
-    long seek(const PooledFile* file, off_t position) {
-        auto s = statuses_.find(file);
-        ASSERT(s != statuses_.end());
-        ASSERT(s->second.opened_);
-
-        if (::fseeko(file_, position, SEEK_SET) != 0) {
+    off_t size() {
+        Stat::Struct info;
+        if (Stat::fstat(fileno(), &info) != 0) {
             std::ostringstream s;
-            s << name_ << ": cannot seek to " << position << " (file=" << ::fileno(file_) << ")";
+            s << name_ << ": cannot seek to end";
             throw ReadError(s.str());
         }
 
-        s->second.position_ = ::ftello(file_);
-
-        ASSERT(s->second.position_ == position);
-
         nbSeeks_++;
 
-        return s->second.position_;
+        return info.st_size;
+    }
+};
+
+/// Pool of entries, sharded by path so that threads using different files do not contend
+///
+/// A PooledFile may be used, and destroyed, by other threads than the one that created it (e.g. by a MultiHandle
+/// reading ahead), so a per-thread pool lives as long as its PooledFile.
+class PoolFileRegistry {
+public:
+    static std::shared_ptr<PoolFileRegistry> instance() {
+        static const bool global = Resource<bool>("PooledFileGlobalPool;$ECKIT_POOLED_FILE_GLOBAL_POOL", false);
+        if (global) {
+            static std::shared_ptr<PoolFileRegistry> registry = std::make_shared<PoolFileRegistry>();
+            return registry;
+        }
+        static thread_local std::shared_ptr<PoolFileRegistry> registry = std::make_shared<PoolFileRegistry>();
+        return registry;
     }
 
-    long seekEnd(const PooledFile* file) {
-        auto s = statuses_.find(file);
-        ASSERT(s != statuses_.end());
-        ASSERT(s->second.opened_);
+    PoolFileEntry* attach(const PathName& name) {
+        auto& shard = shards_[index(name)];
+        std::lock_guard<std::mutex> lock(shard.mutex_);
 
-        if (::fseeko(file_, 0, SEEK_END) != 0) {
-            std::ostringstream s;
-            s << name_ << ": cannot seek to end (file=" << ::fileno(file_) << ")";
-            throw ReadError(s.str());
+        auto j = shard.entries_.find(name);
+        if (j == shard.entries_.end()) {
+            j = shard.entries_.emplace(name, std::unique_ptr<PoolFileEntry>(new PoolFileEntry(name))).first;
         }
 
-        s->second.position_ = ::ftello(file_);
+        auto* entry = j->second.get();
+        entry->count_++;
+        return entry;
+    }
 
-        nbSeeks_++;
+    void detach(PoolFileEntry* entry) {
+        std::unique_ptr<PoolFileEntry> last;
+
+        auto& shard = shards_[index(entry->name_)];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex_);
+            ASSERT(entry->count_ > 0);
+            if (--entry->count_ == 0) {
+                auto j = shard.entries_.find(entry->name_);
+                ASSERT(j != shard.entries_.end());
+                last = std::move(j->second);
+                shard.entries_.erase(j);
+            }
+        }
 
-        return s->second.position_;
+        if (last) {
+            last->doClose();
+        }
     }
+
+private:
+    static constexpr size_t shards = 16;
+
+    struct Shard {
+        std::mutex mutex_;
+        std::map<PathName, std::unique_ptr<PoolFileEntry>> entries_;
+    };
+
+    static size_t index(const PathName& name) { return std::hash<std::string>()(name.asString()) % shards; }
+
+    Shard shards_[shards];
 };
 
 
 PooledFile::PooledFile(const PathName& name) :
-    name_(name), entry_(nullptr) {
-    auto j = pool_.find(name);
-    if (j == pool_.end()) {
-        pool_.emplace(std::make_pair(name, std::unique_ptr<PoolFileEntry>(new PoolFileEntry(name))));
-        j = pool_.find(name);
-    }
-
-    entry_ = (*j).second.get();
-    entry_->add(this);
-}
+    name_(name),
+    registry_(PoolFileRegistry::instance()),
+    entry_(registry_->attach(name)),
+    position_(0),
+    opened_(false) {}
 
 PooledFile::~PooledFile() {
     ASSERT(entry_);
-    entry_->remove(this);
+    registry_->detach(entry_);
 }
 
 void PooledFile::open() {
     ASSERT(entry_);
-    entry_->open(this);
+    ASSERT(!opened_);
+    entry_->open();
+    opened_   = true;
+    position_ = 0;
 }
 
 void PooledFile::close() {
     ASSERT(entry_);
-    entry_->close(this);
+    ASSERT(opened_);
+    opened_ = false;
 }
 
 off_t PooledFile::seek(off_t offset) {
     ASSERT(entry_);
-    return entry_->seek(this, offset);
+    ASSERT(opened_);
+    entry_->nbSeeks_++;
+    return position_ = offset;
 }
 
 off_t PooledFile::seekEnd() {
     ASSERT(entry_);
-    return entry_->seekEnd(this);
+    ASSERT(opened_);
+    return position_ = entry_->size();
 }
 
 off_t PooledFile::rewind() {
@@ -236,7 +239,8 @@ off_t PooledFile::rewind() {
 
 int PooledFile::fileno() const {
     ASSERT(entry_);
-    return entry_->fileno(this);
+    ASSERT(opened_);
+    return entry_->fileno();
 }
 
 size_t PooledFile::nbOpens() const {
@@ -254,9 +258,20 @@ size_t PooledFile::nbSeeks() const {
     return entry_->nbSeeks_;
 }
 
+PooledFile::Statistics PooledFile::statistics() {
+    Statistics s;
+    s.hits_      = poolHits;
+    s.opens_     = poolOpens;
+    s.evictions_ = poolEvictions;
+    return s;
+}
+
 long PooledFile::read(void* buffer, long len) {
     ASSERT(entry_);
-    return entry_->read(this, buffer, len);
+    ASSERT(opened_);
+    long n = entry_->read(buffer, len, position_);
+    position_ += n;
+    return n;
 }
 
 PooledFileError::PooledFileError(const std::string& file, const std::string& msg, const CodeLocation& loc) :
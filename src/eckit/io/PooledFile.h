@@ -15,6 +15,8 @@
 #ifndef eckit_io_PooledFile_h
 #define eckit_io_PooledFile_h
 
+#include <memory>
+
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/memory/NonCopyable.h"
@@ -23,8 +25,22 @@
 namespace eckit {
 
 class PoolFileEntry;
+class PoolFileRegistry;
 
+/// Read-only file sharing its file descriptor with the other PooledFile of the same path
+///
+/// Each PooledFile has its own position, and reads are positional (pread), so PooledFile of the same path never
+/// serialise on a shared file offset. The pool is per-thread by default; set PooledFileGlobalPool (or
+/// $ECKIT_POOLED_FILE_GLOBAL_POOL) for a process-wide pool, sharded by path to limit lock contention.
 class PooledFile : private NonCopyable {
+public:
+    /// Pool counters (process-wide)
+    struct Statistics {
+        size_t hits_      = 0;  ///< opens served by an already open file descriptor
+        size_t opens_     = 0;  ///< files opened
+        size_t evictions_ = 0;  ///< files closed, when no longer used by any PooledFile
+    };
+
 public:
     PooledFile(const PathName& name);
 
@@ -51,9 +67,14 @@ public:
     size_t nbReads() const;
     size_t nbSeeks() const;
 
+    static Statistics statistics();
+
 private:
     PathName name_;
+    std::shared_ptr<PoolFileRegistry> registry_;
     PoolFileEntry* entry_;
+    off_t position_;
+    bool opened_;
 };
 
 
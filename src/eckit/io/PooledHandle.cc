@@ -9,7 +9,9 @@
  */
 
 #include <cstdio>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "eckit/config/LibEcKit.h"
@@ -25,10 +27,20 @@ namespace eckit {
 
 class PoolHandleEntry;
 
-/// @note in anonymous namespace to solve some compilers link issue (eg. xlc)
-namespace {
-static thread_local std::map<PathName, std::unique_ptr<PoolHandleEntry>> pool_;
-}
+/// Entries of the PooledHandle created by a thread
+///
+/// A PooledHandle may be used, and destroyed, by other threads than the one that created it (e.g. by a MultiHandle
+/// reading ahead), so the entries are guarded by a mutex, and the pool lives as long as its PooledHandle.
+class PoolHandleMap {
+public:
+    std::mutex mutex_;
+    std::map<PathName, std::unique_ptr<PoolHandleEntry>> entries_;
+
+    static std::shared_ptr<PoolHandleMap> instance() {
+        static thread_local std::shared_ptr<PoolHandleMap> pool = std::make_shared<PoolHandleMap>();
+        return pool;
+    }
+};
 
 static size_t maxPooledHandles() {
     static int maxPooledHandles = eckit::Resource<int>("$ECKIT_MAX_POOLED_HANDLES;maxPooledHandles", 128);
@@ -46,6 +58,7 @@ struct PoolHandleEntryStatus {
 
 class PoolHandleEntry {
 public:
+    PoolHandleMap& pool_;
     PathName path_;
     std::unique_ptr<DataHandle> handle_;
     Length estimate_;
@@ -60,8 +73,8 @@ public:
     size_t nbCloses_ = 0;
 
 public:
-    explicit PoolHandleEntry(const PathName& path) :
-        path_(path), handle_(nullptr), count_(0) {}
+    PoolHandleEntry(PoolHandleMap& pool, const PathName& path) :
+        pool_(pool), path_(path), handle_(nullptr), count_(0) {}
     ~PoolHandleEntry() { LOG_DEBUG_LIB(LibEcKit) << *this << std::endl; }
 
     friend std::ostream& operator<<(std::ostream& s, const PoolHandleEntry& e) {
@@ -95,7 +108,7 @@ public:
 
         if (statuses_.size() == 0) {
             doClose();
-            pool_.erase(path_);
+            pool_.entries_.erase(path_);
             // No code after !!!
         }
     }
@@ -134,7 +147,7 @@ public:
     void checkMaxPooledHandles() {
         size_t opened = 0;
 
-        for (auto i = pool_.begin(); i != pool_.end(); ++i) {
+        for (auto i = pool_.entries_.begin(); i != pool_.entries_.end(); ++i) {
             if ((*i).second->handle_) {
                 opened++;
             }
@@ -143,7 +156,7 @@ public:
         if (opened >= maxPooledHandles()) {
             LOG_DEBUG_LIB(LibEcKit) << "PooledHandle maximum number of open files reached: " << maxPooledHandles()
                                     << std::endl;
-            for (auto i = pool_.begin(); i != pool_.end(); ++i) {
+            for (auto i = pool_.entries_.begin(); i != pool_.entries_.end(); ++i) {
                 if ((*i).second->canClose()) {
                     (*i).second->doClose();
                 }
@@ -176,6 +189,24 @@ public:
         return n;
     }
 
+    int nativeReadFd(const PooledHandle* handle, off_t& offset, long long& length) {
+        auto s = statuses_.find(handle);
+        ASSERT(s != statuses_.end());
+        ASSERT(s->second.opened_);
+
+        // The underlying handle is shared, only its descriptor is used
+        int fd = handle_->nativeReadFd(offset, length);
+        offset = s->second.position_;
+        length = -1;
+        return fd;
+    }
+
+    void nativeAdvance(const PooledHandle* handle, const Length& len) {
+        auto s = statuses_.find(handle);
+        ASSERT(s != statuses_.end());
+        s->second.position_ += len;
+    }
+
     long seek(const PooledHandle* handle, Offset position) {
         auto s = statuses_.find(handle);
         ASSERT(s != statuses_.end());
@@ -195,11 +226,14 @@ public:
 
 
 PooledHandle::PooledHandle(const PathName& path) :
-    path_(path), entry_(nullptr) {
-    auto j = pool_.find(path);
-    if (j == pool_.end()) {
-        pool_.emplace(std::make_pair(path, std::unique_ptr<PoolHandleEntry>(new PoolHandleEntry(path))));
-        j = pool_.find(path);
+    path_(path), pool_(PoolHandleMap::instance()), entry_(nullptr) {
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
+
+    auto j = pool_->entries_.find(path);
+    if (j == pool_->entries_.end()) {
+        pool_->entries_.emplace(
+            std::make_pair(path, std::unique_ptr<PoolHandleEntry>(new PoolHandleEntry(*pool_, path))));
+        j = pool_->entries_.find(path);
     }
 
     entry_ = (*j).second.get();
@@ -208,6 +242,7 @@ PooledHandle::PooledHandle(const PathName& path) :
 
 PooledHandle::~PooledHandle() {
     ASSERT(entry_);
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
     entry_->remove(this);
 }
 
@@ -218,6 +253,7 @@ void PooledHandle::print(std::ostream& s) const {
 
 Length PooledHandle::openForRead() {
     ASSERT(entry_);
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
     return entry_->open(this);
 }
 
@@ -235,31 +271,49 @@ long PooledHandle::write(const void*, long) {
 
 void PooledHandle::close() {
     ASSERT(entry_);
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
     entry_->close(this);
 }
 
 Offset PooledHandle::seek(const Offset& offset) {
     ASSERT(entry_);
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
     return entry_->seek(this, offset);
 }
 
+int PooledHandle::nativeReadFd(off_t& offset, long long& length) {
+    ASSERT(entry_);
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
+    return entry_->nativeReadFd(this, offset, length);
+}
+
+void PooledHandle::nativeAdvance(const Length& len) {
+    ASSERT(entry_);
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
+    entry_->nativeAdvance(this, len);
+}
+
 size_t PooledHandle::nbOpens() const {
     ASSERT(entry_);
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
     return entry_->nbOpens_;
 }
 
 size_t PooledHandle::nbReads() const {
     ASSERT(entry_);
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
     return entry_->nbReads_;
 }
 
 size_t PooledHandle::nbSeeks() const {
     ASSERT(entry_);
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
     return entry_->nbSeeks_;
 }
 
 long PooledHandle::read(void* buffer, long len) {
     ASSERT(entry_);
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
     return entry_->read(this, buffer, len);
 }
 
@@ -269,6 +323,7 @@ void PooledHandle::hash(MD5& md5) const {
 }
 
 Offset PooledHandle::position() {
+    std::lock_guard<std::mutex> lock(pool_->mutex_);
     return entry_->handle_->position();
 }
 
@@ -15,6 +15,8 @@
 #ifndef eckit_io_PooledHandle_h
 #define eckit_io_PooledHandle_h
 
+#include <memory>
+
 #include "eckit/exception/Exceptions.h"
 #include "eckit/filesystem/PathName.h"
 #include "eckit/io/DataHandle.h"
@@ -23,6 +25,7 @@
 namespace eckit {
 
 class PoolHandleEntry;
+class PoolHandleMap;
 
 class PooledHandle : public DataHandle {
 public:
@@ -43,6 +46,9 @@ public:
     void hash(MD5& md5) const override;
     Offset position() override;
 
+    int nativeReadFd(off_t& offset, long long& length) override;
+    void nativeAdvance(const Length&) override;
+
     // for testing
 
     size_t nbOpens() const;
@@ -51,6 +57,7 @@ public:
 
 private:
     PathName path_;
+    std::shared_ptr<PoolHandleMap> pool_;
     PoolHandleEntry* entry_;
 
     void print(std::ostream& s) const override;
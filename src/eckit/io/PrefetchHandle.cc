@@ -0,0 +1,349 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/PrefetchHandle.h"
+#include "eckit/log/Timer.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/thread/Thread.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class PrefetchHandleReader : public Thread {
+    PrefetchHandle& owner_;
+    void run() override;
+
+public:
+    PrefetchHandleReader(PrefetchHandle& owner) :
+        owner_(owner) {}
+};
+
+void PrefetchHandleReader::run() {
+    while (!stopped()) {
+        size_t slot = 0;
+        {
+            AutoLock<MutexCond> lock(owner_.cond_);
+            while (!stopped() && !(owner_.reading_ && owner_.filled_ < owner_.count_)) {
+                owner_.cond_.wait();
+            }
+
+            if (stopped()) {
+                break;
+            }
+
+            slot         = owner_.tail_;
+            owner_.busy_ = true;
+        }
+
+        long length = -1;
+        std::string error;
+
+        try {
+            Buffer& buffer = owner_.buffers_[slot];
+            length         = owner_.handle().read(buffer.data(), long(buffer.size()));
+            if (length < 0) {
+                error = "PrefetchHandleReader: read failed";
+            }
+        }
+        catch (std::exception& e) {
+            Log::error() << "PrefetchHandleReader got an exception: " << e.what() << " " << owner_ << std::endl;
+            error = e.what();
+        }
+
+        AutoLock<MutexCond> lock(owner_.cond_);
+        owner_.busy_ = false;
+
+        // Discard what was read if cancelled meanwhile
+        if (owner_.reading_) {
+            if (!error.empty()) {
+                owner_.error_   = true;
+                owner_.message_ = error;
+                owner_.reading_ = false;
+            }
+            else if (length == 0) {
+                owner_.eof_     = true;
+                owner_.reading_ = false;
+            }
+            else {
+                owner_.lengths_[slot] = length;
+                owner_.tail_          = (owner_.tail_ + 1) % owner_.count_;
+                owner_.filled_++;
+            }
+        }
+
+        owner_.cond_.broadcast();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+PrefetchHandle::PrefetchHandle(DataHandle* h, size_t count, size_t bufferSize) :
+    HandleHolder(h),
+    count_(count),
+    bufferSize_(bufferSize),
+    lengths_(count, 0),
+    head_(0),
+    tail_(0),
+    filled_(0),
+    used_(0),
+    position_(0),
+    reading_(false),
+    busy_(false),
+    eof_(false),
+    error_(false),
+    stallTime_(0),
+    stalls_(0),
+    thread_(new PrefetchHandleReader(*this), false) {
+    ASSERT(count_ > 0);
+    ASSERT(bufferSize_ > 0);
+    buffers_.reserve(count_);
+    for (size_t i = 0; i < count_; ++i) {
+        buffers_.emplace_back(bufferSize_);
+    }
+    thread_.start();
+}
+
+PrefetchHandle::PrefetchHandle(DataHandle& h, size_t count, size_t bufferSize) :
+    HandleHolder(h),
+    count_(count),
+    bufferSize_(bufferSize),
+    lengths_(count, 0),
+    head_(0),
+    tail_(0),
+    filled_(0),
+    used_(0),
+    position_(0),
+    reading_(false),
+    busy_(false),
+    eof_(false),
+    error_(false),
+    stallTime_(0),
+    stalls_(0),
+    thread_(new PrefetchHandleReader(*this), false) {
+    ASSERT(count_ > 0);
+    ASSERT(bufferSize_ > 0);
+    buffers_.reserve(count_);
+    for (size_t i = 0; i < count_; ++i) {
+        buffers_.emplace_back(bufferSize_);
+    }
+    thread_.start();
+}
+
+PrefetchHandle::~PrefetchHandle() {
+    thread_.stop();
+    {
+        // Under the lock, so that the reader is either waiting, or yet to check stopped()
+        AutoLock<MutexCond> lock(cond_);
+        reading_ = false;
+        cond_.broadcast();
+    }
+    thread_.wait();
+}
+
+void PrefetchHandle::start() {
+    AutoLock<MutexCond> lock(cond_);
+    head_ = tail_ = filled_ = 0;
+    used_                   = 0;
+    eof_                    = false;
+    error_                  = false;
+    reading_                = true;
+    cond_.broadcast();
+}
+
+void PrefetchHandle::cancel() {
+    AutoLock<MutexCond> lock(cond_);
+    reading_ = false;
+    while (busy_) {
+        cond_.wait();
+    }
+    head_ = tail_ = filled_ = 0;
+    used_                   = 0;
+}
+
+Length PrefetchHandle::openForRead() {
+    Length estimate = handle().openForRead();
+    position_       = 0;
+    start();
+    return estimate;
+}
+
+void PrefetchHandle::openForWrite(const Length&) {
+    NOTIMP;
+}
+
+void PrefetchHandle::openForAppend(const Length&) {
+    NOTIMP;
+}
+
+long PrefetchHandle::write(const void*, long) {
+    NOTIMP;
+}
+
+long PrefetchHandle::read(void* buffer, long length) {
+    char* p    = static_cast<char*>(buffer);
+    long total = 0;
+
+    while (length > 0) {
+        size_t slot;
+        long available;
+        {
+            AutoLock<MutexCond> lock(cond_);
+
+            if (filled_ == 0 && reading_) {
+                Timer timer;
+                stalls_++;
+                while (filled_ == 0 && reading_) {
+                    cond_.wait();
+                }
+                stallTime_ += timer.elapsed();
+            }
+
+            if (filled_ == 0) {
+                if (error_ && total == 0) {
+                    throw ReadError(message_);
+                }
+                break;  // end of data, or an error reported on the next call
+            }
+
+            slot      = head_;
+            available = lengths_[slot] - used_;
+        }
+
+        // The head buffer is not touched by the reader thread until consumed
+        long n = std::min(length, available);
+        ::memcpy(p, static_cast<const char*>(buffers_[slot].data()) + used_, size_t(n));
+
+        p += n;
+        total += n;
+        length -= n;
+
+        AutoLock<MutexCond> lock(cond_);
+        used_ += n;
+        position_ += n;
+        if (used_ == lengths_[slot]) {
+            head_ = (head_ + 1) % count_;
+            used_ = 0;
+            filled_--;
+            cond_.broadcast();
+        }
+    }
+
+    return total;
+}
+
+void PrefetchHandle::close() {
+    cancel();
+    handle().close();
+
+    LOG_DEBUG_LIB(LibEcKit) << *this << " stalled " << stalls_ << " times, " << stallTime_ << " seconds" << std::endl;
+}
+
+void PrefetchHandle::rewind() {
+    cancel();
+    handle().rewind();
+    position_ = 0;
+    start();
+}
+
+Offset PrefetchHandle::seek(const Offset& offset) {
+    {
+        AutoLock<MutexCond> lock(cond_);
+
+        // Within the data already read ahead, consume it
+        if (offset >= position_) {
+            long long skip      = (long long)(offset - position_);
+            long long available = 0;
+            for (size_t i = 0; i < filled_; ++i) {
+                available += lengths_[(head_ + i) % count_];
+            }
+            available -= used_;
+
+            if (skip <= available) {
+                while (skip > 0) {
+                    long n = std::min<long long>(skip, lengths_[head_] - used_);
+                    used_ += n;
+                    skip -= n;
+                    if (used_ == lengths_[head_]) {
+                        head_ = (head_ + 1) % count_;
+                        used_ = 0;
+                        filled_--;
+                    }
+                }
+                position_ = offset;
+                cond_.broadcast();
+                return position_;
+            }
+        }
+    }
+
+    // Otherwise restart from there
+    cancel();
+    position_ = handle().seek(offset);
+    start();
+    return position_;
+}
+
+void PrefetchHandle::skip(const Length& length) {
+    seek(position_ + length);
+}
+
+bool PrefetchHandle::canSeek() const {
+    return handle().canSeek();
+}
+
+Offset PrefetchHandle::position() {
+    return position_;
+}
+
+Length PrefetchHandle::size() {
+    return handle().size();
+}
+
+Length PrefetchHandle::estimate() {
+    return handle().estimate();
+}
+
+double PrefetchHandle::stallTime() const {
+    AutoLock<MutexCond> lock(cond_);
+    return stallTime_;
+}
+
+size_t PrefetchHandle::stalls() const {
+    AutoLock<MutexCond> lock(cond_);
+    return stalls_;
+}
+
+void PrefetchHandle::print(std::ostream& s) const {
+    s << "PrefetchHandle[";
+    handle().print(s);
+    s << ",count=" << count_ << ",bufferSize=" << bufferSize_ << ']';
+}
+
+std::string PrefetchHandle::title() const {
+    return std::string("{") + handle().title() + "}";
+}
+
+void PrefetchHandle::collectMetrics(const std::string& what) const {
+    handle().collectMetrics(what);
+}
+
+DataHandle* PrefetchHandle::clone() const {
+    return new PrefetchHandle(handle().clone(), count_, bufferSize_);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
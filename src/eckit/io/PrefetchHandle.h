@@ -0,0 +1,117 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_PrefetchHandle_h
+#define eckit_io_PrefetchHandle_h
+
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/io/HandleHolder.h"
+#include "eckit/thread/MutexCond.h"
+#include "eckit/thread/ThreadControler.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Reads ahead from a DataHandle in a background thread, so that decoding and I/O overlap
+///
+/// A ring of `count` buffers of `bufferSize` bytes, allocated once, is kept filled by a reader thread and consumed by
+/// read(). seek() and skip() within the data already read ahead just consume it; other seeks cancel the read ahead
+/// and restart it from the new position. The time read() waits for data is reported by stallTime().
+class PrefetchHandle : public DataHandle, public HandleHolder {
+public:
+    /// Contructor, taking ownership
+
+    PrefetchHandle(DataHandle*, size_t count = 4, size_t bufferSize = 4 * 1024 * 1024);
+
+    /// Contructor, not taking ownership
+
+    PrefetchHandle(DataHandle&, size_t count = 4, size_t bufferSize = 4 * 1024 * 1024);
+
+    /// Destructor
+
+    ~PrefetchHandle() override;
+
+    // -- Methods
+
+    /// Time spent by read() waiting for the reader thread, in seconds
+    double stallTime() const;
+
+    /// Number of times read() had to wait for the reader thread
+    size_t stalls() const;
+
+    // -- Overridden methods
+
+    // From DataHandle
+
+    Length openForRead() override;
+    void openForWrite(const Length&) override;
+    void openForAppend(const Length&) override;
+
+    long read(void*, long) override;
+    long write(const void*, long) override;
+    void close() override;
+    void rewind() override;
+    void print(std::ostream&) const override;
+    void skip(const Length&) override;
+
+    Offset seek(const Offset&) override;
+    bool canSeek() const override;
+
+    Length size() override;
+    Length estimate() override;
+    Offset position() override;
+
+    DataHandle* clone() const override;
+
+private:  // methods
+    void start();
+    void cancel();
+
+    std::string title() const override;
+    void collectMetrics(const std::string& what) const override;
+
+private:  // members
+    size_t count_;
+    size_t bufferSize_;
+
+    std::vector<Buffer> buffers_;
+    std::vector<long> lengths_;
+
+    size_t head_;    ///< next buffer to consume
+    size_t tail_;    ///< next buffer to fill
+    size_t filled_;  ///< buffers filled and not consumed
+    long used_;      ///< bytes consumed from the head buffer
+
+    Offset position_;
+
+    bool reading_;  ///< reader thread may read ahead
+    bool busy_;     ///< reader thread is reading
+    bool eof_;
+    bool error_;
+    std::string message_;
+
+    double stallTime_;
+    size_t stalls_;
+
+    mutable MutexCond cond_;
+
+    ThreadControler thread_;  // must be last
+
+    friend class PrefetchHandleReader;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
@@ -13,10 +13,21 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
 #include "eckit/eckit.h"
 
+#include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
+#include "eckit/io/FDataSync.h"
+#include "eckit/io/FileAdvice.h"
 #include "eckit/io/RawFileHandle.h"
+#include "eckit/log/Log.h"
+#include "eckit/maths/Functions.h"
 #include "eckit/os/Stat.h"
 
 
@@ -24,27 +35,117 @@ namespace eckit {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+namespace {
+
+constexpr size_t ALIGNMENT = 4096;  // O_DIRECT alignment of buffers, offsets and lengths
+
+bool aligned(const void* p) {
+    return reinterpret_cast<uintptr_t>(p) % ALIGNMENT == 0;
+}
+
+size_t directBufferSize() {
+    static size_t size = Resource<size_t>("rawFileHandleDirectBufferSize;$ECKIT_RAW_FILE_HANDLE_DIRECT_BUFFER_SIZE",
+                                          8 * 1024 * 1024);
+    return std::max(eckit::round(size, ALIGNMENT), ALIGNMENT);
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void RawFileHandle::print(std::ostream& s) const {
-    s << "RawFileHandle[" << path_ << ']';
+    s << "RawFileHandle[" << path_;
+    if (direct_) {
+        s << ",direct";
+    }
+    s << ']';
 }
 
 void RawFileHandle::encode(Stream& s) const {
     NOTIMP;
 }
 
-RawFileHandle::RawFileHandle(const std::string& path, bool overwrite) :
-    path_(path), overwrite_(overwrite), fd_(-1) {}
+RawFileHandle::RawFileHandle(const std::string& path, bool overwrite, bool direct) :
+    path_(path),
+    overwrite_(overwrite),
+    direct_(direct),
+    fd_(-1),
+    uncached_(false),
+    aligned_(false),
+    read_(false),
+    buffer_(nullptr),
+    bufferSize_(0),
+    used_(0),
+    bufferOffset_(0),
+    offset_(0) {}
 
 
 RawFileHandle::~RawFileHandle() {
     if (fd_ != -1) {
         close();
     }
+    ::free(buffer_);
 }
 
-Length RawFileHandle::openForRead() {
-    SYSCALL(fd_ = ::open(std::string(path_).c_str(), O_RDONLY));
+void RawFileHandle::open(int flags) {
+    uncached_ = false;
+    aligned_  = false;
+
+    if (direct_) {
+#ifdef O_DIRECT
+        fd_ = ::open(path_.c_str(), flags | O_DIRECT, 0777);
+        if (fd_ == -1 && errno == EINVAL) {
+            Log::warning() << "RawFileHandle: " << path_ << " does not support O_DIRECT, using buffered I/O"
+                           << std::endl;
+        }
+#else
+        Log::debug() << "RawFileHandle: O_DIRECT is not supported, using buffered I/O" << std::endl;
+#endif
+    }
+
+    if (fd_ == -1) {
+        SYSCALL2(fd_ = ::open(path_.c_str(), flags, 0777), path_);
+    }
+    else {
+        uncached_ = true;
+        aligned_  = true;
+    }
+
     SYSCALL(::fcntl(fd_, F_SETFD, FD_CLOEXEC));
+
+    if (aligned_ && buffer_ == nullptr) {
+        bufferSize_ = directBufferSize();
+        void* p     = nullptr;
+        if (::posix_memalign(&p, ALIGNMENT, bufferSize_) != 0) {
+            throw OutOfMemory();
+        }
+        buffer_ = static_cast<char*>(p);
+    }
+
+    used_         = 0;
+    bufferOffset_ = 0;
+    offset_       = 0;
+}
+
+void RawFileHandle::disableDirect() {
+#ifdef O_DIRECT
+    int flags;
+    SYSCALL2(flags = ::fcntl(fd_, F_GETFL), path_);
+    if (flags & O_DIRECT) {
+        SYSCALL2(::fcntl(fd_, F_SETFL, flags & ~O_DIRECT), path_);
+    }
+#endif
+    uncached_ = false;
+}
+
+Length RawFileHandle::openForRead() {
+    read_ = true;
+    open(O_RDONLY);
+
+    if (!aligned_ && fileHandleAdviseSequential()) {
+        fadvise(fd_, FileAdvice::Sequential);
+    }
+
     struct stat st;
     SYSCALL(::fstat(fd_, &st));
     ASSERT(sizeof(st.st_size) == sizeof(long long));
@@ -52,13 +153,13 @@ Length RawFileHandle::openForRead() {
 }
 
 void RawFileHandle::openForWrite(const Length&) {
+    read_ = false;
     if (overwrite_) {
-        fd_ = SYSCALL(::open(std::string(path_).c_str(), O_WRONLY, 0777));
+        open(O_WRONLY);
     }
     else {
-        fd_ = SYSCALL(::open(std::string(path_).c_str(), O_WRONLY | O_CREAT, 0777));
+        open(O_WRONLY | O_CREAT);
     }
-    SYSCALL(::fcntl(fd_, F_SETFD, FD_CLOEXEC));
 }
 
 void RawFileHandle::openForAppend(const Length&) {
@@ -66,35 +167,192 @@ void RawFileHandle::openForAppend(const Length&) {
 }
 
 long RawFileHandle::read(void* buffer, long length) {
+    if (aligned_) {
+        return directRead(static_cast<char*>(buffer), length);
+    }
+
     long n;
     SYSCALL(n = ::read(fd_, buffer, length));
     return n;
 }
 
+long RawFileHandle::directRead(char* buffer, long length) {
+    long total = 0;
+
+    auto readAt = [this](char* p, size_t len, off_t offset) {
+        ssize_t n;
+        while ((n = ::pread(fd_, p, len, offset)) < 0 && errno == EINTR) {
+        }
+        if (n < 0 && errno == EINVAL) {
+            // Some filesystems accept O_DIRECT when opening, but not when reading
+            disableDirect();
+            n = ::pread(fd_, p, len, offset);
+        }
+        SYSCALL2(n, path_);
+        return n;
+    };
+
+    while (length > 0) {
+        // From the buffer
+        if (offset_ >= bufferOffset_ && offset_ < bufferOffset_ + off_t(used_)) {
+            size_t n = std::min(size_t(length), size_t(bufferOffset_ + off_t(used_) - offset_));
+            ::memcpy(buffer, buffer_ + (offset_ - bufferOffset_), n);
+            buffer += n;
+            length -= long(n);
+            total += long(n);
+            offset_ += off_t(n);
+            continue;
+        }
+
+        // Straight into the caller's memory
+        if (offset_ % off_t(ALIGNMENT) == 0 && aligned(buffer) && size_t(length) >= ALIGNMENT) {
+            size_t len = size_t(length) - size_t(length) % ALIGNMENT;
+            ssize_t n  = readAt(buffer, len, offset_);
+            buffer += n;
+            length -= long(n);
+            total += long(n);
+            offset_ += off_t(n);
+            if (size_t(n) < len) {
+                break;  // end of file
+            }
+            continue;
+        }
+
+        bufferOffset_ = offset_ - offset_ % off_t(ALIGNMENT);
+        used_         = size_t(readAt(buffer_, bufferSize_, bufferOffset_));
+        if (offset_ >= bufferOffset_ + off_t(used_)) {
+            break;  // end of file
+        }
+    }
+
+    return total;
+}
+
 long RawFileHandle::write(const void* buffer, long length) {
+    if (aligned_) {
+        return directWrite(static_cast<const char*>(buffer), length);
+    }
+
     long n;
     SYSCALL(n = ::write(fd_, buffer, length));
     return n;
 }
 
+long RawFileHandle::directWrite(const char* buffer, long length) {
+    const long total = length;
+
+    while (length > 0) {
+        // Straight from the caller's memory, the buffer starts at an aligned offset
+        if (used_ == 0 && aligned(buffer) && size_t(length) >= ALIGNMENT) {
+            size_t len = size_t(length) - size_t(length) % ALIGNMENT;
+            writeBlocks(buffer, len, bufferOffset_);
+            buffer += len;
+            length -= long(len);
+            bufferOffset_ += off_t(len);
+            offset_ += off_t(len);
+            continue;
+        }
+
+        size_t n = std::min(size_t(length), bufferSize_ - used_);
+        ::memcpy(buffer_ + used_, buffer, n);
+        buffer += n;
+        length -= long(n);
+        used_ += n;
+        offset_ += off_t(n);
+
+        if (used_ == bufferSize_) {
+            writeBuffer(false);
+        }
+    }
+
+    return total;
+}
+
+void RawFileHandle::writeBlocks(const char* buffer, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t n = ::pwrite(fd_, buffer, length, offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno == EINVAL) {
+            // Some filesystems accept O_DIRECT when opening, but not when writing
+            disableDirect();
+            n = ::pwrite(fd_, buffer, length, offset);
+        }
+        SYSCALL2(n, path_);
+        buffer += n;
+        length -= size_t(n);
+        offset += off_t(n);
+    }
+}
+
+void RawFileHandle::writeBuffer(bool tail) {
+    size_t length = tail ? used_ : used_ - used_ % ALIGNMENT;
+    if (length == 0) {
+        return;
+    }
+
+    if (length % ALIGNMENT) {
+        // The file size is not a multiple of the block size, write the tail without O_DIRECT
+        disableDirect();
+    }
+
+    writeBlocks(buffer_, length, bufferOffset_);
+
+    used_ -= length;
+    ::memmove(buffer_, buffer_ + length, used_);
+    bufferOffset_ += off_t(length);
+}
+
 void RawFileHandle::close() {
+    if (aligned_ && !read_) {
+        writeBuffer(false);
+        writeBuffer(true);
+    }
+
+    if (!aligned_ && !read_ && fileHandleDropWrittenPages()) {
+        // The pages can only be dropped once written back
+        SYSCALL2(eckit::fdatasync(fd_), path_);
+        fadvise(fd_, FileAdvice::DontNeed);
+    }
+
     /// @todo fsync
     SYSCALL(::close(fd_));
     fd_ = -1;
 }
 
 Offset RawFileHandle::position() {
+    if (aligned_) {
+        return offset_;
+    }
     return ::lseek(fd_, 0, SEEK_CUR);
 }
 
 Offset RawFileHandle::seek(const Offset& o) {
+    if (aligned_) {
+        if (!read_ && off_t(o) != offset_) {
+            NOTIMP;  // only sequential writes
+        }
+        offset_ = o;
+        return offset_;
+    }
     return ::lseek(fd_, o, SEEK_SET);
 }
 
 void RawFileHandle::skip(const Length& l) {
+    if (aligned_) {
+        seek(Offset(offset_) + l);
+        return;
+    }
     ::lseek(fd_, l, SEEK_CUR);
 }
 
+void RawFileHandle::adviseSequential() {
+    if (fd_ >= 0 && read_ && !aligned_) {
+        fadvise(fd_, FileAdvice::Sequential);
+    }
+}
+
 Length RawFileHandle::size() {
     Stat::Struct info;
     SYSCALL(Stat::fstat(fd_, &info));
@@ -22,9 +22,15 @@ namespace eckit {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// File handle using system calls directly
+///
+/// With `direct`, the file is opened with O_DIRECT, bypassing the page cache for large streams read or written once.
+/// Data then goes through an aligned buffer of rawFileHandleDirectBufferSize (ECKIT_RAW_FILE_HANDLE_DIRECT_BUFFER_SIZE)
+/// bytes, or directly from the caller's memory when aligned. The unaligned tail of a file is written without
+/// O_DIRECT. Where the filesystem rejects O_DIRECT, the handle falls back to buffered I/O.
 class RawFileHandle : public DataHandle {
 public:
-    RawFileHandle(const std::string& path, bool overwrite = false);
+    RawFileHandle(const std::string& path, bool overwrite = false, bool direct = false);
 
     ~RawFileHandle();
 
@@ -43,13 +49,37 @@ public:
     Offset seek(const Offset&) override;
     bool canSeek() const override { return true; }
     void skip(const Length&) override;
+    void adviseSequential() override;
 
     void encode(Stream&) const override;
 
+    /// @returns if data bypasses the page cache, which stops once O_DIRECT is cleared (for an unaligned tail, or where
+    /// the filesystem rejects it)
+    bool direct() const { return uncached_; }
+
+private:
+    void open(int flags);
+    void disableDirect();
+    long directRead(char*, long);
+    long directWrite(const char*, long);
+    void writeBlocks(const char*, size_t, off_t);
+    void writeBuffer(bool tail);
+
 private:
     std::string path_;
     bool overwrite_;
+    bool direct_;
     int fd_;
+
+    // With O_DIRECT
+    bool uncached_;       ///< the file is opened with O_DIRECT
+    bool aligned_;        ///< data goes through the aligned buffer, at explicit offsets
+    bool read_;
+    char* buffer_;        ///< aligned
+    size_t bufferSize_;
+    size_t used_;         ///< bytes in the buffer
+    off_t bufferOffset_;  ///< of the buffer in the file
+    off_t offset_;        ///< position in the file
 };
 
 //----------------------------------------------------------------------------------------------------------------------
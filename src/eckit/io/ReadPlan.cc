@@ -0,0 +1,125 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <numeric>
+#include <sstream>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/ReadPlan.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ReadPlan::ReadPlan(const OffsetList& offset, const LengthList& length, size_t gap) :
+    gap_(gap), size_(0) {
+    ASSERT(offset.size() == length.size());
+
+    const size_t n = offset.size();
+    offset_.reserve(n);
+    length_.reserve(n);
+    position_.reserve(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        offset_.push_back(off_t(offset[i]));
+        length_.push_back(size_t(length[i]));
+        position_.push_back(size_);
+        size_ += length_.back();
+    }
+
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return offset_[a] < offset_[b]; });
+
+    for (auto i : order) {
+        if (length_[i] == 0) {
+            continue;
+        }
+
+        if (!blocks_.empty()) {
+            auto& b  = blocks_.back();
+            auto end = b.offset_ + off_t(b.length_);
+            if (end <= offset_[i] && offset_[i] - end <= off_t(gap_)) {
+                b.length_ = size_t(offset_[i] - b.offset_) + length_[i];
+                b.ranges_.push_back(i);
+                continue;
+            }
+        }
+
+        blocks_.push_back({offset_[i], length_[i], {i}});
+    }
+}
+
+
+void ReadPlan::read(int fd, const std::string& path, char* buffer) const {
+    std::vector<char> scratch(gap_);
+    std::vector<struct iovec> iov;
+
+    for (const auto& b : blocks_) {
+        iov.clear();
+
+        off_t end = b.offset_;
+        for (auto i : b.ranges_) {
+            if (offset_[i] > end) {
+                iov.push_back({scratch.data(), size_t(offset_[i] - end)});
+            }
+            iov.push_back({buffer + position_[i], length_[i]});
+            end = offset_[i] + off_t(length_[i]);
+        }
+
+        // read, continuing after short reads
+        off_t offset = b.offset_;
+        size_t first = 0;
+        while (first < iov.size()) {
+            int count   = int(std::min<size_t>(iov.size() - first, IOV_MAX));
+            ssize_t len = ::preadv(fd, &iov[first], count, offset);
+            if (len < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw FailedSystemCall("preadv " + path);
+            }
+            if (len == 0) {
+                std::ostringstream s;
+                s << path << ": cannot read " << (b.offset_ + off_t(b.length_) - offset) << " bytes at offset "
+                  << offset << ", end of file";
+                throw ReadError(s.str());
+            }
+
+            offset += len;
+            for (auto n = size_t(len); n > 0;) {
+                auto& v = iov[first];
+                if (n >= v.iov_len) {
+                    n -= v.iov_len;
+                    ++first;
+                }
+                else {
+                    v.iov_base = static_cast<char*>(v.iov_base) + n;
+                    v.iov_len -= n;
+                    n = 0;
+                }
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,65 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_ReadPlan_h
+#define eckit_io_ReadPlan_h
+
+#include <sys/types.h>
+
+#include <string>
+#include <vector>
+
+#include "eckit/io/Length.h"
+#include "eckit/io/Offset.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Plan for reading many byte ranges of a file with few system calls
+///
+/// Ranges are sorted by offset, and ranges closer than a gap threshold are coalesced into blocks, each read with one
+/// preadv (scattering the ranges to their place in the output, in the requested order, and the gaps to a scratch
+/// buffer). Overlapping ranges are not coalesced.
+class ReadPlan {
+public:  // types
+    struct Block {
+        off_t offset_;
+        size_t length_;
+        std::vector<size_t> ranges_;  ///< ranges read by the block, by offset
+    };
+
+public:  // methods
+    ReadPlan(const OffsetList&, const LengthList&, size_t gap);
+
+    const std::vector<Block>& blocks() const { return blocks_; }
+
+    /// @returns size of the output, the sum of the range lengths
+    size_t size() const { return size_; }
+
+    /// Read all ranges, one after the other in the requested order
+    /// @param buffer of size() bytes
+    /// @throws ReadError if the file is too short
+    void read(int fd, const std::string& path, char* buffer) const;
+
+private:  // members
+    std::vector<off_t> offset_;
+    std::vector<size_t> length_;
+    std::vector<size_t> position_;  ///< output position of each range
+    std::vector<Block> blocks_;
+    size_t gap_;
+    size_t size_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
+
+#endif
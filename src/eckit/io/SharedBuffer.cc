@@ -35,4 +35,43 @@ void SharedBuffer::print(std::ostream& os) const {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+SharedBufferView::SharedBufferView(const void* data, size_t size, CountedBuffer* owner) :
+    data_(static_cast<const char*>(data)), size_(size), owner_(owner) {
+    if (owner_) {
+        owner_->attach();
+    }
+}
+
+SharedBufferView::SharedBufferView(const SharedBuffer& buffer) :
+    SharedBufferView(buffer->data(), buffer.size(), buffer.operator->()) {}
+
+SharedBufferView::~SharedBufferView() {
+    if (owner_) {
+        owner_->detach();
+    }
+}
+
+SharedBufferView::SharedBufferView(const SharedBufferView& other) :
+    SharedBufferView(other.data_, other.size_, other.owner_) {}
+
+SharedBufferView& SharedBufferView::operator=(const SharedBufferView& other) {
+    if (other.owner_) {
+        other.owner_->attach();
+    }
+    if (owner_) {
+        owner_->detach();
+    }
+    data_  = other.data_;
+    size_  = other.size_;
+    owner_ = other.owner_;
+    return *this;
+}
+
+SharedBufferView SharedBufferView::slice(size_t offset, size_t size) const {
+    ASSERT(offset + size <= size_);
+    return SharedBufferView(data_ + offset, size, owner_);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 }  // namespace eckit
@@ -86,6 +86,42 @@ private:                     // members
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// A range of bytes in memory, such as a payload decoded from a MemoryStream without copying it
+/// If the memory belongs to a CountedBuffer (e.g. of a SharedBuffer), the view keeps it alive
+
+class SharedBufferView {
+public:  // methods
+    SharedBufferView() :
+        data_(nullptr), size_(0), owner_(nullptr) {}
+
+    SharedBufferView(const void* data, size_t size, CountedBuffer* owner = nullptr);
+
+    SharedBufferView(const SharedBuffer&);
+
+    ~SharedBufferView();
+
+    SharedBufferView(const SharedBufferView&);
+
+    SharedBufferView& operator=(const SharedBufferView&);
+
+    const void* data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+    /// Part of this view, sharing the same memory
+    SharedBufferView slice(size_t offset, size_t size) const;
+
+    /// This copies the data
+    std::string str() const { return std::string(data_, size_); }
+
+private:  // members
+    const char* data_;
+    size_t size_;
+    CountedBuffer* owner_;  ///< null if the memory is not reference counted
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 }  // namespace eckit
 
 #endif
@@ -74,6 +74,16 @@ void TCPHandle::rewind() {
     NOTIMP;
 }
 
+int TCPHandle::nativeReadFd(off_t& offset, long long& length) {
+    offset = -1;
+    length = -1;
+    return connection_.socket();
+}
+
+int TCPHandle::nativeWriteFd() {
+    return connection_.socket();
+}
+
 DataHandle* TCPHandle::clone() const {
     return new TCPHandle(host_, port_);
 }
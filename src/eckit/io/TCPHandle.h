@@ -45,6 +45,9 @@ public:
     void close() override;
     void rewind() override;
 
+    int nativeReadFd(off_t& offset, long long& length) override;
+    int nativeWriteFd() override;
+
     DataHandle* clone() const override;
 
     void print(std::ostream&) const override;
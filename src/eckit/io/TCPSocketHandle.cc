@@ -58,6 +58,20 @@ long InstantTCPSocketHandle::write(const void* buffer, long length) {
 
 void InstantTCPSocketHandle::close() {}
 
+int InstantTCPSocketHandle::nativeReadFd(off_t& offset, long long& length) {
+    offset = -1;
+    length = -1;
+    return connection_.socket();
+}
+
+int InstantTCPSocketHandle::nativeWriteFd() {
+    return connection_.socket();
+}
+
+void InstantTCPSocketHandle::nativeAdvance(const Length& len) {
+    position_ += len;
+}
+
 void InstantTCPSocketHandle::rewind() {
     seek(0);
 }
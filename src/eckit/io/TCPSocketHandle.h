@@ -53,6 +53,10 @@ public:
     Offset seek(const Offset&) override;
     bool canSeek() const override { return true; }
 
+    int nativeReadFd(off_t& offset, long long& length) override;
+    int nativeWriteFd() override;
+    void nativeAdvance(const Length&) override;
+
     // From Streamable
 
 
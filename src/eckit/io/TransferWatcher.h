@@ -31,6 +31,10 @@ public:
     virtual void fromHandleOpened() {}
     virtual void toHandleOpened() {}
 
+    /// @returns false if watch() does not look at the data, allowing transfers that bypass user space (watch() is
+    /// then called with a null pointer)
+    virtual bool needsData() const { return true; }
+
     virtual ~TransferWatcher() {}
 
     // -- Class methods
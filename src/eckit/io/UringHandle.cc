@@ -0,0 +1,699 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/eckit.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/AIOHandle.h"
+#include "eckit/io/UringHandle.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/log/Log.h"
+#include "eckit/maths/Functions.h"
+#include "eckit/memory/Zero.h"
+#include "eckit/os/Stat.h"
+
+#if eckit_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr size_t ALIGNMENT = 4096;  // O_DIRECT alignment of buffers, offsets and lengths
+
+}  // namespace
+
+struct UringSlot {
+    enum State
+    {
+        FREE,
+        BUSY,
+        READY
+    };
+
+    char* data_    = nullptr;
+    off_t offset_  = 0;  ///< file offset
+    size_t length_ = 0;  ///< bytes to transfer
+    size_t done_   = 0;  ///< bytes transferred
+    size_t used_   = 0;  ///< bytes filled (write) or consumed (read)
+    State state_   = FREE;
+    struct iovec iov_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#if eckit_HAVE_IO_URING
+
+namespace {
+
+constexpr __u64 FSYNC = ~__u64(0);  // user data of fsync requests
+
+int io_uring_setup(unsigned entries, io_uring_params* p) {
+    return int(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int io_uring_enter(int fd, unsigned submit, unsigned complete, unsigned flags) {
+    return int(::syscall(__NR_io_uring_enter, fd, submit, complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr) {
+    return int(::syscall(__NR_io_uring_register, fd, opcode, arg, nr));
+}
+
+}  // namespace
+
+/// Submission and completion queues shared with the kernel
+struct UringRing : private eckit::NonCopyable {
+
+    explicit UringRing(unsigned entries) {
+        io_uring_params p;
+        eckit::zero(p);
+
+        SYSCALL(fd_ = io_uring_setup(entries, &p));
+
+        sqSize_   = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqSize_   = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        sqesSize_ = p.sq_entries * sizeof(io_uring_sqe);
+
+        if (p.features & IORING_FEAT_SINGLE_MMAP) {
+            sqSize_ = cqSize_ = std::max(sqSize_, cqSize_);
+        }
+
+        try {
+            sq_   = map(sqSize_, IORING_OFF_SQ_RING);
+            cq_   = (p.features & IORING_FEAT_SINGLE_MMAP) ? sq_ : map(cqSize_, IORING_OFF_CQ_RING);
+            sqes_ = static_cast<io_uring_sqe*>(map(sqesSize_, IORING_OFF_SQES));
+        }
+        catch (...) {
+            release();  // the destructor is not called
+            throw;
+        }
+
+        auto* sq = static_cast<char*>(sq_);
+        sqHead_  = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sqTail_  = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sqMask_  = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        entries_ = p.sq_entries;
+
+        auto* cq = static_cast<char*>(cq_);
+        cqHead_  = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cqTail_  = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cqMask_  = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_    = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    }
+
+    ~UringRing() { release(); }
+
+    /// Register buffers, so the kernel does not map them on every request (fails if above RLIMIT_MEMLOCK)
+    bool registerBuffers(const std::vector<struct iovec>& iovs) {
+        registered_ = io_uring_register(fd_, IORING_REGISTER_BUFFERS, iovs.data(), unsigned(iovs.size())) == 0;
+        return registered_;
+    }
+
+    /// @returns a cleared submission queue entry (queued, submitted on the next enter)
+    io_uring_sqe& sqe() {
+        unsigned tail = *sqTail_;
+        ASSERT(tail - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) < entries_);
+
+        unsigned index  = tail & sqMask_;
+        io_uring_sqe& e = sqes_[index];
+        eckit::zero(e);
+
+        sqArray_[index] = index;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        return e;
+    }
+
+    /// Submit queued entries and optionally wait for a completion
+    void enter(bool wait) {
+        for (;;) {
+            unsigned submit = *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+            if (submit == 0 && !wait) {
+                return;
+            }
+            if (wait && peek() != nullptr) {
+                wait = false;
+                continue;
+            }
+            if (io_uring_enter(fd_, submit, wait ? 1 : 0, wait ? IORING_ENTER_GETEVENTS : 0) >= 0) {
+                if (!wait) {
+                    return;
+                }
+                wait = peek() == nullptr;
+                continue;
+            }
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                throw FailedSystemCall("io_uring_enter");
+            }
+        }
+    }
+
+    io_uring_cqe* peek() {
+        unsigned head = *cqHead_;
+        return head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE) ? nullptr : &cqes_[head & cqMask_];
+    }
+
+    void advance() { __atomic_store_n(cqHead_, *cqHead_ + 1, __ATOMIC_RELEASE); }
+
+    bool registered() const { return registered_; }
+
+private:
+    void release() {
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqesSize_);
+        }
+        if (cq_ != nullptr && cq_ != sq_) {
+            ::munmap(cq_, cqSize_);
+        }
+        if (sq_ != nullptr) {
+            ::munmap(sq_, sqSize_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    void* map(size_t size, off_t offset) {
+        void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        if (addr == MAP_FAILED) {
+            throw FailedSystemCall("mmap io_uring");
+        }
+        return addr;
+    }
+
+    int fd_ = -1;
+
+    void* sq_ = nullptr;
+    void* cq_ = nullptr;
+    size_t sqSize_;
+    size_t cqSize_;
+    size_t sqesSize_;
+
+    unsigned* sqHead_;
+    unsigned* sqTail_;
+    unsigned* sqArray_;
+    unsigned sqMask_;
+    unsigned entries_;
+    io_uring_sqe* sqes_ = nullptr;
+
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned cqMask_;
+    io_uring_cqe* cqes_;
+
+    bool registered_ = false;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool UringHandle::available() {
+    static const bool available = [] {
+        io_uring_params p;
+        eckit::zero(p);
+        int fd = io_uring_setup(2, &p);
+        if (fd < 0) {
+            Log::debug() << "UringHandle: io_uring not available" << Log::syserr << std::endl;
+            return false;
+        }
+        ::close(fd);
+        return true;
+    }();
+    return available;
+}
+
+void UringHandle::open(int flags) {
+    ASSERT(fd_ == -1);
+
+    if (direct_) {
+        flags |= O_DIRECT;
+    }
+    SYSCALL2(fd_ = ::open(path_.localPath(), flags, 0777), path_);
+
+    ring_.reset(new UringRing(unsigned(depth_ + 1)));  // +1 for fsync
+
+    std::vector<struct iovec> iovs;
+    for (auto& slot : slots_) {
+        char* data = slot.data_;
+        slot       = UringSlot();
+        slot.data_ = data;
+        slot.iov_  = {data, bufferSize_};
+        iovs.push_back(slot.iov_);
+    }
+
+    if (!ring_->registerBuffers(iovs)) {
+        Log::debug() << "UringHandle: cannot register " << Bytes(double(depth_ * bufferSize_)) << " of buffers"
+                     << Log::syserr << ", using unregistered buffers" << std::endl;
+    }
+
+    inflight_ = 0;
+    current_  = 0;
+    next_     = 0;
+    pos_      = 0;
+    end_      = 0;
+    offset_   = 0;
+}
+
+void UringHandle::submit(UringSlot& slot) {
+    ASSERT(slot.done_ < slot.length_);
+
+    const size_t index = size_t(&slot - slots_.data());
+    char* data         = slot.data_ + slot.done_;
+    size_t length      = slot.length_ - slot.done_;
+    if (read_ && direct_) {
+        length = std::min(eckit::round(length, ALIGNMENT), bufferSize_ - slot.done_);  // short read at end of file
+    }
+
+    io_uring_sqe& e = ring_->sqe();
+    e.fd            = fd_;
+    e.off           = __u64(slot.offset_ + off_t(slot.done_));
+    e.user_data     = index;
+
+    if (ring_->registered()) {
+        e.opcode    = read_ ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+        e.addr      = reinterpret_cast<__u64>(data);
+        e.len       = __u32(length);
+        e.buf_index = __u16(index);
+    }
+    else {
+        slot.iov_ = {data, length};
+        e.opcode  = read_ ? IORING_OP_READV : IORING_OP_WRITEV;
+        e.addr    = reinterpret_cast<__u64>(&slot.iov_);
+        e.len     = 1;
+    }
+
+    slot.state_ = UringSlot::BUSY;
+    ++inflight_;
+}
+
+void UringHandle::syncFile() {
+    io_uring_sqe& e = ring_->sqe();
+    e.opcode        = IORING_OP_FSYNC;
+    e.fd            = fd_;
+    e.user_data     = FSYNC;
+    ++inflight_;
+}
+
+void UringHandle::complete(bool wait) {
+    ring_->enter(wait);
+
+    while (io_uring_cqe* cqe = ring_->peek()) {
+        auto data = cqe->user_data;
+        auto res  = cqe->res;
+        ring_->advance();
+
+        ASSERT(inflight_ > 0);
+        --inflight_;
+
+        if (data == FSYNC) {
+            if (res < 0) {
+                throw FailedSystemCall(path_, "io_uring fsync", Here(), -res);
+            }
+            continue;
+        }
+
+        ASSERT(data < slots_.size());
+        UringSlot& slot = slots_[data];
+        ASSERT(slot.state_ == UringSlot::BUSY);
+
+        if (res < 0) {
+            throw FailedSystemCall(path_, read_ ? "io_uring read" : "io_uring write", Here(), -res);
+        }
+
+        if (res == 0) {
+            if (!read_) {
+                std::ostringstream os;
+                os << "UringHandle: only " << slot.done_ << " bytes written instead of " << slot.length_;
+                throw WriteError(os.str());
+            }
+            slot.length_ = slot.done_;  // file shrank since it was opened
+        }
+
+        slot.done_ = std::min(slot.done_ + size_t(res), slot.length_);
+        if (slot.done_ < slot.length_) {
+            submit(slot);  // short transfer, continue
+        }
+        else {
+            slot.state_ = read_ ? UringSlot::READY : UringSlot::FREE;
+        }
+    }
+
+    ring_->enter(false);
+}
+
+void UringHandle::drain() {
+    while (inflight_ > 0) {
+        complete(true);
+    }
+}
+
+UringSlot& UringHandle::freeSlot() {
+    current_ = (current_ + 1) % depth_;
+    while (slots_[current_].state_ != UringSlot::FREE) {
+        complete(true);
+    }
+    return slots_[current_];
+}
+
+void UringHandle::readAhead() {
+    while (pos_ < end_ && slots_[next_].state_ == UringSlot::FREE) {
+        UringSlot& slot = slots_[next_];
+        slot.offset_    = pos_;
+        slot.length_    = std::min(bufferSize_, size_t(end_ - pos_));
+        slot.done_      = 0;
+        slot.used_      = 0;
+        submit(slot);
+
+        pos_ += off_t(slot.length_);
+        next_ = (next_ + 1) % depth_;
+    }
+    complete(false);
+}
+
+long UringHandle::read(void* buffer, long length) {
+    ASSERT(fd_ != -1 && read_);
+
+    auto* out  = static_cast<char*>(buffer);
+    long total = 0;
+
+    while (total < length) {
+        UringSlot& slot = slots_[current_];
+        if (slot.state_ == UringSlot::FREE) {
+            break;  // end of file
+        }
+
+        while (slot.state_ == UringSlot::BUSY) {
+            complete(true);
+        }
+
+        size_t n = std::min(size_t(length - total), slot.done_ - slot.used_);
+        ::memcpy(out + total, slot.data_ + slot.used_, n);
+        slot.used_ += n;
+        total += long(n);
+
+        if (slot.used_ == slot.done_) {
+            slot.state_ = UringSlot::FREE;
+            current_    = (current_ + 1) % depth_;
+            readAhead();
+        }
+    }
+
+    offset_ += total;
+    return total;
+}
+
+long UringHandle::write(const void* buffer, long length) {
+    ASSERT(fd_ != -1 && !read_);
+
+    const auto* in = static_cast<const char*>(buffer);
+    long total     = 0;
+
+    while (total < length) {
+        UringSlot* slot = &slots_[current_];
+        size_t n        = std::min(size_t(length - total), bufferSize_ - slot->used_);
+        ::memcpy(slot->data_ + slot->used_, in + total, n);
+        slot->used_ += n;
+        total += long(n);
+
+        if (slot->used_ == bufferSize_) {
+            slot->offset_ = pos_;
+            slot->length_ = bufferSize_;
+            slot->done_   = 0;
+            submit(*slot);
+            pos_ += off_t(bufferSize_);
+
+            slot        = &freeSlot();
+            slot->used_ = 0;
+        }
+    }
+
+    complete(false);
+
+    offset_ += total;
+    return total;
+}
+
+void UringHandle::flush() {
+    if (fd_ == -1 || read_) {
+        return;
+    }
+
+    // write the filled part of the current buffer (with O_DIRECT, only whole blocks, the tail is kept)
+    UringSlot& slot = slots_[current_];
+    size_t length   = direct_ ? slot.used_ - slot.used_ % ALIGNMENT : slot.used_;
+
+    if (length > 0) {
+        size_t tail  = slot.used_ - length;
+        slot.offset_ = pos_;
+        slot.length_ = length;
+        slot.done_   = 0;
+        submit(slot);
+        pos_ += off_t(length);
+
+        UringSlot& next = freeSlot();
+        ::memcpy(next.data_, slot.data_ + length, tail);
+        next.used_ = tail;
+    }
+
+    // short writes are resubmitted on completion, so the fsync can only be queued once all writes are done
+    drain();
+
+    if (fsync_) {
+        syncFile();
+        drain();
+    }
+}
+
+void UringHandle::writeTail() {
+    UringSlot& slot = slots_[current_];
+    if (slot.used_ == 0) {
+        return;
+    }
+
+    ASSERT(direct_);
+
+    // the file size is not a multiple of the block size, write the tail without O_DIRECT
+    int flags;
+    SYSCALL2(flags = ::fcntl(fd_, F_GETFL), path_);
+    SYSCALL2(::fcntl(fd_, F_SETFL, flags & ~O_DIRECT), path_);
+
+    size_t done = 0;
+    while (done < slot.used_) {
+        ssize_t n;
+        SYSCALL2(n = ::pwrite(fd_, slot.data_ + done, slot.used_ - done, pos_ + off_t(done)), path_);
+        done += size_t(n);
+    }
+
+    pos_ += off_t(slot.used_);
+    slot.used_ = 0;
+
+    if (fsync_) {
+        SYSCALL2(::fsync(fd_), path_);
+    }
+}
+
+void UringHandle::close() {
+    if (fd_ == -1) {
+        return;
+    }
+
+    if (read_) {
+        drain();
+    }
+    else {
+        flush();  // this waits for the async requests to finish
+        writeTail();
+    }
+
+    ring_.reset();
+    SYSCALL2(::close(fd_), path_);
+    fd_ = -1;
+}
+
+#else  // NO eckit_HAVE_IO_URING
+
+struct UringRing {};
+
+bool UringHandle::available() {
+    return false;
+}
+
+void UringHandle::open(int) {
+    NOTIMP;
+}
+
+long UringHandle::read(void*, long) {
+    NOTIMP;
+}
+
+long UringHandle::write(const void*, long) {
+    NOTIMP;
+}
+
+void UringHandle::flush() {
+    NOTIMP;
+}
+
+void UringHandle::close() {}
+
+void UringHandle::drain() {}
+
+void UringHandle::readAhead() {
+    NOTIMP;
+}
+
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+
+UringHandle::UringHandle(const PathName& path, size_t depth, size_t bufferSize, bool fsync, bool direct) :
+    path_(path),
+    slots_(depth),
+    depth_(depth),
+    bufferSize_(eckit::round(bufferSize, ALIGNMENT)),
+    inflight_(0),
+    current_(0),
+    next_(0),
+    fd_(-1),
+    pos_(0),
+    end_(0),
+    offset_(0),
+    fsync_(fsync),
+    direct_(direct),
+    read_(false) {
+    ASSERT(depth_ > 0);
+    ASSERT(bufferSize_ > 0);
+
+    for (auto& slot : slots_) {
+        void* data = nullptr;
+        ASSERT(::posix_memalign(&data, ALIGNMENT, bufferSize_) == 0);
+        slot.data_ = static_cast<char*>(data);
+    }
+}
+
+UringHandle::~UringHandle() {
+    try {
+        close();
+    }
+    catch (std::exception& e) {
+        Log::error() << "UringHandle: " << e.what() << std::endl;
+    }
+
+    for (auto& slot : slots_) {
+        ::free(slot.data_);
+    }
+}
+
+DataHandle* UringHandle::create(const PathName& path, size_t depth, size_t bufferSize, bool fsync, bool direct) {
+    if (available()) {
+        return new UringHandle(path, depth, bufferSize, fsync, direct);
+    }
+    if (direct) {
+        Log::debug() << "UringHandle: AIOHandle does not support O_DIRECT, writing " << path << " buffered"
+                     << std::endl;
+    }
+    return new AIOHandle(path, depth, bufferSize, fsync);
+}
+
+Length UringHandle::openForRead() {
+    read_ = true;
+    open(O_RDONLY);
+
+    Stat::Struct info;
+    SYSCALL2(Stat::fstat(fd_, &info), path_);
+    end_ = info.st_size;
+
+    readAhead();
+    return end_;
+}
+
+void UringHandle::openForWrite(const Length&) {
+    read_ = false;
+    open(O_WRONLY | O_CREAT | O_TRUNC);
+}
+
+void UringHandle::openForAppend(const Length&) {
+    read_ = false;
+    open(O_WRONLY | O_CREAT);
+
+    Stat::Struct info;
+    SYSCALL2(Stat::fstat(fd_, &info), path_);
+    pos_    = info.st_size;
+    offset_ = pos_;
+
+    if (direct_ && pos_ % off_t(ALIGNMENT) != 0) {
+        std::ostringstream os;
+        os << "UringHandle: cannot append with O_DIRECT to " << path_ << ", size " << pos_
+           << " is not a multiple of " << ALIGNMENT;
+        throw BadParameter(os.str(), Here());
+    }
+}
+
+void UringHandle::rewind() {
+    if (!read_) {
+        NOTIMP;
+    }
+
+    drain();
+    for (auto& slot : slots_) {
+        slot.state_ = UringSlot::FREE;
+    }
+
+    current_ = 0;
+    next_    = 0;
+    pos_     = 0;
+    offset_  = 0;
+    readAhead();
+}
+
+void UringHandle::print(std::ostream& s) const {
+    s << "UringHandle[" << path_ << ",depth=" << depth_ << ",bufferSize=" << Bytes(double(bufferSize_))
+      << ",fsync=" << fsync_ << ",direct=" << direct_ << ']';
+}
+
+Length UringHandle::size() {
+    Stat::Struct info;
+    if (fd_ < 0) {
+        SYSCALL2(Stat::stat(path_.localPath(), &info), path_);
+    }
+    else {
+        SYSCALL2(Stat::fstat(fd_, &info), path_);
+    }
+    return info.st_size;
+}
+
+Length UringHandle::estimate() {
+    return size();
+}
+
+Offset UringHandle::position() {
+    return offset_;
+}
+
+std::string UringHandle::title() const {
+    return std::string("Uring[") + PathName::shorten(path_) + "]";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,102 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_io_UringHandle_h
+#define eckit_io_UringHandle_h
+
+#include <memory>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/DataHandle.h"
+
+namespace eckit {
+
+struct UringRing;
+struct UringSlot;
+
+/// Asynchronous file reads and writes through a Linux io_uring, without a thread per file
+///
+/// The handle owns a ring of `depth` pre-allocated (page-aligned, and registered with the kernel if allowed) buffers of
+/// `bufferSize` bytes. Writes are gathered into buffers which are submitted as they fill, up to `depth` in flight;
+/// reads keep up to `depth` buffers read ahead. With `direct`, the file is opened with O_DIRECT (the unaligned tail of
+/// a file is written without it), and with `fsync` flush() and close() submit an fsync ordered after all writes.
+///
+/// @note use create() to fall back to AIOHandle (which only writes) where io_uring is not available
+class UringHandle : public DataHandle {
+
+public:  // methods
+    UringHandle(const PathName& path, size_t depth = 32, size_t bufferSize = 1024 * 1024, bool fsync = false,
+                bool direct = false);
+
+    ~UringHandle() override;
+
+    Length openForRead() override;
+    void openForWrite(const Length&) override;
+    void openForAppend(const Length&) override;
+
+    long read(void*, long) override;
+    long write(const void*, long) override;
+    void close() override;
+    void flush() override;
+    void rewind() override;
+    void print(std::ostream&) const override;
+
+    Length size() override;
+    Length estimate() override;
+    Offset position() override;
+
+    bool canSeek() const override { return false; }
+
+    /// @returns if io_uring can be used (kernel support, and not disabled by seccomp or sysctl)
+    static bool available();
+
+    /// @returns a UringHandle if io_uring is available, otherwise an AIOHandle (which ignores `direct`)
+    static DataHandle* create(const PathName& path, size_t depth = 32, size_t bufferSize = 1024 * 1024,
+                              bool fsync = false, bool direct = false);
+
+private:  // methods
+    void open(int flags);
+    void submit(UringSlot&);
+    void complete(bool wait);
+    void drain();
+    void syncFile();
+    UringSlot& freeSlot();
+    void readAhead();
+    void writeTail();
+
+    std::string title() const override;
+
+protected:  // members
+    PathName path_;
+
+private:  // members
+    std::unique_ptr<UringRing> ring_;
+    std::vector<UringSlot> slots_;
+
+    size_t depth_;
+    size_t bufferSize_;
+    size_t inflight_;
+
+    size_t current_;  ///< slot being filled (write) or consumed (read)
+    size_t next_;     ///< next slot to submit (read)
+
+    int fd_;
+    off_t pos_;      ///< file offset of the data in the current slot (write), or of the next read-ahead (read)
+    off_t end_;      ///< file size (read)
+    off_t offset_;   ///< bytes written or read through the handle
+    bool fsync_;
+    bool direct_;
+    bool read_;
+};
+
+}  // namespace eckit
+
+#endif
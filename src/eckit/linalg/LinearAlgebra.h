@@ -95,6 +95,19 @@ public:
         LinearAlgebraSparse::backend().spmm(A, X, Y);
     }
 
+    /// Compute the product of sparse matrix A and a batch of fields X, in row-major (interleaved) layout
+    /// @note Y must be allocated and sized correctly
+    static void spmm(const SparseMatrix& A, const TensorDouble& X, TensorDouble& Y) {
+        LinearAlgebraSparse::backend().spmm(A, X, Y);
+    }
+
+    /// Compute the product of sparse matrix A and a batch of single precision fields X, in row-major (interleaved)
+    /// layout
+    /// @note Y must be allocated and sized correctly
+    static void spmm(const SparseMatrix& A, const TensorFloat& X, TensorFloat& Y) {
+        LinearAlgebraSparse::backend().spmm(A, X, Y);
+    }
+
     /// Compute the product x A' y with x and y diagonal matrices stored as
     /// vectors and A a sparse matrix
     /// @note B does NOT need to be allocated/sized correctly
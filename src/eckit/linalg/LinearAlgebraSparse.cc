@@ -11,8 +11,13 @@
 
 #include "eckit/linalg/LinearAlgebraSparse.h"
 
+#include <algorithm>
+
 #include "eckit/eckit.h"
+#include "eckit/exception/Exceptions.h"
 #include "eckit/linalg/BackendRegistry.h"
+#include "eckit/linalg/SparseMatrix.h"
+#include "eckit/linalg/Tensor.h"
 #include "eckit/thread/AutoLock.h"
 #include "eckit/thread/Mutex.h"
 
@@ -77,6 +82,94 @@ LinearAlgebraSparse::LinearAlgebraSparse(const std::string& name) {
 }
 
 
+//-----------------------------------------------------------------------------
+
+
+/// Y = A X for row-major (interleaved) fields: the fields are processed in register-sized blocks, each block
+/// accumulating over the non-zeros of a row, so that rows of X and Y are accessed contiguously and Y is written once
+template <typename S>
+static void spmm_row_major(const SparseMatrix& A, const Tensor<S>& X, Tensor<S>& Y) {
+    const auto Ni = A.rows();
+    const auto Nj = A.cols();
+
+    const auto shapeX = X.shape();
+    const auto shapeY = Y.shape();
+
+    ASSERT(X.layout() == Tensor<S>::Layout::RowMajor);
+    ASSERT(Y.layout() == Tensor<S>::Layout::RowMajor);
+    ASSERT(shapeX.size() == 2 && shapeY.size() == 2);
+    ASSERT(shapeX[0] == Nj);
+    ASSERT(shapeY[0] == Ni);
+    ASSERT(shapeY[1] == shapeX[1]);
+
+    const auto Nk = shapeX[1];
+
+    if (A.empty()) {
+        Y.zero();
+        return;
+    }
+
+    const auto* const outer = A.outer();
+    const auto* const inner = A.inner();
+    const auto* const val   = A.data();
+    const auto* const x     = X.data();
+    auto* const y           = Y.data();
+
+    ASSERT(outer[0] == 0);  // expect indices to be 0-based
+
+    constexpr Size block = 16;
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
+    for (Size i = 0; i < Ni; ++i) {
+        auto* const yi = y + i * Nk;
+
+        for (Size k0 = 0; k0 < Nk; k0 += block) {
+            Scalar sum[block] = {};
+
+            if (k0 + block <= Nk) {
+                for (auto c = outer[i]; c < outer[i + 1]; ++c) {
+                    const auto* const xj = x + static_cast<Size>(inner[c]) * Nk + k0;
+                    const auto v         = val[c];
+                    for (Size k = 0; k < block; ++k) {
+                        sum[k] += v * xj[k];
+                    }
+                }
+
+                for (Size k = 0; k < block; ++k) {
+                    yi[k0 + k] = static_cast<S>(sum[k]);
+                }
+                continue;
+            }
+
+            const auto Nb = Nk - k0;
+            for (auto c = outer[i]; c < outer[i + 1]; ++c) {
+                const auto* const xj = x + static_cast<Size>(inner[c]) * Nk + k0;
+                const auto v         = val[c];
+                for (Size k = 0; k < Nb; ++k) {
+                    sum[k] += v * xj[k];
+                }
+            }
+
+            for (Size k = 0; k < Nb; ++k) {
+                yi[k0 + k] = static_cast<S>(sum[k]);
+            }
+        }
+    }
+}
+
+
+void LinearAlgebraSparse::spmm(const SparseMatrix& A, const TensorDouble& X, TensorDouble& Y) const {
+    spmm_row_major(A, X, Y);
+}
+
+
+void LinearAlgebraSparse::spmm(const SparseMatrix& A, const TensorFloat& X, TensorFloat& Y) const {
+    spmm_row_major(A, X, Y);
+}
+
+
 //-----------------------------------------------------------------------------
 
 }  // namespace eckit::linalg
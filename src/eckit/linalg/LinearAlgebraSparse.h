@@ -49,6 +49,18 @@ public:
     /// @note Y must be allocated and sized correctly
     virtual void spmm(const SparseMatrix& A, const Matrix& X, Matrix& Y) const = 0;
 
+    /// Compute the product of sparse matrix A and a batch of fields X, in row-major (interleaved) layout, so each
+    /// non-zero of A is applied to all fields at once
+    /// @note X and Y are row-major with shapes {A.cols(), fields} and {A.rows(), fields}, Y must be allocated and
+    ///       sized correctly
+    virtual void spmm(const SparseMatrix& A, const TensorDouble& X, TensorDouble& Y) const;
+
+    /// Compute the product of sparse matrix A and a batch of single precision fields X (accumulating in double
+    /// precision), in row-major (interleaved) layout
+    /// @note X and Y are row-major with shapes {A.cols(), fields} and {A.rows(), fields}, Y must be allocated and
+    ///       sized correctly
+    virtual void spmm(const SparseMatrix& A, const TensorFloat& X, TensorFloat& Y) const;
+
     /// Compute the product x A' y with x and y diagonal matrices stored as
     /// vectors and A a sparse matrix
     /// @note B does NOT need to be allocated/sized correctly
@@ -47,6 +47,15 @@ Matrix::Matrix(Stream& stream) :
 
     ASSERT(size() > 0);
     ASSERT(array_);
+
+    Size count;
+    if (stream.startArray<Scalar>(count)) {
+        ASSERT(count == rows * cols);
+        stream.readArray(array_, count);
+        return;
+    }
+
+    // Encoded by a previous version
     stream.readBlob(array_, (rows * cols) * sizeof(Scalar));
 }
 
@@ -111,6 +120,10 @@ void Matrix::fill(Scalar value) {
 void Matrix::encode(Stream& stream) const {
     stream << rows_;
     stream << cols_;
+    if (Stream::writeArrays()) {
+        stream.writeArray(array_, rows_ * cols_);
+        return;
+    }
     stream.writeBlob(const_cast<Scalar*>(array_), rows_ * cols_ * sizeof(Scalar));
 }
 
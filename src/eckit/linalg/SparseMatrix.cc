@@ -15,6 +15,7 @@
 #include <cstring>
 #include <iterator>
 #include <numeric>
+#include <utility>
 
 #include "eckit/eckit.h"  // for endianness
 
@@ -159,6 +160,166 @@ SparseMatrix::SparseMatrix(Size rows, Size cols, const std::vector<Triplet>& tri
 }
 
 
+namespace {
+
+/// Sort the entries of each row by column, summing duplicates into the first entry of each column, and set `length`
+/// to the row lengths after summing duplicates
+void sortRows(Size rows, const Index* outer, Index* inner, Scalar* data, std::vector<Index>& length) {
+    length.resize(rows);
+
+#if eckit_HAVE_OMP
+#pragma omp parallel
+#endif
+    {
+        std::vector<std::pair<Index, Scalar>> row;
+
+#if eckit_HAVE_OMP
+#pragma omp for schedule(dynamic, 1024)
+#endif
+        for (Size r = 0; r < rows; ++r) {
+            const auto begin = static_cast<Size>(outer[r]);
+            const auto end   = static_cast<Size>(outer[r + 1]);
+
+            row.clear();
+            for (auto c = begin; c < end; ++c) {
+                row.emplace_back(inner[c], data[c]);
+            }
+
+            // sorting on (column, value) makes sums of duplicates independent of the order entries were inserted
+            std::sort(row.begin(), row.end());
+
+            auto c = begin;
+            for (const auto& [col, value] : row) {
+                if (c > begin && inner[c - 1] == col) {
+                    data[c - 1] += value;
+                    continue;
+                }
+                inner[c] = col;
+                data[c]  = value;
+                ++c;
+            }
+
+            length[r] = Index(c - begin);
+        }
+    }
+}
+
+/// Move rows shortened by sortRows() next to each other, then the index arrays to where the allocator lays them out
+/// for fewer non-zeros, in the same memory (as StandardAllocator does, so there is no copy of the matrix)
+void compactRows(SparseMatrix::Allocator& alloc, SparseMatrix::Shape& shape, SparseMatrix::Layout& layout,
+                 const std::vector<Index>& length) {
+    auto* const outer = layout.outer_;
+    auto* const inner = layout.inner_;
+    auto* const data  = layout.data_;
+
+    Index pos = 0;
+    for (Size r = 0; r < shape.rows_; ++r) {
+        const auto begin = outer[r];
+        outer[r]         = pos;
+        if (pos != begin) {
+            std::copy(inner + begin, inner + begin + length[r], inner + pos);
+            std::copy(data + begin, data + begin + length[r], data + pos);
+        }
+        pos += length[r];
+    }
+    outer[shape.rows_] = pos;
+
+    SparseMatrix::Shape compact(shape);
+    compact.size_ = Size(pos);
+
+    auto next = alloc.allocate(compact);
+    ASSERT(next.data_ == data);
+
+    // Both arrays move towards the start of the memory, outer first as inner follows it
+    std::memmove(next.outer_, outer, compact.sizeofOuter());
+    std::memmove(next.inner_, inner, compact.sizeofInner());
+
+    shape  = compact;
+    layout = next;
+}
+
+}  // namespace
+
+
+SparseMatrix SparseMatrix::fromTriplets(Size rows, Size cols, const std::vector<Triplet>& triplets) {
+    ASSERT(rows > 0 && cols > 0);
+
+    const auto N = triplets.size();
+
+    // Count non-zeros per row (offset by one for the prefix sum), checking indices
+    std::vector<Index> cursor(rows + 1, 0);
+    Size nnz = 0;
+    Size bad = 0;
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for reduction(+ : nnz, bad)
+#endif
+    for (Size n = 0; n < N; ++n) {
+        const auto& t = triplets[n];
+        if (!t.nonZero()) {
+            continue;
+        }
+        if (t.row() >= rows || t.col() >= cols) {
+            ++bad;
+            continue;
+        }
+#if eckit_HAVE_OMP
+#pragma omp atomic
+#endif
+        ++cursor[t.row() + 1];
+        ++nnz;
+    }
+
+    ASSERT(bad == 0);
+    ASSERT(nnz > 0);
+
+    // Allocate for all entries (duplicates included, so possibly more than rows * cols)
+    SparseMatrix A;
+    A.reset();
+    A.shape_.rows_ = rows;
+    A.shape_.cols_ = cols;
+    A.shape_.size_ = nnz;
+    A.spm_         = A.owner_->allocate(A.shape_);
+
+    auto* const outer = A.spm_.outer_;
+    auto* const inner = A.spm_.inner_;
+    auto* const data  = A.spm_.data_;
+
+    std::partial_sum(cursor.begin(), cursor.end(), cursor.begin());
+    std::copy(cursor.begin(), cursor.end(), outer);
+
+    // Scatter entries to their rows (in any order, sorted below)
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
+    for (Size n = 0; n < N; ++n) {
+        const auto& t = triplets[n];
+        if (!t.nonZero()) {
+            continue;
+        }
+
+        Index pos;
+#if eckit_HAVE_OMP
+#pragma omp atomic capture
+#endif
+        pos = cursor[t.row()]++;
+
+        inner[pos] = Index(t.col());
+        data[pos]  = t.value();
+    }
+
+    auto& length = cursor;
+    sortRows(rows, outer, inner, data, length);
+
+    // Compact rows if duplicates were summed
+    if (Size(std::accumulate(length.begin(), length.end(), Index(0))) < nnz) {
+        compactRows(*A.owner_, A.shape_, A.spm_, length);
+    }
+
+    return A;
+}
+
+
 SparseMatrix::SparseMatrix(Stream& s) {
     owner_.reset(new detail::StandardAllocator());
     decode(s);
@@ -389,21 +550,51 @@ SparseMatrix& SparseMatrix::setIdentity(Size rows, Size cols) {
 
 SparseMatrix& SparseMatrix::transpose() {
 
-    /// @note Can SparseMatrix::transpose() be done more efficiently?
-    ///       We are building another matrix and then swapping
+    // Compressed column storage of this matrix is the compressed row storage of its transpose
 
-    std::vector<Triplet> triplets;
-    triplets.reserve(nonZeros());
+    SparseMatrix tmp;
+    tmp.reserve(shape_.cols_, shape_.rows_, shape_.size_);
+
+    // Count entries per column (offset by one for the prefix sum)
+    std::vector<Index> cursor(shape_.cols_ + 1, 0);
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
+    for (Size c = 0; c < shape_.size_; ++c) {
+#if eckit_HAVE_OMP
+#pragma omp atomic
+#endif
+        ++cursor[static_cast<Size>(spm_.inner_[c]) + 1];
+    }
+
+    std::partial_sum(cursor.begin(), cursor.end(), cursor.begin());
+    std::copy(cursor.begin(), cursor.end(), tmp.spm_.outer_);
+
+    // Scatter entries to their columns (in any order, sorted below)
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
     for (Size r = 0; r < shape_.rows_; ++r) {
         for (Index c = spm_.outer_[r]; c < spm_.outer_[r + 1]; ++c) {
-            ASSERT(spm_.inner_[c] >= 0);
-            triplets.push_back(Triplet(Size(spm_.inner_[c]), r, spm_.data_[c]));
+            Index pos;
+#if eckit_HAVE_OMP
+#pragma omp atomic capture
+#endif
+            pos = cursor[static_cast<Size>(spm_.inner_[c])]++;
+
+            tmp.spm_.inner_[pos] = Index(r);
+            tmp.spm_.data_[pos]  = spm_.data_[c];
         }
     }
 
-    std::sort(triplets.begin(), triplets.end());  // triplets must be sorted by row
+    auto& length = cursor;
+    sortRows(tmp.shape_.rows_, tmp.spm_.outer_, tmp.spm_.inner_, tmp.spm_.data_, length);
 
-    SparseMatrix tmp(shape_.cols_, shape_.rows_, triplets);
+    // Duplicate entries (e.g. from the triplets constructor) are summed
+    if (Size(std::accumulate(length.begin(), length.end(), Index(0))) < shape_.size_) {
+        compactRows(*tmp.owner_, tmp.shape_, tmp.spm_, length);
+    }
 
     swap(tmp);
 
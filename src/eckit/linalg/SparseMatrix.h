@@ -142,6 +142,10 @@ public:  // methods
     /// Constructor from triplets
     SparseMatrix(Size rows, Size cols, const std::vector<Triplet>& triplets);
 
+    /// Build from triplets in any order, summing duplicate entries (counting sort directly into the CRS arrays)
+    /// @note triplets with zero value are ignored, as for the constructor from (row-sorted) triplets
+    static SparseMatrix fromTriplets(Size rows, Size cols, const std::vector<Triplet>& triplets);
+
     /// Constructor from Stream
     SparseMatrix(Stream& v);
 
@@ -0,0 +1,355 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#include "eckit/linalg/SparseMatrixFloat.h"
+
+#include <algorithm>
+#include <limits>
+#include <ostream>
+
+#include "eckit/eckit.h"  // for endianness
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/linalg/Matrix.h"
+#include "eckit/linalg/SparseMatrix.h"
+#include "eckit/linalg/Tensor.h"
+#include "eckit/linalg/Vector.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/serialisation/FileStream.h"
+#include "eckit/serialisation/Stream.h"
+
+namespace eckit::linalg {
+
+#if eckit_LITTLE_ENDIAN
+static const bool littleEndian = true;
+#else
+static const bool littleEndian = false;
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SparseMatrixFloat::SparseMatrixFloat() :
+    rows_(0), cols_(0), outer_(1, 0) {}
+
+
+SparseMatrixFloat::SparseMatrixFloat(const SparseMatrix& A, bool deltaIndices) :
+    rows_(A.rows()), cols_(A.cols()), outer_(A.rows() + 1, 0) {
+    const auto nnz = A.nonZeros();
+    if (rows_ == 0) {
+        return;
+    }
+
+    const auto* const outer = A.outer();
+    const auto* const inner = A.inner();
+    const auto* const data  = A.data();
+
+    ASSERT(outer[0] == 0);  // expect indices to be 0-based
+
+    std::copy(outer, outer + rows_ + 1, outer_.begin());
+
+    data_.resize(nnz);
+    for (Size c = 0; c < nnz; ++c) {
+        data_[c] = static_cast<Value>(data[c]);
+    }
+
+    if (deltaIndices) {
+        constexpr auto min = static_cast<Index>(std::numeric_limits<Delta>::min());
+        constexpr auto max = static_cast<Index>(std::numeric_limits<Delta>::max());
+
+        base_.assign(rows_, 0);
+        delta_.resize(nnz);
+
+        bool fits = true;
+        for (Size i = 0; i < rows_ && fits; ++i) {
+            if (outer[i] == outer[i + 1]) {
+                continue;
+            }
+
+            auto col = base_[i] = inner[outer[i]];
+            for (auto c = outer[i]; c < outer[i + 1]; ++c) {
+                const auto d = inner[c] - col;
+                if (d < min || max < d) {
+                    fits = false;
+                    break;
+                }
+                delta_[static_cast<Size>(c)] = static_cast<Delta>(d);
+                col                          = inner[c];
+            }
+        }
+
+        if (fits) {
+            return;
+        }
+
+        Log::debug<LibEcKit>() << "SparseMatrixFloat: column indices do not fit delta-encoding, storing full indices"
+                               << std::endl;
+        base_.clear();
+        delta_.clear();
+    }
+
+    inner_.assign(inner, inner + nnz);
+}
+
+
+SparseMatrixFloat::SparseMatrixFloat(Stream& s) :
+    rows_(0), cols_(0) {
+    decode(s);
+}
+
+
+template <typename F>
+void SparseMatrixFloat::forEachNonZero(Size row, F&& f) const {
+    const auto begin = static_cast<Size>(outer_[row]);
+    const auto end   = static_cast<Size>(outer_[row + 1]);
+
+    if (base_.empty()) {
+        for (auto c = begin; c < end; ++c) {
+            f(static_cast<Size>(inner_[c]), static_cast<Scalar>(data_[c]));
+        }
+        return;
+    }
+
+    auto col = base_[row];
+    for (auto c = begin; c < end; ++c) {
+        col += delta_[c];
+        f(static_cast<Size>(col), static_cast<Scalar>(data_[c]));
+    }
+}
+
+
+void SparseMatrixFloat::spmv(const Vector& x, Vector& y) const {
+    ASSERT(y.rows() == rows_);
+    ASSERT(x.rows() == cols_);
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
+    for (Size i = 0; i < rows_; ++i) {
+        Scalar sum = 0.;
+        forEachNonZero(i, [&](Size j, Scalar v) { sum += v * x[j]; });
+        y[i] = sum;
+    }
+}
+
+
+void SparseMatrixFloat::spmm(const Matrix& X, Matrix& Y) const {
+    const auto Nk = X.cols();
+
+    ASSERT(Y.rows() == rows_);
+    ASSERT(X.rows() == cols_);
+    ASSERT(Y.cols() == Nk);
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
+    for (Size i = 0; i < rows_; ++i) {
+        for (Size k = 0; k < Nk; ++k) {
+            Scalar sum = 0.;
+            forEachNonZero(i, [&](Size j, Scalar v) { sum += v * X(j, k); });
+            Y(i, k) = sum;
+        }
+    }
+}
+
+
+void SparseMatrixFloat::spmm(const TensorDouble& X, TensorDouble& Y) const {
+    const auto shapeX = X.shape();
+    const auto shapeY = Y.shape();
+
+    ASSERT(X.layout() == TensorDouble::Layout::RowMajor);
+    ASSERT(Y.layout() == TensorDouble::Layout::RowMajor);
+    ASSERT(shapeX.size() == 2 && shapeY.size() == 2);
+    ASSERT(shapeX[0] == cols_);
+    ASSERT(shapeY[0] == rows_);
+    ASSERT(shapeY[1] == shapeX[1]);
+
+    const auto Nk       = shapeX[1];
+    const auto* const x = X.data();
+    auto* const y       = Y.data();
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
+    for (Size i = 0; i < rows_; ++i) {
+        auto* const yi = y + i * Nk;
+        std::fill(yi, yi + Nk, 0.);
+        forEachNonZero(i, [&](Size j, Scalar v) {
+            const auto* const xj = x + j * Nk;
+            for (Size k = 0; k < Nk; ++k) {
+                yi[k] += v * xj[k];
+            }
+        });
+    }
+}
+
+
+void SparseMatrixFloat::spmm(const TensorFloat& X, TensorFloat& Y) const {
+    const auto shapeX = X.shape();
+    const auto shapeY = Y.shape();
+
+    ASSERT(X.layout() == TensorFloat::Layout::RowMajor);
+    ASSERT(Y.layout() == TensorFloat::Layout::RowMajor);
+    ASSERT(shapeX.size() == 2 && shapeY.size() == 2);
+    ASSERT(shapeX[0] == cols_);
+    ASSERT(shapeY[0] == rows_);
+    ASSERT(shapeY[1] == shapeX[1]);
+
+    const auto Nk       = shapeX[1];
+    const auto* const x = X.data();
+    auto* const y       = Y.data();
+
+    constexpr Size block = 16;
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
+    for (Size i = 0; i < rows_; ++i) {
+        auto* const yi = y + i * Nk;
+
+        // accumulate in double precision, over blocks of fields
+        for (Size k0 = 0; k0 < Nk; k0 += block) {
+            const auto Nb     = std::min(block, Nk - k0);
+            Scalar sum[block] = {};
+
+            forEachNonZero(i, [&](Size j, Scalar v) {
+                const auto* const xj = x + j * Nk + k0;
+                for (Size k = 0; k < Nb; ++k) {
+                    sum[k] += v * xj[k];
+                }
+            });
+
+            for (Size k = 0; k < Nb; ++k) {
+                yi[k0 + k] = static_cast<float>(sum[k]);
+            }
+        }
+    }
+}
+
+
+SparseMatrix SparseMatrixFloat::toSparseMatrix() const {
+    std::vector<Triplet> triplets;
+    triplets.reserve(nonZeros());
+
+    for (Size i = 0; i < rows_; ++i) {
+        forEachNonZero(i, [&](Size j, Scalar v) { triplets.emplace_back(i, j, v); });
+    }
+
+    return {rows_, cols_, triplets};
+}
+
+
+void SparseMatrixFloat::save(const PathName& path) const {
+    FileStream s(path, "w");
+    auto c = closer(s);
+    encode(s);
+}
+
+
+void SparseMatrixFloat::load(const PathName& path) {
+    FileStream s(path, "r");
+    auto c = closer(s);
+    decode(s);
+}
+
+
+void SparseMatrixFloat::encode(Stream& s) const {
+    s << rows_;
+    s << cols_;
+    s << nonZeros();
+
+    s << littleEndian;
+    s << sizeof(Index);
+    s << sizeof(Value);
+    s << deltaIndices();
+
+    Log::debug<LibEcKit>() << "Encoding matrix : "
+                           << " rows " << rows_ << " cols " << cols_ << " nnz " << nonZeros() << " footprint "
+                           << footprint() << std::endl;
+
+    s.writeLargeBlob(outer_.data(), outer_.size() * sizeof(Index));
+    if (deltaIndices()) {
+        s.writeLargeBlob(base_.data(), base_.size() * sizeof(Index));
+        s.writeLargeBlob(delta_.data(), delta_.size() * sizeof(Delta));
+    }
+    else {
+        s.writeLargeBlob(inner_.data(), inner_.size() * sizeof(Index));
+    }
+    s.writeLargeBlob(data_.data(), data_.size() * sizeof(Value));
+}
+
+
+void SparseMatrixFloat::decode(Stream& s) {
+    Size nnz;
+    s >> rows_;
+    s >> cols_;
+    s >> nnz;
+
+    bool little_endian;
+    s >> little_endian;
+    ASSERT(littleEndian == little_endian);
+
+    size_t index_size;
+    s >> index_size;
+    ASSERT(index_size == sizeof(Index));
+
+    size_t value_size;
+    s >> value_size;
+    ASSERT(value_size == sizeof(Value));
+
+    bool delta;
+    s >> delta;
+
+    outer_.resize(rows_ + 1);
+    data_.resize(nnz);
+    base_.resize(delta ? rows_ : 0);
+    delta_.resize(delta ? nnz : 0);
+    inner_.resize(delta ? 0 : nnz);
+
+    Log::debug<LibEcKit>() << "Decoding matrix : "
+                           << " rows " << rows_ << " cols " << cols_ << " nnz " << nnz << " footprint " << footprint()
+                           << std::endl;
+
+    s.readLargeBlob(outer_.data(), outer_.size() * sizeof(Index));
+    if (delta) {
+        s.readLargeBlob(base_.data(), base_.size() * sizeof(Index));
+        s.readLargeBlob(delta_.data(), delta_.size() * sizeof(Delta));
+    }
+    else {
+        s.readLargeBlob(inner_.data(), inner_.size() * sizeof(Index));
+    }
+    s.readLargeBlob(data_.data(), data_.size() * sizeof(Value));
+}
+
+
+size_t SparseMatrixFloat::footprint() const {
+    return sizeof(*this) + outer_.size() * sizeof(Index) + inner_.size() * sizeof(Index) +
+           base_.size() * sizeof(Index) + delta_.size() * sizeof(Delta) + data_.size() * sizeof(Value);
+}
+
+
+void SparseMatrixFloat::print(std::ostream& os) const {
+    os << "SparseMatrixFloat[rows=" << rows_ << ",cols=" << cols_ << ",nnz=" << nonZeros()
+       << ",deltaIndices=" << deltaIndices() << ",footprint=" << Bytes(footprint()) << "]";
+}
+
+
+Stream& operator<<(Stream& s, const SparseMatrixFloat& v) {
+    v.encode(s);
+    return s;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::linalg
@@ -0,0 +1,130 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include "eckit/linalg/types.h"
+
+
+namespace eckit {
+class Stream;
+class PathName;
+}  // namespace eckit
+
+namespace eckit::linalg {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Sparse matrix in CRS (compressed row storage) format, with single precision entries and optionally 16-bit
+/// delta-encoded column indices (products accumulate in double precision)
+///
+/// Compared to SparseMatrix (12 bytes per non-zero) entries take 8 bytes, or 6 bytes with delta-encoded column indices
+/// (plus 4 bytes per row); delta encoding falls back to full indices if a row has columns too far apart.
+class SparseMatrixFloat {
+public:  // types
+    using Value = float;
+    using Delta = std::int16_t;
+
+public:  // methods
+    // -- Constructors
+
+    /// Default constructor, empty matrix
+    SparseMatrixFloat();
+
+    /// Construct from a (double precision) sparse matrix, with optional delta-encoding of the column indices
+    explicit SparseMatrixFloat(const SparseMatrix&, bool deltaIndices = false);
+
+    /// Constructor from Stream
+    explicit SparseMatrixFloat(Stream&);
+
+    // -- Methods
+
+    /// Compute y = A x
+    /// @note y must be allocated and sized correctly
+    void spmv(const Vector& x, Vector& y) const;
+
+    /// Compute Y = A X
+    /// @note Y must be allocated and sized correctly
+    void spmm(const Matrix& X, Matrix& Y) const;
+
+    /// Compute Y = A X, for row-major (interleaved) fields
+    /// @note Y must be allocated and sized correctly
+    void spmm(const TensorDouble& X, TensorDouble& Y) const;
+
+    /// Compute Y = A X, for row-major (interleaved) single precision fields
+    /// @note Y must be allocated and sized correctly
+    void spmm(const TensorFloat& X, TensorFloat& Y) const;
+
+    /// @returns a (double precision) sparse matrix with the same entries
+    SparseMatrix toSparseMatrix() const;
+
+    // -- I/O
+
+    void save(const PathName&) const;
+    void load(const PathName&);
+
+    /// Serialise to a Stream
+    void encode(Stream&) const;
+
+    /// @returns number of rows
+    Size rows() const { return rows_; }
+
+    /// @returns number of columns
+    Size cols() const { return cols_; }
+
+    /// @returns number of non-zeros
+    Size nonZeros() const { return data_.size(); }
+
+    /// @returns true if this matrix does not contain non-zero entries
+    bool empty() const { return data_.empty(); }
+
+    /// @returns if column indices are delta-encoded
+    bool deltaIndices() const { return !base_.empty(); }
+
+    /// Returns the footprint of the matrix in memory
+    size_t footprint() const;
+
+    void print(std::ostream&) const;
+
+    friend std::ostream& operator<<(std::ostream& os, const SparseMatrixFloat& m) {
+        m.print(os);
+        return os;
+    }
+
+private:  // methods
+    /// Deserialise from a Stream
+    void decode(Stream&);
+
+    template <typename F>
+    void forEachNonZero(Size row, F&&) const;
+
+private:  // members
+    Size rows_;
+    Size cols_;
+
+    std::vector<Index> outer_;  ///< start of rows, sized number of rows + 1
+    std::vector<Index> inner_;  ///< column indices, sized number of non-zeros (if not delta-encoded)
+    std::vector<Index> base_;   ///< first column of each row, sized number of rows (if delta-encoded)
+    std::vector<Delta> delta_;  ///< column index increments within rows, sized number of non-zeros (if delta-encoded)
+    std::vector<Value> data_;   ///< matrix entries, sized number of non-zeros
+};
+
+
+Stream& operator<<(Stream&, const SparseMatrixFloat&);
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::linalg
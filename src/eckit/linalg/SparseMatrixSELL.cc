@@ -0,0 +1,243 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#include "eckit/linalg/SparseMatrixSELL.h"
+
+#include <algorithm>
+#include <numeric>
+#include <ostream>
+#include <string>
+
+#include "eckit/eckit.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/linalg/Matrix.h"
+#include "eckit/linalg/SparseMatrix.h"
+#include "eckit/linalg/Vector.h"
+
+namespace eckit::linalg {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+/// Y(:, k) = A X(:, k) for k < Nk, processing the C rows of each slice in SIMD lanes
+template <Size C>
+void multiply(Size rows, const Index* perm, const std::vector<Size>& sliceStart, const Index* inner,
+              const Scalar* values, const Scalar* X, Size ldx, Scalar* Y, Size ldy, Size Nk) {
+    const auto Ns = sliceStart.size() - 1;
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+    for (Size s = 0; s < Ns; ++s) {
+        const auto start      = sliceStart[s];
+        const auto width      = (sliceStart[s + 1] - start) / C;
+        const auto* const ind = inner + start;
+        const auto* const val = values + start;
+        const auto* const row = perm + s * C;
+        const auto Nl         = std::min(C, rows - s * C);
+
+        for (Size k = 0; k < Nk; ++k) {
+            const auto* const x = X + k * ldx;
+            auto* const y       = Y + k * ldy;
+
+            Scalar acc[C] = {};
+            for (Size w = 0; w < width; ++w) {
+                for (Size l = 0; l < C; ++l) {
+                    acc[l] += val[w * C + l] * x[static_cast<Size>(ind[w * C + l])];
+                }
+            }
+
+            for (Size l = 0; l < Nl; ++l) {
+                y[static_cast<Size>(row[l])] = acc[l];
+            }
+        }
+    }
+}
+
+
+bool supported(Size C) {
+    return C == 1 || C == 2 || C == 4 || C == 8 || C == 16 || C == 32;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SparseMatrixSELL::SparseMatrixSELL(const SparseMatrix& A, Size C, Size sigma) :
+    rows_(A.rows()), cols_(A.cols()), nnz_(A.nonZeros()), C_(C), sigma_(sigma) {
+    if (!supported(C_)) {
+        throw BadParameter("SparseMatrixSELL: slice height should be a power of 2 up to 32, got " + std::to_string(C_),
+                           Here());
+    }
+    if (sigma_ == 0 || (sigma_ > 1 && sigma_ % C_ != 0)) {
+        throw BadParameter("SparseMatrixSELL: sorting window should be 1 or a multiple of the slice height, got " +
+                               std::to_string(sigma_),
+                           Here());
+    }
+
+    const auto Ns = (rows_ + C_ - 1) / C_;
+    sliceStart_.assign(Ns + 1, 0);
+
+    perm_.resize(rows_);
+    std::iota(perm_.begin(), perm_.end(), 0);
+
+    if (rows_ == 0) {
+        return;
+    }
+
+    const auto* const outer = A.outer();
+    const auto* const inner = A.inner();
+    const auto* const data  = A.data();
+
+    ASSERT(outer[0] == 0);  // expect indices to be 0-based
+
+    auto length = [outer](Index r) { return static_cast<Size>(outer[r + 1] - outer[r]); };
+
+    // Sort rows by decreasing length within windows, so rows of similar length share a slice (little padding)
+    if (sigma_ > 1) {
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
+        for (Size w = 0; w < rows_; w += sigma_) {
+            std::stable_sort(perm_.begin() + w, perm_.begin() + std::min(w + sigma_, rows_),
+                             [&length](Index a, Index b) { return length(a) > length(b); });
+        }
+    }
+
+    // Slice widths (longest row in slice), then offsets
+    for (Size s = 0; s < Ns; ++s) {
+        Size width = 0;
+        for (Size r = s * C_; r < std::min((s + 1) * C_, rows_); ++r) {
+            width = std::max(width, length(perm_[r]));
+        }
+        sliceStart_[s + 1] = width * C_;
+    }
+    std::partial_sum(sliceStart_.begin(), sliceStart_.end(), sliceStart_.begin());
+
+    inner_.resize(sliceStart_.back());
+    values_.resize(sliceStart_.back());
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
+    for (Size s = 0; s < Ns; ++s) {
+        const auto start = sliceStart_[s];
+        const auto width = (sliceStart_[s + 1] - start) / C_;
+
+        // a column accessed by the slice, to pad empty rows (if the slice is not empty, so cols > 0)
+        Index column = 0;
+        for (Size r = s * C_; r < std::min((s + 1) * C_, rows_); ++r) {
+            if (length(perm_[r]) > 0) {
+                column = inner[outer[perm_[r]]];
+                break;
+            }
+        }
+
+        for (Size l = 0; l < C_; ++l) {
+            const auto r = s * C_ + l;
+            Size len     = 0;
+            Index last   = column;
+
+            if (r < rows_) {
+                const auto begin = static_cast<Size>(outer[perm_[r]]);
+                len              = length(perm_[r]);
+                for (Size w = 0; w < len; ++w) {
+                    inner_[start + w * C_ + l]  = inner[begin + w];
+                    values_[start + w * C_ + l] = data[begin + w];
+                }
+                if (len > 0) {
+                    last = inner[begin + len - 1];
+                }
+            }
+
+            // padding: zero entries on a column already accessed by the row, or by the slice
+            for (Size w = len; w < width; ++w) {
+                inner_[start + w * C_ + l]  = last;
+                values_[start + w * C_ + l] = 0.;
+            }
+        }
+    }
+}
+
+
+void SparseMatrixSELL::spmv(const Vector& x, Vector& y) const {
+    ASSERT(y.rows() == rows_);
+    ASSERT(x.rows() == cols_);
+
+    const auto* const perm  = perm_.data();
+    const auto* const inner = inner_.data();
+    const auto* const val   = values_.data();
+
+    switch (C_) {
+        case 1:
+            return multiply<1>(rows_, perm, sliceStart_, inner, val, x.data(), cols_, y.data(), rows_, 1);
+        case 2:
+            return multiply<2>(rows_, perm, sliceStart_, inner, val, x.data(), cols_, y.data(), rows_, 1);
+        case 4:
+            return multiply<4>(rows_, perm, sliceStart_, inner, val, x.data(), cols_, y.data(), rows_, 1);
+        case 8:
+            return multiply<8>(rows_, perm, sliceStart_, inner, val, x.data(), cols_, y.data(), rows_, 1);
+        case 16:
+            return multiply<16>(rows_, perm, sliceStart_, inner, val, x.data(), cols_, y.data(), rows_, 1);
+        case 32:
+            return multiply<32>(rows_, perm, sliceStart_, inner, val, x.data(), cols_, y.data(), rows_, 1);
+        default:
+            NOTIMP;
+    }
+}
+
+
+void SparseMatrixSELL::spmm(const Matrix& X, Matrix& Y) const {
+    const auto Nk = X.cols();
+
+    ASSERT(Y.rows() == rows_);
+    ASSERT(X.rows() == cols_);
+    ASSERT(Y.cols() == Nk);
+
+    const auto* const perm  = perm_.data();
+    const auto* const inner = inner_.data();
+    const auto* const val   = values_.data();
+
+    switch (C_) {
+        case 1:
+            return multiply<1>(rows_, perm, sliceStart_, inner, val, X.data(), cols_, Y.data(), rows_, Nk);
+        case 2:
+            return multiply<2>(rows_, perm, sliceStart_, inner, val, X.data(), cols_, Y.data(), rows_, Nk);
+        case 4:
+            return multiply<4>(rows_, perm, sliceStart_, inner, val, X.data(), cols_, Y.data(), rows_, Nk);
+        case 8:
+            return multiply<8>(rows_, perm, sliceStart_, inner, val, X.data(), cols_, Y.data(), rows_, Nk);
+        case 16:
+            return multiply<16>(rows_, perm, sliceStart_, inner, val, X.data(), cols_, Y.data(), rows_, Nk);
+        case 32:
+            return multiply<32>(rows_, perm, sliceStart_, inner, val, X.data(), cols_, Y.data(), rows_, Nk);
+        default:
+            NOTIMP;
+    }
+}
+
+
+size_t SparseMatrixSELL::footprint() const {
+    return sizeof(*this) + perm_.size() * sizeof(Index) + sliceStart_.size() * sizeof(Size) +
+           inner_.size() * sizeof(Index) + values_.size() * sizeof(Scalar);
+}
+
+
+void SparseMatrixSELL::print(std::ostream& os) const {
+    os << "SparseMatrixSELL[rows=" << rows_ << ",cols=" << cols_ << ",nnz=" << nnz_ << ",C=" << C_
+       << ",sigma=" << sigma_ << ",stored=" << storedSize() << "]";
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::linalg
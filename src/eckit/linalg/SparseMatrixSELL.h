@@ -0,0 +1,91 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#pragma once
+
+#include <iosfwd>
+#include <vector>
+
+#include "eckit/linalg/types.h"
+
+
+namespace eckit::linalg {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Sparse matrix in SELL-C-sigma (sliced ELLPACK) format, read-only companion to SparseMatrix (CSR)
+///
+/// Rows are sorted by decreasing length within windows of sigma rows, then grouped in slices of C rows; each slice is
+/// padded to its longest row and stored column-major, so that C consecutive rows are processed in SIMD lanes.
+/// Conversion has a cost proportional to the number of non-zeros, it pays off when the same matrix is applied many
+/// times (or to many vectors at once).
+class SparseMatrixSELL {
+public:  // methods
+    // -- Constructors
+
+    /// Construct from a CSR matrix, with slice height C and sorting window sigma (a multiple of C, or 1 for no sorting)
+    explicit SparseMatrixSELL(const SparseMatrix&, Size C = 8, Size sigma = 256);
+
+    // -- Methods
+
+    /// Compute y = A x
+    /// @note y must be allocated and sized correctly
+    void spmv(const Vector& x, Vector& y) const;
+
+    /// Compute Y = A X
+    /// @note Y must be allocated and sized correctly
+    void spmm(const Matrix& X, Matrix& Y) const;
+
+    /// @returns number of rows
+    Size rows() const { return rows_; }
+
+    /// @returns number of columns
+    Size cols() const { return cols_; }
+
+    /// @returns number of (original) non-zeros
+    Size nonZeros() const { return nnz_; }
+
+    /// @returns number of stored entries, including padding
+    Size storedSize() const { return values_.size(); }
+
+    /// @returns slice height
+    Size sliceHeight() const { return C_; }
+
+    /// @returns sorting window
+    Size sortingWindow() const { return sigma_; }
+
+    /// Returns the footprint of the matrix in memory
+    size_t footprint() const;
+
+    void print(std::ostream&) const;
+
+    friend std::ostream& operator<<(std::ostream& os, const SparseMatrixSELL& m) {
+        m.print(os);
+        return os;
+    }
+
+private:  // members
+    Size rows_;
+    Size cols_;
+    Size nnz_;
+    Size C_;
+    Size sigma_;
+
+    std::vector<Index> perm_;       ///< original row of each sorted row, sized number of rows
+    std::vector<Size> sliceStart_;  ///< start of slices, sized number of slices + 1
+    std::vector<Index> inner_;      ///< column indices, slice column-major (padding repeats a valid column)
+    std::vector<Scalar> values_;    ///< matrix entries, slice column-major (padding is zero)
+};
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::linalg
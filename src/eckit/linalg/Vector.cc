@@ -41,6 +41,15 @@ Vector::Vector(Stream& stream) :
     resize(length);
 
     ASSERT(length_ > 0);
+
+    Size count;
+    if (stream.startArray<Scalar>(count)) {
+        ASSERT(count == length);
+        stream.readArray(array_, length);
+        return;
+    }
+
+    // Encoded by a previous version
     stream.readBlob(array_, length * sizeof(Scalar));
 }
 
@@ -92,6 +101,10 @@ void Vector::fill(Scalar value) {
 
 void Vector::encode(Stream& stream) const {
     stream << length_;
+    if (Stream::writeArrays()) {
+        stream.writeArray(array_, length_);
+        return;
+    }
     stream.writeBlob(array_, length_ * sizeof(Scalar));
 }
 
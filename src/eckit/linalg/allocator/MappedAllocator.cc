@@ -0,0 +1,287 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#include "eckit/linalg/allocator/MappedAllocator.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "eckit/config/LibEcKit.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/log/Bytes.h"
+#include "eckit/memory/MMap.h"
+#include "eckit/os/Stat.h"
+#include "eckit/utils/Hash.h"
+
+
+namespace eckit::linalg::allocator {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+constexpr char MAGIC[8]           = {'E', 'C', 'S', 'P', 'M', 'A', 'T', 'X'};
+constexpr std::uint32_t VERSION   = 1;
+constexpr std::uint32_t BYTEORDER = 0x01020304;
+
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint32_t sizeofIndex;
+    std::uint32_t sizeofScalar;
+
+    std::uint64_t rows;
+    std::uint64_t cols;
+    std::uint64_t nnz;
+
+    std::uint64_t alignment;  ///< sections alignment (page size when saved)
+    std::uint64_t outer;      ///< offset of outer indices
+    std::uint64_t inner;      ///< offset of inner indices
+    std::uint64_t data;       ///< offset of entries
+    std::uint64_t length;     ///< file length
+
+    char hash[16];    ///< checksum method
+    char digest[64];  ///< checksum of the outer, inner and data sections
+};
+
+
+std::string checksumMethod() {
+    return HashFactory::instance().has("xxh64") ? "xxh64" : "md5";
+}
+
+
+std::string checksum(const std::string& method, const SparseMatrix::Layout& layout, const SparseMatrix::Shape& shape) {
+    std::unique_ptr<Hash> hash(HashFactory::instance().build(method));
+    hash->add(layout.outer_, static_cast<long>(shape.sizeofOuter()));
+    hash->add(layout.inner_, static_cast<long>(shape.sizeofInner()));
+    hash->add(layout.data_, static_cast<long>(shape.sizeofData()));
+    return hash->digest();
+}
+
+
+std::uint64_t align(std::uint64_t offset, std::uint64_t alignment) {
+    return ((offset + alignment - 1) / alignment) * alignment;
+}
+
+
+/// @returns empty string if header is valid, otherwise the reason it isn't
+std::string check(const Header& h, size_t fileSize) {
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        return "not a mappable sparse matrix";
+    }
+    if (h.version != VERSION) {
+        return "unsupported version " + std::to_string(h.version);
+    }
+    if (h.byteOrder != BYTEORDER) {
+        return "different byte order";
+    }
+    if (h.sizeofIndex != sizeof(Index) || h.sizeofScalar != sizeof(Scalar)) {
+        return "different index/scalar sizes";
+    }
+    if (h.length != fileSize) {
+        return "truncated file (expected " + std::to_string(h.length) + " bytes, got " + std::to_string(fileSize) + ")";
+    }
+    if (h.outer % alignof(Index) != 0 || h.inner % alignof(Index) != 0 || h.data % alignof(Scalar) != 0) {
+        return "misaligned sections";
+    }
+    if (h.outer + (h.rows + 1) * sizeof(Index) > h.length || h.inner + h.nnz * sizeof(Index) > h.length ||
+        h.data + h.nnz * sizeof(Scalar) > h.length) {
+        return "sections out of bounds";
+    }
+    return {};
+}
+
+
+bool readHeader(const PathName& path, Header& h, size_t& fileSize) {
+    Stat::Struct s;
+    if (Stat::stat(path.localPath(), &s) != 0 || s.st_size < static_cast<off_t>(sizeof(Header))) {
+        return false;
+    }
+    fileSize = static_cast<size_t>(s.st_size);
+
+    std::unique_ptr<DataHandle> handle(path.fileHandle());
+    handle->openForRead();
+    AutoClose closer(*handle);
+    return handle->read(&h, sizeof(Header)) == static_cast<long>(sizeof(Header));
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MappedAllocator::MappedAllocator(const PathName& path, bool verifyChecksum) :
+    path_(path), addr_(nullptr), size_(0) {
+    Header h;
+    if (!readHeader(path_, h, size_)) {
+        throw BadValue("MappedAllocator: cannot read header of " + path_.asString(), Here());
+    }
+
+    if (auto reason = check(h, size_); !reason.empty()) {
+        throw BadValue("MappedAllocator: " + path_.asString() + ": " + reason, Here());
+    }
+
+    int fd = ::open(path_.localPath(), O_RDONLY);
+    if (fd < 0) {
+        Log::error() << "open(" << path_ << ')' << Log::syserr << std::endl;
+        throw FailedSystemCall("open", Here());
+    }
+
+    // shared read-only mapping, pages come from (and stay in) the page cache
+    addr_ = MMap::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (addr_ == MAP_FAILED) {
+        addr_ = nullptr;
+        Log::error() << "MappedAllocator path=" << path_ << " size=" << size_
+                     << " fails to mmap(0,size,PROT_READ,MAP_SHARED,fd,0)" << Log::syserr << std::endl;
+        throw FailedSystemCall("mmap", Here());
+    }
+
+    if (verifyChecksum) {
+        SparseMatrix::Shape shape;
+        auto layout = allocate(shape);
+
+        std::string method(h.hash, ::strnlen(h.hash, sizeof(h.hash)));
+        std::string digest(h.digest, ::strnlen(h.digest, sizeof(h.digest)));
+
+        if (checksum(method, layout, shape) != digest) {
+            MMap::munmap(addr_, size_);
+            throw BadValue("MappedAllocator: " + path_.asString() + ": checksum mismatch", Here());
+        }
+    }
+}
+
+
+MappedAllocator::~MappedAllocator() {
+    if (addr_ != nullptr) {
+        MMap::munmap(addr_, size_);
+    }
+}
+
+
+SparseMatrix::Layout MappedAllocator::allocate(SparseMatrix::Shape& shape) {
+    ASSERT(addr_ != nullptr);
+
+    const auto& h = *reinterpret_cast<const Header*>(addr_);
+    auto* addr    = static_cast<char*>(addr_);
+
+    shape.size_ = h.nnz;
+    shape.rows_ = h.rows;
+    shape.cols_ = h.cols;
+
+    Log::debug<LibEcKit>() << "Mapping matrix from " << path_ << ": "
+                           << " rows " << shape.rows_ << " cols " << shape.cols_ << " nnzs " << shape.size_
+                           << " allocSize " << shape.allocSize() << std::endl;
+
+    SparseMatrix::Layout layout;
+    layout.outer_ = reinterpret_cast<Index*>(addr + h.outer);
+    layout.inner_ = reinterpret_cast<Index*>(addr + h.inner);
+    layout.data_  = reinterpret_cast<Scalar*>(addr + h.data);
+
+    return layout;
+}
+
+
+void MappedAllocator::deallocate(SparseMatrix::Layout, SparseMatrix::Shape) {}
+
+
+void MappedAllocator::print(std::ostream& out) const {
+    out << "MappedAllocator[path=" << path_ << ",size=" << Bytes(size_) << "]";
+}
+
+
+void MappedAllocator::save(const SparseMatrix& A, const PathName& path) {
+    ASSERT(!A.empty());
+
+    const auto alignment = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+
+    SparseMatrix::Shape shape;
+    shape.rows_ = A.rows();
+    shape.cols_ = A.cols();
+    shape.size_ = A.nonZeros();
+
+    SparseMatrix::Layout layout;
+    layout.outer_ = const_cast<Index*>(A.outer());
+    layout.inner_ = const_cast<Index*>(A.inner());
+    layout.data_  = const_cast<Scalar*>(A.data());
+
+    Header h;
+    std::memset(&h, 0, sizeof(Header));
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+
+    h.version      = VERSION;
+    h.byteOrder    = BYTEORDER;
+    h.sizeofIndex  = sizeof(Index);
+    h.sizeofScalar = sizeof(Scalar);
+    h.rows         = shape.rows_;
+    h.cols         = shape.cols_;
+    h.nnz          = shape.size_;
+    h.alignment    = alignment;
+    h.outer        = align(sizeof(Header), alignment);
+    h.inner        = align(h.outer + shape.sizeofOuter(), alignment);
+    h.data         = align(h.inner + shape.sizeofInner(), alignment);
+    h.length       = h.data + shape.sizeofData();
+
+    const auto method = checksumMethod();
+    const auto digest = checksum(method, layout, shape);
+    ASSERT(method.size() < sizeof(h.hash) && digest.size() < sizeof(h.digest));
+    std::memcpy(h.hash, method.data(), method.size());
+    std::memcpy(h.digest, digest.data(), digest.size());
+
+    Log::debug<LibEcKit>() << "Saving mappable matrix to " << path << ": "
+                           << " rows " << h.rows << " cols " << h.cols << " nnzs " << h.nnz << " length "
+                           << Bytes(h.length) << std::endl;
+
+    std::unique_ptr<DataHandle> handle(path.fileHandle(true));
+    handle->openForWrite(static_cast<long long>(h.length));
+    AutoClose closer(*handle);
+
+    const std::vector<char> padding(alignment, 0);
+    std::uint64_t position = 0;
+
+    auto write = [&](std::uint64_t offset, const void* buffer, size_t size) {
+        ASSERT(position <= offset);
+        if (position < offset) {
+            const auto gap = static_cast<long>(offset - position);
+            ASSERT(handle->write(padding.data(), gap) == gap);
+        }
+        ASSERT(handle->write(buffer, static_cast<long>(size)) == static_cast<long>(size));
+        position = offset + size;
+    };
+
+    write(0, &h, sizeof(Header));
+    write(h.outer, layout.outer_, shape.sizeofOuter());
+    write(h.inner, layout.inner_, shape.sizeofInner());
+    write(h.data, layout.data_, shape.sizeofData());
+    ASSERT(position == h.length);
+}
+
+
+bool MappedAllocator::isMappable(const PathName& path) {
+    Header h;
+    size_t fileSize = 0;
+    return readHeader(path, h, fileSize) && check(h, fileSize).empty();
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::linalg::allocator
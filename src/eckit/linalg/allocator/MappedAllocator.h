@@ -0,0 +1,60 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#pragma once
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/linalg/SparseMatrix.h"
+
+
+namespace eckit::linalg::allocator {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Read-only, zero-copy SparseMatrix memory mapped from a file written by MappedAllocator::save
+///
+/// The file has a versioned header (with a checksum of the matrix arrays) followed by the outer, inner and data arrays,
+/// each starting on a page boundary. The file is mapped shared and read-only, so all processes on a node opening the
+/// same matrix share its page cache copy, and opening costs a few system calls irrespective of the matrix size.
+///
+/// @note the matrix must not be modified (reserve, prune, transpose, etc.), its memory is read-only
+class MappedAllocator : public SparseMatrix::Allocator {
+public:  // methods
+    /// Map a file, optionally verifying the checksum (which reads the whole file)
+    explicit MappedAllocator(const PathName&, bool verifyChecksum = false);
+
+    ~MappedAllocator() override;
+
+    SparseMatrix::Layout allocate(SparseMatrix::Shape&) override;
+
+    void deallocate(SparseMatrix::Layout, SparseMatrix::Shape) override;
+
+    bool inSharedMemory() const override { return true; }
+
+    void print(std::ostream&) const override;
+
+    /// Write a matrix in the mappable format
+    static void save(const SparseMatrix&, const PathName&);
+
+    /// @returns if file is in the mappable format (checking only its header)
+    static bool isMappable(const PathName&);
+
+private:  // members
+    PathName path_;
+
+    void* addr_;
+    size_t size_;
+};
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::linalg::allocator
@@ -0,0 +1,308 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#include "eckit/linalg/dense/LinearAlgebraBlocked.h"
+
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+#include "eckit/eckit_config.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/linalg/Matrix.h"
+#include "eckit/linalg/Vector.h"
+
+// Runtime selection of the micro-kernel instruction set (x86 only, where the compiler supports function
+// multi-versioning through the target attribute); other architectures (e.g. aarch64 NEON) rely on the baseline ISA
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(__NVCOMPILER) && !defined(__PGI) && !defined(__INTEL_COMPILER)
+#define ECKIT_LINALG_BLOCKED_DISPATCH 1
+#define ECKIT_LINALG_BLOCKED_INLINE inline __attribute__((always_inline))
+#else
+#define ECKIT_LINALG_BLOCKED_DISPATCH 0
+#define ECKIT_LINALG_BLOCKED_INLINE inline
+#endif
+
+namespace eckit::linalg::dense {
+
+static const LinearAlgebraBlocked __la_blocked("blocked");
+
+
+namespace {
+
+// Register tile (MR x NR of C kept in registers), and cache blocks (MC x KC panel of A, KC x NC panel of B)
+constexpr Size MR = 8;
+constexpr Size NR = 6;
+constexpr Size MC = 128;
+constexpr Size KC = 256;
+constexpr Size NC = 3072;
+
+// gemv rows per block (a block of y stays in L1 while the columns of A are streamed)
+constexpr Size GEMV_ROWS = 512;
+
+static_assert(MC % MR == 0 && NC % NR == 0, "cache blocks should be a multiple of the register tile");
+
+
+using kernel_t = void (*)(Size kc, const Scalar* a, const Scalar* b, Scalar* c, Size ldc, Size mr, Size nr);
+
+
+/// C(mr, nr) += A(mr, kc) * B(kc, nr), with A packed in MR-row slivers and B in NR-column slivers
+ECKIT_LINALG_BLOCKED_INLINE void kernel_impl(Size kc, const Scalar* __restrict a, const Scalar* __restrict b,
+                                             Scalar* __restrict c, Size ldc, Size mr, Size nr) {
+    Scalar acc[NR][MR] = {};
+
+    for (Size p = 0; p < kc; ++p, a += MR, b += NR) {
+        for (Size j = 0; j < NR; ++j) {
+            const auto bj = b[j];
+            for (Size i = 0; i < MR; ++i) {
+                acc[j][i] += a[i] * bj;
+            }
+        }
+    }
+
+    if (mr == MR && nr == NR) {
+        for (Size j = 0; j < NR; ++j) {
+            for (Size i = 0; i < MR; ++i) {
+                c[j * ldc + i] += acc[j][i];
+            }
+        }
+        return;
+    }
+
+    for (Size j = 0; j < nr; ++j) {
+        for (Size i = 0; i < mr; ++i) {
+            c[j * ldc + i] += acc[j][i];
+        }
+    }
+}
+
+
+void kernel_generic(Size kc, const Scalar* a, const Scalar* b, Scalar* c, Size ldc, Size mr, Size nr) {
+    kernel_impl(kc, a, b, c, ldc, mr, nr);
+}
+
+
+#if ECKIT_LINALG_BLOCKED_DISPATCH
+__attribute__((target("avx2,fma"))) void kernel_avx2(Size kc, const Scalar* a, const Scalar* b, Scalar* c, Size ldc,
+                                                     Size mr, Size nr) {
+    kernel_impl(kc, a, b, c, ldc, mr, nr);
+}
+
+
+__attribute__((target("avx512f"))) void kernel_avx512(Size kc, const Scalar* a, const Scalar* b, Scalar* c, Size ldc,
+                                                      Size mr, Size nr) {
+    kernel_impl(kc, a, b, c, ldc, mr, nr);
+}
+#endif
+
+
+struct Kernel {
+    Kernel() :
+        call(kernel_generic), name("generic") {
+#if ECKIT_LINALG_BLOCKED_DISPATCH
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            call = kernel_avx512;
+            name = "avx512";
+        }
+        else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            call = kernel_avx2;
+            name = "avx2";
+        }
+#endif
+    }
+
+    kernel_t call;
+    const char* name;
+};
+
+
+const Kernel& kernel() {
+    static const Kernel k;
+    return k;
+}
+
+
+/// Pack A(mc, kc) (column-major, leading dimension lda) into MR-row slivers, zero-padding the last one
+void pack_A(Size mc, Size kc, const Scalar* a, Size lda, Scalar* packed) {
+    for (Size ir = 0; ir < mc; ir += MR) {
+        const auto mr = std::min(MR, mc - ir);
+        for (Size p = 0; p < kc; ++p) {
+            const auto* col = a + p * lda + ir;
+            Size i          = 0;
+            for (; i < mr; ++i) {
+                *packed++ = col[i];
+            }
+            for (; i < MR; ++i) {
+                *packed++ = 0.;
+            }
+        }
+    }
+}
+
+
+/// Pack one NR-column sliver of B(kc, nr) (column-major, leading dimension ldb), zero-padding missing columns
+void pack_B(Size kc, Size nr, const Scalar* b, Size ldb, Scalar* packed) {
+    for (Size p = 0; p < kc; ++p) {
+        Size j = 0;
+        for (; j < nr; ++j) {
+            *packed++ = b[j * ldb + p];
+        }
+        for (; j < NR; ++j) {
+            *packed++ = 0.;
+        }
+    }
+}
+
+
+Size round_up(Size n, Size m) {
+    return ((n + m - 1) / m) * m;
+}
+
+}  // namespace
+
+
+void LinearAlgebraBlocked::print(std::ostream& out) const {
+    out << "LinearAlgebraBlocked[kernel=" << kernel().name << "]";
+}
+
+
+Scalar LinearAlgebraBlocked::dot(const Vector& x, const Vector& y) const {
+    const auto Ni = x.size();
+    ASSERT(y.size() == Ni);
+
+    Scalar sum = 0.;
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for reduction(+ : sum)
+#endif
+    for (Size i = 0; i < Ni; ++i) {
+        const auto p = x[i] * y[i];
+        sum += p;
+    }
+
+    return sum;
+}
+
+
+void LinearAlgebraBlocked::gemv(const Matrix& A, const Vector& x, Vector& y) const {
+    const auto Ni = A.rows();
+    const auto Nj = A.cols();
+
+    ASSERT(y.rows() == Ni);
+    ASSERT(x.rows() == Nj);
+
+    // A is column-major: stream its columns over blocks of y, four columns at a time
+    const auto* const a  = A.data();
+    const auto* const xp = x.data();
+    auto* const yp       = y.data();
+
+#if eckit_HAVE_OMP
+#pragma omp parallel for
+#endif
+    for (Size i0 = 0; i0 < Ni; i0 += GEMV_ROWS) {
+        const auto ni  = std::min(GEMV_ROWS, Ni - i0);
+        auto* const yi = yp + i0;
+
+        for (Size i = 0; i < ni; ++i) {
+            yi[i] = 0.;
+        }
+
+        Size j = 0;
+        for (; j + 4 <= Nj; j += 4) {
+            const auto* const a0 = a + (j + 0) * Ni + i0;
+            const auto* const a1 = a + (j + 1) * Ni + i0;
+            const auto* const a2 = a + (j + 2) * Ni + i0;
+            const auto* const a3 = a + (j + 3) * Ni + i0;
+            const auto x0        = xp[j + 0];
+            const auto x1        = xp[j + 1];
+            const auto x2        = xp[j + 2];
+            const auto x3        = xp[j + 3];
+            for (Size i = 0; i < ni; ++i) {
+                yi[i] += a0[i] * x0 + a1[i] * x1 + a2[i] * x2 + a3[i] * x3;
+            }
+        }
+
+        for (; j < Nj; ++j) {
+            const auto* const aj = a + j * Ni + i0;
+            const auto xj        = xp[j];
+            for (Size i = 0; i < ni; ++i) {
+                yi[i] += aj[i] * xj;
+            }
+        }
+    }
+}
+
+
+void LinearAlgebraBlocked::gemm(const Matrix& A, const Matrix& B, Matrix& C) const {
+    const auto Ni = A.rows();
+    const auto Nj = B.cols();
+    const auto Nk = A.cols();
+
+    ASSERT(C.rows() == Ni);
+    ASSERT(C.cols() == Nj);
+    ASSERT(B.rows() == Nk);
+
+    C.setZero();
+    if (Ni == 0 || Nj == 0 || Nk == 0) {
+        return;
+    }
+
+    const auto call  = kernel().call;
+    const auto* a    = A.data();
+    const auto* b    = B.data();
+    auto* c          = C.data();
+    const auto ncMax = std::min(NC, round_up(Nj, NR));
+    const auto kcMax = std::min(KC, Nk);
+
+    // B panel is shared (packed cooperatively), A blocks are packed per thread
+    std::vector<Scalar> Bp(kcMax * ncMax);
+
+#if eckit_HAVE_OMP
+#pragma omp parallel
+#endif
+    {
+        std::vector<Scalar> Ap(std::min(MC, round_up(Ni, MR)) * kcMax);
+
+        for (Size jc = 0; jc < Nj; jc += NC) {
+            const auto nc = std::min(NC, Nj - jc);
+
+            for (Size pc = 0; pc < Nk; pc += KC) {
+                const auto kc = std::min(KC, Nk - pc);
+
+#if eckit_HAVE_OMP
+#pragma omp for
+#endif
+                for (Size jr = 0; jr < nc; jr += NR) {
+                    pack_B(kc, std::min(NR, nc - jr), b + (jc + jr) * Nk + pc, Nk, Bp.data() + jr * kc);
+                }
+
+#if eckit_HAVE_OMP
+#pragma omp for schedule(dynamic)
+#endif
+                for (Size ic = 0; ic < Ni; ic += MC) {
+                    const auto mc = std::min(MC, Ni - ic);
+                    pack_A(mc, kc, a + pc * Ni + ic, Ni, Ap.data());
+
+                    for (Size jr = 0; jr < nc; jr += NR) {
+                        const auto nr = std::min(NR, nc - jr);
+                        for (Size ir = 0; ir < mc; ir += MR) {
+                            call(kc, Ap.data() + ir * kc, Bp.data() + jr * kc, c + (jc + jr) * Ni + ic + ir, Ni,
+                                 std::min(MR, mc - ir), nr);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+}  // namespace eckit::linalg::dense
@@ -0,0 +1,31 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#pragma once
+
+#include "eckit/linalg/LinearAlgebraDense.h"
+
+namespace eckit::linalg::dense {
+
+/// Built-in cache-blocked backend, with packed panels and a register-tiled micro-kernel (selected at runtime for
+/// the instruction set of the host, when the compiler supports it)
+struct LinearAlgebraBlocked final : public LinearAlgebraDense {
+    LinearAlgebraBlocked() {}
+    LinearAlgebraBlocked(const std::string& name) :
+        LinearAlgebraDense(name) {}
+
+    Scalar dot(const Vector&, const Vector&) const override;
+    void gemv(const Matrix&, const Vector&, Vector&) const override;
+    void gemm(const Matrix&, const Matrix&, Matrix&) const override;
+    void print(std::ostream&) const override;
+};
+
+}  // namespace eckit::linalg::dense
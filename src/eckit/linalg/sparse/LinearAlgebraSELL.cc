@@ -0,0 +1,147 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#include "eckit/linalg/sparse/LinearAlgebraSELL.h"
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/linalg/Matrix.h"
+#include "eckit/linalg/SparseMatrix.h"
+#include "eckit/linalg/SparseMatrixSELL.h"
+#include "eckit/linalg/Vector.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/thread/Mutex.h"
+
+namespace eckit::linalg::sparse {
+
+static const LinearAlgebraSELL __la_sell("sell");
+
+
+namespace {
+
+/// Identifies a CSR matrix by its storage, sizes and a hash of all its entries (cheaper than a conversion)
+struct Key {
+    const void* outer;
+    const void* inner;
+    const void* data;
+    Size rows;
+    Size cols;
+    Size nnz;
+    size_t fingerprint;
+
+    explicit Key(const SparseMatrix& A) :
+        outer(A.outer()), inner(A.inner()), data(A.data()), rows(A.rows()), cols(A.cols()), nnz(A.nonZeros()) {
+        auto hash = [](const void* p, size_t len) {
+            return p != nullptr ? std::hash<std::string_view>{}(std::string_view(static_cast<const char*>(p), len))
+                                : 0;
+        };
+        auto combine = [this](size_t h) {
+            fingerprint ^= h + 0x9e3779b97f4a7c15ULL + (fingerprint << 6) + (fingerprint >> 2);
+        };
+
+        fingerprint = hash(A.outer(), (rows + 1) * sizeof(Index));
+        combine(hash(A.inner(), nnz * sizeof(Index)));
+        combine(hash(A.data(), nnz * sizeof(Scalar)));
+    }
+
+    bool operator==(const Key& other) const {
+        return outer == other.outer && inner == other.inner && data == other.data && rows == other.rows &&
+               cols == other.cols && nnz == other.nnz && fingerprint == other.fingerprint;
+    }
+};
+
+
+/// Conversions of the most recently used matrices
+class Cache {
+public:
+    static Cache& instance() {
+        static Cache cache;
+        return cache;
+    }
+
+    std::shared_ptr<const SparseMatrixSELL> find(const SparseMatrix& A) {
+        Key key(A);
+
+        {
+            AutoLock<Mutex> lock(mutex_);
+            for (auto e = entries_.begin(); e != entries_.end(); ++e) {
+                if (e->first == key) {
+                    entries_.splice(entries_.begin(), entries_, e);
+                    return e->second;
+                }
+            }
+        }
+
+        // Converted outside the lock, concurrent conversions of the same matrix are harmless
+        auto sell = std::make_shared<const SparseMatrixSELL>(A);
+        if (capacity_ == 0) {
+            return sell;
+        }
+
+        AutoLock<Mutex> lock(mutex_);
+        entries_.emplace_front(key, sell);
+        while (entries_.size() > capacity_) {
+            entries_.pop_back();
+        }
+        return sell;
+    }
+
+    void clear() {
+        AutoLock<Mutex> lock(mutex_);
+        entries_.clear();
+    }
+
+private:
+    Cache() :
+        capacity_(Resource<size_t>("linearAlgebraSELLCache;$ECKIT_LINEAR_ALGEBRA_SELL_CACHE", 4)) {}
+
+    Mutex mutex_;
+    size_t capacity_;
+    std::list<std::pair<Key, std::shared_ptr<const SparseMatrixSELL>>> entries_;
+};
+
+}  // namespace
+
+
+void LinearAlgebraSELL::print(std::ostream& out) const {
+    out << "LinearAlgebraSELL[]";
+}
+
+
+void LinearAlgebraSELL::spmv(const SparseMatrix& A, const Vector& x, Vector& y) const {
+    Cache::instance().find(A)->spmv(x, y);
+}
+
+
+void LinearAlgebraSELL::spmm(const SparseMatrix& A, const Matrix& B, Matrix& C) const {
+    Cache::instance().find(A)->spmm(B, C);
+}
+
+
+void LinearAlgebraSELL::clearCache() {
+    Cache::instance().clear();
+}
+
+
+void LinearAlgebraSELL::dsptd(const Vector& x, const SparseMatrix& A, const Vector& y, SparseMatrix& B) const {
+    // scaling the stored entries in place, CSR is as good as it gets
+    LinearAlgebraSparse::getBackend("generic").dsptd(x, A, y, B);
+}
+
+}  // namespace eckit::linalg::sparse
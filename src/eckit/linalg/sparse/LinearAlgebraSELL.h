@@ -0,0 +1,38 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+
+#pragma once
+
+#include "eckit/linalg/LinearAlgebraSparse.h"
+
+namespace eckit::linalg::sparse {
+
+/// Backend converting to SparseMatrixSELL, caching the conversions of the most recently used matrices
+/// (linearAlgebraSELLCache, or ECKIT_LINEAR_ALGEBRA_SELL_CACHE, default 4, 0 to disable)
+///
+/// Matrices are recognised by their storage, sizes and a hash of all their entries, so a matrix modified in place is
+/// converted again; to avoid hashing at every call, convert it once and use SparseMatrixSELL directly
+struct LinearAlgebraSELL final : public LinearAlgebraSparse {
+    LinearAlgebraSELL() {}
+    LinearAlgebraSELL(const std::string& name) :
+        LinearAlgebraSparse(name) {}
+
+    void spmv(const SparseMatrix&, const Vector&, Vector&) const override;
+    using LinearAlgebraSparse::spmm;
+    void spmm(const SparseMatrix&, const Matrix&, Matrix&) const override;
+    void dsptd(const Vector&, const SparseMatrix&, const Vector&, SparseMatrix&) const override;
+    void print(std::ostream&) const override;
+
+    /// Forget the cached conversions
+    static void clearCache();
+};
+
+}  // namespace eckit::linalg::sparse
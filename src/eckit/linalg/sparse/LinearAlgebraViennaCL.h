@@ -25,6 +25,7 @@ struct LinearAlgebraViennaCL final : public LinearAlgebraSparse {
         LinearAlgebraSparse(name) {}
 
     void spmv(const SparseMatrix&, const Vector&, Vector&) const override;
+    using LinearAlgebraSparse::spmm;
     void spmm(const SparseMatrix&, const Matrix&, Matrix&) const override;
     void dsptd(const Vector&, const SparseMatrix&, const Vector&, SparseMatrix&) const override;
     void print(std::ostream&) const override;
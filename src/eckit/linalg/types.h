@@ -27,4 +27,10 @@ class Vector;
 class Matrix;
 class SparseMatrix;
 
+template <typename S>
+class Tensor;
+
+using TensorDouble = Tensor<double>;
+using TensorFloat  = Tensor<float>;
+
 }  // namespace eckit::linalg
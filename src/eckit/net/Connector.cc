@@ -9,6 +9,8 @@
  */
 
 
+#include <functional>
+
 #include "eckit/net/Connector.h"
 #include "eckit/config/Resource.h"
 #include "eckit/io/cluster/ClusterNodes.h"
@@ -29,12 +31,26 @@ static void offLine(const std::string& host, int port) {
 }
 
 Connector::Connector(const std::string& host, int port, const std::string& node) :
-    host_(host), node_(node), port_(port), locked_(false), memoize_(false), sent_(false), life_(0), autoclose_(false) {
+    host_(host),
+    node_(node),
+    port_(port),
+    buffer_(TCPStreamBuffer::defaultSize()),
+    locked_(false),
+    memoize_(false),
+    sent_(false),
+    life_(0),
+    autoclose_(false),
+    cache_(MemoizeCache::build(host + ":" + std::to_string(port))),
+    cached_() {
     Log::info() << "Connector::Connector(" << node << "," << host << ":" << port << ")" << std::endl;
 }
 
 Connector::~Connector() {
 
+    if (socket_.isConnected() && !buffer_.flush(socket_)) {
+        Log::error() << "** " << name() << ": cannot send buffered data" << Log::syserr << std::endl;
+    }
+
     socket_.close();
 
     // try {
@@ -259,6 +275,9 @@ void Connector::unlock() {
     ASSERT(locked_);
     locked_ = false;
     if (autoclose_) {
+        if (socket_.isConnected() && !buffer_.flush(socket_)) {
+            Log::error() << "** " << name() << ": cannot send buffered data" << Log::syserr << std::endl;
+        }
         reset();
     }
 }
@@ -266,7 +285,8 @@ void Connector::unlock() {
 void Connector::reset() {
     in_.reset();
     out_.reset();
-    cache_.clear();
+    cached_.reply_.reset();  // the cache may be shared, and its replies are complete
+    buffer_.reset();
 
     try {
         socket_.close();
@@ -283,10 +303,18 @@ std::string Connector::name() const {
     return os.str();
 }
 
+auto Connector::bufferedWrite() {
+    return [this](TCPSocket& s, const void* buf, long len) { return buffer_.write(s, buf, len); };
+}
+
+auto Connector::bufferedRead() {
+    return [this](TCPSocket& s, void* buf, long len) { return buffer_.read(s, buf, len); };
+}
+
 template <class T, class F>
 long Connector::socketIo(F proc, T buf, long len, const char* msg) {
     TCPSocket& s = socket();
-    long l       = (s.*proc)(buf, len);
+    long l       = std::invoke(proc, s, buf, len);
     if (l != len) {
         reset();
         ConnectorCache::instance().reset();
@@ -314,44 +342,37 @@ long Connector::write(const void* buf, long len) {
         return len;
     }
 
-    return socketIo(&TCPSocket::write, buf, len, "written");
+    return socketIo(bufferedWrite(), buf, len, "written");
+}
+
+void Connector::flush() {
+    if (socket_.isConnected()) {
+        socketIo([this](TCPSocket& s, const void*, long) { return buffer_.flush(s) ? 0L : -1L; }, nullptr, 0,
+                 "flushed");
+    }
 }
 
 long Connector::read(void* buf, long len) {
     if (memoize_) {
         if (!sent_) {
-            std::map<BufferCache, BufferCache>::iterator j = cache_.find(out_);
-            bool useCache                                  = false;
-            if (j != cache_.end()) {
-                //               cout << "MEMOIZE IN CACHE " << (*j).first << std::endl;
-                if ((::time(0) - (*j).second.updated()) > long(life_)) {
-                    // cout << "  CACHE IS STALE" << (*j).first << std::endl;
-                }
-                else {
-                    useCache        = true;
-                    cached_.buffer_ = (const char*)(*j).second.buffer();
-                    cached_.size_   = (*j).second.count();
-                    cached_.pos_    = 0;
-                    sent_           = true;
-                }
-            }
+            cached_.reply_ = cache_->find(out_.buffer(), out_.count(), life_);
+            cached_.pos_   = 0;
 
-            if (!useCache) {
-                cached_.buffer_ = 0;
+            if (!cached_.reply_) {
                 try {
-                    ASSERT((size_t)socketIo(&TCPSocket::write, out_.buffer(), out_.count(), "written") == out_.count());
+                    ASSERT((size_t)socketIo(bufferedWrite(), out_.buffer(), out_.count(), "written") == out_.count());
                 }
                 catch (...) {
                     reset();
                     throw;
                 }
-                sent_ = true;
             }
+            sent_ = true;
         }
 
-        if (cached_.buffer_) {
+        if (cached_.reply_) {
 
-            long left = cached_.size_ - cached_.pos_;
+            long left = cached_.reply_->size() - cached_.pos_;
             long l    = left < len ? left : len;
 
             if (l != len) {
@@ -362,7 +383,7 @@ long Connector::read(void* buf, long len) {
                 throw ConnectorException(os.str());
             }
 
-            ::memcpy(buf, cached_.buffer_ + cached_.pos_, len);
+            ::memcpy(buf, cached_.reply_->data() + cached_.pos_, len);
             cached_.pos_ += len;
 
             return len;
@@ -370,7 +391,7 @@ long Connector::read(void* buf, long len) {
     }
 
     try {
-        len = socketIo(&TCPSocket::read, buf, len, "read");
+        len = socketIo(bufferedRead(), buf, len, "read");
     }
     catch (...) {
         reset();
@@ -395,25 +416,13 @@ void Connector::memoize(bool on, unsigned long life) {
         ASSERT(out_.count() == 0);
         sent_ = false;
 
-        cached_.buffer_ = 0;
-
-        if (cache_.size() > 10000) {
-            // Log::info() << "Clear memoize cache" << std::endl;
-            cache_.clear();
-        }
+        cached_.reply_.reset();
     }
     else {
-        // cout << "Connector::memoize " << in_.count() << " " << out_.count() << std::endl;
-        // cout << "-> " << out_ << std::endl;
-        if (cached_.buffer_) {
-            // cout << "   CACHED" << std::endl;
-            // cout << " .... " << cache_[out_] << std::endl;
-        }
-        else {
-            // cout << "<- " << in_ << std::endl;
-
-            cache_[out_] = in_;
+        if (!cached_.reply_ && out_.count()) {
+            cache_->insert(out_.buffer(), out_.count(), in_.buffer(), in_.count(), life_);
         }
+        cached_.reply_.reset();
         in_.reset();
         out_.reset();
     }
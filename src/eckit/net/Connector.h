@@ -18,7 +18,9 @@
 #include "eckit/io/BufferCache.h"
 #include "eckit/io/Length.h"
 #include "eckit/io/cluster/NodeInfo.h"
+#include "eckit/net/MemoizeCache.h"
 #include "eckit/net/TCPSocket.h"
+#include "eckit/net/TCPStream.h"
 #include "eckit/serialisation/Stream.h"
 
 namespace eckit::net {
@@ -56,8 +58,17 @@ public:
 
     void autoclose(bool on) { autoclose_ = on; }
 
+    /// Replies to identical requests are reused for `time` seconds, see MemoizeCache
     void memoize(bool on, unsigned long time);
 
+    const MemoizeCache& memoizeCache() const { return *cache_; }
+
+    /// Buffer writes and reads, see TCPStreamBuffer; 0 to disable
+    void buffered(size_t size) { buffer_.resize(size); }
+
+    /// Send the buffered writes
+    void flush();
+
     static Connector& service(const std::string& name, const std::string& node);
     static Connector& service(const std::string& name, const std::map<std::string, Length>& cost,
                               const std::set<std::string>& attributes = {});
@@ -89,6 +100,7 @@ private:
 
     int port_;
     TCPSocket socket_;
+    TCPStreamBuffer buffer_;
     bool locked_;
 
 
@@ -101,12 +113,11 @@ private:
     BufferCache in_;
     bool autoclose_;
 
-    std::map<BufferCache, BufferCache> cache_;
+    std::shared_ptr<MemoizeCache> cache_;
 
     struct {
-        const char* buffer_;
+        MemoizeCache::Reply reply_;
         size_t pos_;
-        size_t size_;
     } cached_;
 
     // -- Methods
@@ -116,6 +127,9 @@ private:
     template <class T, class F>
     long socketIo(F proc, T buf, long len, const char*);
 
+    auto bufferedWrite();
+    auto bufferedRead();
+
     // -- Overridden methods
     // None
 
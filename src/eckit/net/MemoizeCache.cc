@@ -0,0 +1,169 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <map>
+#include <ostream>
+
+#include "eckit/eckit.h"
+
+#if eckit_HAVE_XXHASH
+#define XXH_INLINE_ALL
+#include "eckit/contrib/xxhash/xxhash.h"
+#endif
+
+#include "eckit/config/Resource.h"
+#include "eckit/net/MemoizeCache.h"
+#include "eckit/thread/AutoLock.h"
+
+namespace eckit::net {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+MemoizeCache::MemoizeCache(size_t maxEntries, size_t maxBytes) :
+    maxEntries_(maxEntries), maxBytes_(maxBytes), bytes_(0) {}
+
+uint64_t MemoizeCache::hash(const void* data, size_t length) {
+#if eckit_HAVE_XXHASH
+    return XXH64(data, length, 0);
+#else
+    return std::hash<std::string_view>{}(std::string_view(static_cast<const char*>(data), length));
+#endif
+}
+
+void MemoizeCache::erase(List::iterator e) {
+    bytes_ -= e->bytes();
+    index_.erase(e->request_);  // before the entry, which holds the key
+    entries_.erase(e);
+}
+
+MemoizeCache::Reply MemoizeCache::find(const void* request, size_t length, time_t life) {
+    AutoLock<Mutex> lock(mutex_);
+
+    auto j = index_.find(std::string_view(static_cast<const char*>(request), length));
+    if (j == index_.end()) {
+        statistics_.misses_++;
+        return Reply();
+    }
+
+    List::iterator e = j->second;
+    time_t now       = ::time(nullptr);
+    if (now > e->expires_ || now - e->updated_ > life) {
+        statistics_.expired_++;
+        erase(e);
+        return Reply();
+    }
+
+    statistics_.hits_++;
+    entries_.splice(entries_.begin(), entries_, e);
+    return e->reply_;
+}
+
+void MemoizeCache::insert(const void* request, size_t length, const void* reply, size_t replyLength, time_t life) {
+    if (length + replyLength > maxBytes_ || maxEntries_ == 0) {
+        return;
+    }
+
+    time_t now = ::time(nullptr);
+
+    Entry entry{std::string(static_cast<const char*>(request), length),
+                std::make_shared<const std::string>(static_cast<const char*>(reply), replyLength), now, now + life};
+
+    AutoLock<Mutex> lock(mutex_);
+
+    auto j = index_.find(entry.request_);
+    if (j != index_.end()) {
+        erase(j->second);
+    }
+
+    bytes_ += entry.bytes();
+    entries_.push_front(std::move(entry));
+    index_.emplace(entries_.front().request_, entries_.begin());
+    statistics_.inserted_++;
+
+    trim(now);
+}
+
+void MemoizeCache::trim(time_t now) {
+    if (entries_.size() <= maxEntries_ && bytes_ <= maxBytes_) {
+        return;
+    }
+
+    // Expired entries first
+    for (auto e = entries_.begin(); e != entries_.end();) {
+        auto next = std::next(e);
+        if (now > e->expires_) {
+            erase(e);
+            statistics_.expired_++;
+        }
+        e = next;
+    }
+
+    while (entries_.size() > maxEntries_ || bytes_ > maxBytes_) {
+        erase(std::prev(entries_.end()));
+        statistics_.evicted_++;
+    }
+}
+
+void MemoizeCache::clear() {
+    AutoLock<Mutex> lock(mutex_);
+    index_.clear();
+    entries_.clear();
+    bytes_ = 0;
+}
+
+size_t MemoizeCache::size() const {
+    AutoLock<Mutex> lock(mutex_);
+    return entries_.size();
+}
+
+size_t MemoizeCache::bytes() const {
+    AutoLock<Mutex> lock(mutex_);
+    return bytes_;
+}
+
+MemoizeCache::Statistics MemoizeCache::statistics() const {
+    AutoLock<Mutex> lock(mutex_);
+    return statistics_;
+}
+
+void MemoizeCache::print(std::ostream& s) const {
+    AutoLock<Mutex> lock(mutex_);
+    s << "MemoizeCache[entries=" << entries_.size() << ",bytes=" << bytes_ << ",hits=" << statistics_.hits_
+      << ",misses=" << statistics_.misses_ << ",expired=" << statistics_.expired_
+      << ",evicted=" << statistics_.evicted_ << "]";
+}
+
+std::shared_ptr<MemoizeCache> MemoizeCache::build(const std::string& service) {
+    static size_t maxEntries =
+        Resource<size_t>("connectorMemoizeMaxEntries;$ECKIT_CONNECTOR_MEMOIZE_MAX_ENTRIES", 10000);
+    static size_t maxBytes =
+        Resource<size_t>("connectorMemoizeMaxBytes;$ECKIT_CONNECTOR_MEMOIZE_MAX_BYTES", 64 * 1024 * 1024);
+    static bool shared = Resource<bool>("connectorMemoizeShared;$ECKIT_CONNECTOR_MEMOIZE_SHARED", false);
+
+    if (!shared) {
+        return std::make_shared<MemoizeCache>(maxEntries, maxBytes);
+    }
+
+    static Mutex mutex;
+    static std::map<std::string, std::weak_ptr<MemoizeCache>> caches;
+
+    AutoLock<Mutex> lock(mutex);
+
+    std::shared_ptr<MemoizeCache> cache = caches[service].lock();
+    if (!cache) {
+        cache           = std::make_shared<MemoizeCache>(maxEntries, maxBytes);
+        caches[service] = cache;
+    }
+    return cache;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::net
@@ -0,0 +1,119 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_net_MemoizeCache_h
+#define eckit_net_MemoizeCache_h
+
+#include <cstdint>
+#include <ctime>
+#include <iosfwd>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "eckit/memory/NonCopyable.h"
+#include "eckit/thread/Mutex.h"
+
+namespace eckit::net {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Replies to requests, memoised by Connector
+///
+/// Entries are indexed by their request, hashed with xxHash if available and compared in full on lookup. An entry
+/// expires after the life given when inserted, or the life given when looked up if shorter. The least recently used
+/// entries are evicted beyond `maxEntries` entries or `maxBytes` bytes of requests and replies.
+///
+/// The cache is thread-safe, so that it can be shared by the connectors to the same service.
+class MemoizeCache : private NonCopyable {
+public:  // types
+    using Reply = std::shared_ptr<const std::string>;
+
+    struct Statistics {
+        size_t hits_     = 0;
+        size_t misses_   = 0;
+        size_t expired_  = 0;  ///< found, but too old
+        size_t evicted_  = 0;  ///< least recently used, beyond the limits
+        size_t inserted_ = 0;
+    };
+
+public:  // methods
+    MemoizeCache(size_t maxEntries, size_t maxBytes);
+
+    /// @returns the reply to the request, or null if not cached or older than `life` seconds
+    Reply find(const void* request, size_t length, time_t life);
+
+    /// Replaces the reply to the request, if any
+    void insert(const void* request, size_t length, const void* reply, size_t replyLength, time_t life);
+
+    void clear();
+
+    size_t size() const;
+    size_t bytes() const;
+
+    Statistics statistics() const;
+
+    /// A cache for the connectors to `service`, shared if configured by connectorMemoizeShared or
+    /// ECKIT_CONNECTOR_MEMOIZE_SHARED, and limited by connectorMemoizeMaxEntries and connectorMemoizeMaxBytes (or
+    /// ECKIT_CONNECTOR_MEMOIZE_MAX_ENTRIES and ECKIT_CONNECTOR_MEMOIZE_MAX_BYTES)
+    static std::shared_ptr<MemoizeCache> build(const std::string& service);
+
+private:  // types
+    struct Entry {
+        std::string request_;
+        Reply reply_;
+        time_t updated_;
+        time_t expires_;
+
+        size_t bytes() const { return request_.size() + reply_->size(); }
+    };
+
+    struct Hash {
+        size_t operator()(std::string_view request) const { return hash(request.data(), request.size()); }
+    };
+
+    using List = std::list<Entry>;
+
+    /// Keys view the requests held by the entries, so that an entry is unindexed by its request alone
+    using Index = std::unordered_map<std::string_view, List::iterator, Hash>;
+
+private:  // methods
+    static uint64_t hash(const void*, size_t);
+
+    void erase(List::iterator);
+    void trim(time_t now);
+
+    void print(std::ostream&) const;
+
+    friend std::ostream& operator<<(std::ostream& s, const MemoizeCache& p) {
+        p.print(s);
+        return s;
+    }
+
+private:  // members
+    mutable Mutex mutex_;
+
+    size_t maxEntries_;
+    size_t maxBytes_;
+
+    List entries_;  ///< most recently used first
+    Index index_;
+    size_t bytes_;
+
+    Statistics statistics_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::net
+
+#endif
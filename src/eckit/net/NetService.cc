@@ -8,15 +8,32 @@
  * does it submit to any jurisdiction.
  */
 
+#include "eckit/eckit.h"
+
+#if eckit_HAVE_EPOLL
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <memory>
+#include <set>
 
 #include "eckit/net/NetService.h"
 #include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
 #include "eckit/io/Select.h"
 #include "eckit/log/Log.h"
 #include "eckit/net/NetUser.h"
 #include "eckit/runtime/Monitor.h"
 #include "eckit/runtime/ProcessControler.h"
+#include "eckit/thread/AutoLock.h"
 #include "eckit/thread/ThreadControler.h"
+#include "eckit/thread/ThreadPool.h"
 
 namespace eckit::net {
 
@@ -37,6 +54,38 @@ private:
     virtual void afterForkInChild();
 };
 
+#if eckit_HAVE_EPOLL
+class NetServiceReactor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Connection {
+        std::unique_ptr<NetUser> user_;
+        int fd_;
+        std::string remote_;
+        Clock::time_point accepted_;
+    };
+
+    explicit NetServiceReactor(NetService&);
+    ~NetServiceReactor();
+
+    void run();
+    void serve(std::unique_ptr<Connection>);
+
+private:
+    NetService& service_;
+    int epoll_;
+    size_t maxConnections_;
+    bool listening_;                 ///< Protected by service_.mutex_
+    std::set<Connection*> waiting_;  ///< Accepted, waiting for a request. Only used by the reactor thread
+    Clock::time_point resume_;       ///< Accepting failed, retry from then. Only used by the reactor thread
+
+    void accept();
+    void abandoned(Connection*);
+    void listen(bool);
+};
+#endif
+
 NetService::NetService(int port, bool visible, const SocketOptions& options) :
     server_(port, options), visible_(visible) {}
 
@@ -55,6 +104,17 @@ void NetService::run() {
     Monitor::instance().name(name());
     Monitor::instance().kind(name());
 
+    if (runAsReactor()) {
+#if eckit_HAVE_EPOLL
+        NetServiceReactor reactor(*this);
+        reactor.run();
+        return;
+#else
+        Log::warning() << name() << ": epoll(7) is not available, serving each connection in its own thread"
+                       << std::endl;
+#endif
+    }
+
     std::ostringstream oss;
     oss << "Waiting on port " << port();
 
@@ -99,6 +159,27 @@ long NetService::timeout() const {
     return 0;
 }
 
+bool NetService::runAsReactor() const {
+    return Resource<bool>(name() + "NetServiceReactor", preferToRunAsReactor());
+}
+
+bool NetService::preferToRunAsReactor() const {
+    return false;
+}
+
+size_t NetService::workers() const {
+    return Resource<size_t>(name() + "NetServiceWorkers", 16);
+}
+
+size_t NetService::maxConnections() const {
+    return Resource<size_t>(name() + "NetServiceMaxConnections", 1024);
+}
+
+NetService::Statistics NetService::statistics() const {
+    AutoLock<Mutex> lock(mutex_);
+    return statistics_;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 NetServiceProcessControler::NetServiceProcessControler(const std::string& name, NetUser* user, TCPServer& server,
@@ -140,4 +221,210 @@ void NetServiceProcessControler::afterForkInChild() {
     server_.close();
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+
+#if eckit_HAVE_EPOLL
+
+namespace {
+
+class NetServiceTask : public ThreadPoolTask {
+public:
+    NetServiceTask(NetServiceReactor& reactor, std::unique_ptr<NetServiceReactor::Connection> connection) :
+        reactor_(reactor), connection_(std::move(connection)) {}
+
+private:
+    NetServiceReactor& reactor_;
+    std::unique_ptr<NetServiceReactor::Connection> connection_;
+
+    void execute() override { reactor_.serve(std::move(connection_)); }
+};
+
+}  // namespace
+
+NetServiceReactor::NetServiceReactor(NetService& service) :
+    service_(service), epoll_(-1), maxConnections_(std::max<size_t>(service.maxConnections(), 1)), listening_(true) {
+    SYSCALL(epoll_ = ::epoll_create1(EPOLL_CLOEXEC));
+
+    // Clients are accepted once the listening socket is readable, and one may leave in between: do not block then
+    int fd = service_.server_.socket();
+    int flags;
+    SYSCALL(flags = ::fcntl(fd, F_GETFL));
+    SYSCALL(::fcntl(fd, F_SETFL, flags | O_NONBLOCK));
+
+    // The listening socket is the only one registered without a connection
+    epoll_event event{};
+    event.events   = EPOLLIN;
+    event.data.ptr = nullptr;
+    SYSCALL(::epoll_ctl(epoll_, EPOLL_CTL_ADD, service_.server_.socket(), &event));
+}
+
+NetServiceReactor::~NetServiceReactor() {
+    for (Connection* c : waiting_) {
+        delete c;
+    }
+    ::close(epoll_);
+}
+
+void NetServiceReactor::run() {
+    std::ostringstream oss;
+    oss << "Waiting on port " << service_.port();
+
+    // Destroyed before returning, after the last connection has been served
+    ThreadPool pool(service_.name(), std::max<size_t>(service_.workers(), 1));
+
+    epoll_event events[64];
+
+    while (!service_.stopped()) {
+
+        size_t active;
+        {
+            AutoLock<Mutex> lock(service_.mutex_);
+            active = service_.statistics_.active_;
+            if (!listening_ && active < maxConnections_ && Clock::now() >= resume_) {
+                listen(true);
+            }
+        }
+        Log::status() << oss.str() << ", " << active << " connection(s)" << std::endl;
+
+        // The timeout will allow to check stopped() again
+        int n = ::epoll_wait(epoll_, events, 64, 1000);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw FailedSystemCall("epoll_wait");
+        }
+
+        for (int i = 0; i < n; ++i) {
+            auto* c = static_cast<Connection*>(events[i].data.ptr);
+            if (!c) {
+                accept();
+                continue;
+            }
+
+            SYSCALL(::epoll_ctl(epoll_, EPOLL_CTL_DEL, c->fd_, nullptr));
+            waiting_.erase(c);
+
+            // Closed by the peer without a request
+            char b;
+            ssize_t r = ::recv(c->fd_, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+            if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                abandoned(c);
+                continue;
+            }
+
+            // Readable: the session now belongs to a worker until it ends
+            pool.push(new NetServiceTask(*this, std::unique_ptr<Connection>(c)));
+        }
+    }
+}
+
+void NetServiceReactor::accept() {
+    // Drain the backlog, a burst of clients would otherwise overflow it between two waits
+    for (;;) {
+        try {
+            if (!service_.server_.acceptPending()) {
+                return;
+            }
+
+            // TCPServer::socket() is the listening socket, take the accepted one from a copy
+            TCPSocket socket(service_.server_);
+
+            std::unique_ptr<Connection> c(new Connection);
+            c->fd_       = socket.socket();
+            c->remote_   = socket.remoteHost();
+            c->accepted_ = Clock::now();
+            c->user_.reset(service_.newUser(socket));
+
+            epoll_event event{};
+            event.events   = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+            event.data.ptr = c.get();
+            SYSCALL(::epoll_ctl(epoll_, EPOLL_CTL_ADD, c->fd_, &event));
+
+            waiting_.insert(c.release());
+        }
+        catch (std::exception& e) {
+            // e.g. out of file descriptors: the client stays in the backlog, retry later rather than spin
+            Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+            Log::error() << "** Exception is handled" << std::endl;
+
+            AutoLock<Mutex> lock(service_.mutex_);
+            resume_ = Clock::now() + std::chrono::seconds(1);
+            if (listening_) {
+                listen(false);
+            }
+            return;
+        }
+
+        AutoLock<Mutex> lock(service_.mutex_);
+        NetService::Statistics& stats = service_.statistics_;
+        stats.accepted_++;
+        stats.active_++;
+        if (stats.active_ >= maxConnections_) {
+            // New connections stay in the listen backlog until one is closed
+            stats.limited_++;
+            listen(false);
+            return;
+        }
+    }
+}
+
+void NetServiceReactor::abandoned(Connection* c) {
+    Log::debug() << service_.name() << ": connection from " << c->remote_ << " closed without a request" << std::endl;
+
+    delete c;
+
+    AutoLock<Mutex> lock(service_.mutex_);
+    NetService::Statistics& stats = service_.statistics_;
+    stats.abandoned_++;
+    stats.active_--;
+    if (!listening_ && stats.active_ < maxConnections_) {
+        listen(true);
+    }
+}
+
+void NetServiceReactor::serve(std::unique_ptr<Connection> c) {
+    Clock::time_point start = Clock::now();
+    bool ok                 = true;
+
+    try {
+        c->user_->run();
+    }
+    catch (std::exception& e) {
+        Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+        Log::error() << "** Exception is ignored" << std::endl;
+        ok = false;
+    }
+
+    Clock::time_point end = Clock::now();
+    double waiting        = std::chrono::duration<double>(start - c->accepted_).count();
+    double serving        = std::chrono::duration<double>(end - start).count();
+
+    Log::debug() << service_.name() << ": connection from " << c->remote_ << " waited " << waiting
+                 << "s, served in " << serving << "s" << (ok ? "" : ", failed") << std::endl;
+
+    // Close the connection before accepting new ones
+    c.reset();
+
+    AutoLock<Mutex> lock(service_.mutex_);
+    NetService::Statistics& stats = service_.statistics_;
+    (ok ? stats.served_ : stats.failed_)++;
+    stats.active_--;
+    stats.waiting_ += waiting;
+    stats.serving_ += serving;
+    if (!listening_ && stats.active_ < maxConnections_) {
+        listen(true);
+    }
+}
+
+void NetServiceReactor::listen(bool on) {
+    epoll_event event{};
+    event.events   = on ? static_cast<uint32_t>(EPOLLIN) : 0;
+    event.data.ptr = nullptr;
+    SYSCALL(::epoll_ctl(epoll_, EPOLL_CTL_MOD, service_.server_.socket(), &event));
+    listening_ = on;
+}
+
+#endif
+
 }  // namespace eckit::net
@@ -15,15 +15,29 @@
 #define eckit_NetService_h
 
 #include "eckit/net/TCPServer.h"
+#include "eckit/thread/Mutex.h"
 #include "eckit/thread/Thread.h"
 
 namespace eckit::net {
 
 class NetUser;
+class NetServiceReactor;
 
 class NetService : public Thread {
 
 public:
+    /// Connections handled by the service, only maintained when running as a reactor
+    struct Statistics {
+        size_t accepted_  = 0;  ///< connections accepted
+        size_t active_    = 0;  ///< connections accepted and not yet closed
+        size_t served_    = 0;  ///< connections closed normally
+        size_t failed_    = 0;  ///< connections closed by an exception
+        size_t abandoned_ = 0;  ///< connections closed by the client before sending a request
+        size_t limited_   = 0;  ///< times accepting was paused at maxConnections()
+        double waiting_   = 0;  ///< seconds between accepting connections and their first request
+        double serving_   = 0;  ///< seconds spent serving connections
+    };
+
     /// @param[in]  port     TCP port to listen on
     /// @param[in]  visible  Make the thread this service is running in visible on the Monitor (defaults to false)
     NetService(int port, bool visible = true, const SocketOptions& options = SocketOptions::server());
@@ -37,10 +51,15 @@ public:
 
     void run() override;
 
+    Statistics statistics() const;
+
 private:
     TCPServer server_;
     bool visible_;  ///< Visible on the Monitor?
 
+    mutable Mutex mutex_;
+    Statistics statistics_;
+
 private:
     virtual NetUser* newUser(net::TCPSocket&) const = 0;
     virtual std::string name() const                = 0;
@@ -49,6 +68,15 @@ private:
     virtual bool runAsProcess() const;
 
     virtual long timeout() const;
+
+    /// Reactor mode: a single thread waits on all connections with epoll(7), and hands the readable ones
+    /// to a pool of workers() threads. At most maxConnections() connections are open at any time.
+    virtual bool preferToRunAsReactor() const;
+    virtual bool runAsReactor() const;
+    virtual size_t workers() const;
+    virtual size_t maxConnections() const;
+
+    friend class NetServiceReactor;
 };
 
 }  // namespace eckit::net
@@ -36,6 +36,7 @@ private:
     void run() override;
 
     friend class NetServiceProcessControler;
+    friend class NetServiceReactor;
 };
 
 
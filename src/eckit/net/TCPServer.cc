@@ -13,6 +13,8 @@
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <cerrno>
+
 #include "eckit/config/Resource.h"
 #include "eckit/io/Select.h"
 #include "eckit/log/Log.h"
@@ -99,6 +101,55 @@ TCPSocket& TCPServer::accept(const std::string& message, int timeout, bool* conn
     return *this;
 }
 
+bool TCPServer::acceptPending() {
+
+    bind();
+
+    sockaddr_in from;
+    socklen_t fromlen = sizeof(from);
+
+    for (;;) {
+#ifdef SOCK_CLOEXEC
+        socket_ = ::accept4(listen_, reinterpret_cast<sockaddr*>(&from), &fromlen, closeExec_ ? SOCK_CLOEXEC : 0);
+#else
+        socket_ = ::accept(listen_, reinterpret_cast<sockaddr*>(&from), &fromlen);
+#endif
+        if (socket_ >= 0) {
+            break;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return false;
+        }
+
+        // Interrupted, or the client left before being accepted: try the next one
+        if (errno != EINTR && errno != ECONNABORTED && errno != EPROTO) {
+            throw FailedSystemCall("accept");
+        }
+    }
+
+    remoteAddr_ = from.sin_addr;
+    remoteHost_ = addrToHost(from.sin_addr);
+    remotePort_ = ntohs(from.sin_port);
+
+#ifndef SOCK_CLOEXEC
+    // Where accepted sockets inherit O_NONBLOCK from the listening one
+    int flags;
+    SYSCALL(flags = fcntl(socket_, F_GETFL));
+    SYSCALL(fcntl(socket_, F_SETFL, flags & ~O_NONBLOCK));
+
+    if (closeExec_) {
+        SYSCALL(fcntl(socket_, F_SETFD, FD_CLOEXEC));
+    }
+#endif
+
+    register_ignore_sigpipe();
+
+    Log::status() << "Get connection from " << remoteHost() << std::endl;
+
+    return true;
+}
+
 void TCPServer::close() {
     TCPSocket::close();
     if (listen_ >= 0) {
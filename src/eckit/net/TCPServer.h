@@ -33,6 +33,10 @@ public:
     virtual TCPSocket& accept(const std::string& message = "Waiting for connection", int timeout = 0,
                               bool* connected = nullptr);
 
+    // accept a pending client without waiting, the listening socket() having been made non-blocking by the caller
+    // (e.g. polling it); returns false if there is none, including clients that left before being accepted
+    bool acceptPending();
+
     void closeExec(bool on) { closeExec_ = on; }
 
     int socket() override;
@@ -206,106 +206,125 @@ long TCPSocket::read(void* buf, long length) {
         return length;
     }
 
+    long received = 0;
+    char* p       = static_cast<char*>(buf);
+
+    while (length > 0) {
+        long len = readSome(p, length);
+
+        if (len < 0) {
+            return len;
+        }
+
+        if (len == 0) {
+            return received;
+        }
+
+        received += len;
+        length -= len;
+        p += len;
+    }
+
+    return received;
+}
+
+long TCPSocket::readSome(void* buf, long length) {
+    if (length <= 0) {
+        return length;
+    }
+
     static bool useSelectOnTCPSocket = Resource<bool>("useSelectOnTCPSocket", false);
-    long received                    = 0;
     char* p                          = static_cast<char*>(buf);
     bool nonews                      = false;
 
-    while (length > 0) {
-        long len;
-        if (useSelectOnTCPSocket) {
-            static long socketSelectTimeout = Resource<long>("socketSelectTimeout", 0);
-            Select select(socket_);
-            bool more = socketSelectTimeout > 0;
-            while (more) {
-                more = false;
-                if (!select.ready(socketSelectTimeout)) {
-                    SavedStatus save;
-
-                    Log::warning() << "No news from " << remoteHost() << " from " << Seconds(socketSelectTimeout)
-                                   << std::endl;
-
-                    Log::status() << "No news from " << remoteHost() << " from " << Seconds(socketSelectTimeout)
-                                  << std::endl;
-
-                    // FIXME: enable the nonews flag here?
-                    // nonews = true;
-
-                    // Time out, write 0 bytes to check that peer is alive
-                    if (::write(socket_, nullptr, 0) != 0) {
-                        Log::error() << "TCPSocket::read write" << Log::syserr << std::endl;
-                        return -1;
-                    }
-                    more = true;
-                    break;
+    long len;
+    if (useSelectOnTCPSocket) {
+        static long socketSelectTimeout = Resource<long>("socketSelectTimeout", 0);
+        Select select(socket_);
+        bool more = socketSelectTimeout > 0;
+        while (more) {
+            more = false;
+            if (!select.ready(socketSelectTimeout)) {
+                SavedStatus save;
+
+                Log::warning() << "No news from " << remoteHost() << " from " << Seconds(socketSelectTimeout)
+                               << std::endl;
+
+                Log::status() << "No news from " << remoteHost() << " from " << Seconds(socketSelectTimeout)
+                              << std::endl;
+
+                // FIXME: enable the nonews flag here?
+                // nonews = true;
+
+                // Time out, write 0 bytes to check that peer is alive
+                if (::write(socket_, nullptr, 0) != 0) {
+                    Log::error() << "TCPSocket::read write" << Log::syserr << std::endl;
+                    return -1;
                 }
+                more = true;
+                break;
             }
+        }
 
-            len = -1;
+        len = -1;
 
-            if (nonews) {
-                AutoAlarm alarm(60, true);
-                Log::status() << "Resuming transfer" << std::endl;
-                len = ::read(socket_, p, length);
-            }
-            else {
-                len = ::read(socket_, p, length);
-            }
+        if (nonews) {
+            AutoAlarm alarm(60, true);
+            Log::status() << "Resuming transfer" << std::endl;
+            len = ::read(socket_, p, length);
         }
         else {
             len = ::read(socket_, p, length);
         }
+    }
+    else {
+        len = ::read(socket_, p, length);
+    }
 
-        if (len < 0) {
-            Log::error() << "Socket read failed (" << *this << ")" << Log::syserr << std::endl;
-            return len;
-        }
-
-        if (len == 0) {
-            return received;
-        }
+    if (len < 0) {
+        Log::error() << "Socket read failed (" << *this << ")" << Log::syserr << std::endl;
+        return len;
+    }
 
-        if (debug_) {
+    if (len == 0) {
+        return 0;
+    }
 
-            if (mode_ != 'r') {
-                newline_ = true;
-                std::cout << std::endl
-                          << std::endl;
-                mode_ = 'r';
-            }
+    if (debug_) {
 
-            for (long i = 0; i < std::min(len, 512L); i++) {
-                if (newline_) {
-                    std::cout << "<<< ";
-                    newline_ = false;
-                }
+        if (mode_ != 'r') {
+            newline_ = true;
+            std::cout << std::endl
+                      << std::endl;
+            mode_ = 'r';
+        }
 
-                if (p[i] == '\r') {
-                    std::cout << "\\r";
-                }
-                else if (p[i] == '\n') {
-                    std::cout << "\\n"
-                              << std::endl;
-                    newline_ = true;
-                }
-                else {
-                    std::cout << (isprint(p[i]) ? p[i] : '.');
-                }
+        for (long i = 0; i < std::min(len, 512L); i++) {
+            if (newline_) {
+                std::cout << "<<< ";
+                newline_ = false;
             }
 
-            if (len > 512) {
-                std::cout << "..." << std::endl;
+            if (p[i] == '\r') {
+                std::cout << "\\r";
+            }
+            else if (p[i] == '\n') {
+                std::cout << "\\n"
+                          << std::endl;
                 newline_ = true;
             }
+            else {
+                std::cout << (isprint(p[i]) ? p[i] : '.');
+            }
         }
 
-
-        received += len;
-        length -= len;
-        p += len;
+        if (len > 512) {
+            std::cout << "..." << std::endl;
+            newline_ = true;
+        }
     }
 
-    return received;
+    return len;
 }
 
 void TCPSocket::close() {
@@ -61,6 +61,10 @@ public:  // methods
     ///   (only if **useSelectOnTCPSocket** is enabled)
     long read(void* buf, long length);
 
+    /// Read what is available, up to `length` bytes, as a single read() with the same configuration flags
+    /// @returns bytes read, at least one unless at the end of file (0) or on error (-1)
+    long readSome(void* buf, long length);
+
     long rawRead(void*, long);  // Non-blocking version
 
     bool isConnected() const { return socket_ != -1; }
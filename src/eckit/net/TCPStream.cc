@@ -8,18 +8,150 @@
  * does it submit to any jurisdiction.
  */
 
+#include <algorithm>
+#include <cstring>
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
 #include "eckit/net/TCPStream.h"
 
 namespace eckit::net {
 
+//----------------------------------------------------------------------------------------------------------------------
+
+TCPStreamBuffer::TCPStreamBuffer(size_t size) :
+    size_(0), used_(0), pos_(0), end_(0) {
+    resize(size);
+}
+
+size_t TCPStreamBuffer::defaultSize() {
+    static size_t size = Resource<size_t>("tcpStreamBufferSize;$ECKIT_TCP_STREAM_BUFFER_SIZE", 0);
+    return size;
+}
+
+void TCPStreamBuffer::resize(size_t size) {
+    ASSERT(used_ == 0);
+    ASSERT(pos_ == end_);
+    size_ = size;
+    out_.resize(size);
+    in_.resize(size);
+}
+
+void TCPStreamBuffer::reset() {
+    used_ = 0;
+    pos_ = end_ = 0;
+}
+
+bool TCPStreamBuffer::flush(TCPSocket& socket) {
+    if (used_ == 0) {
+        return true;
+    }
+
+    long length = long(used_);
+    used_       = 0;
+    return socket.write(out_, length) == length;
+}
+
+long TCPStreamBuffer::write(TCPSocket& socket, const void* buf, long length) {
+    if (size_ == 0) {
+        return socket.write(buf, length);
+    }
+
+    if (used_ + size_t(length) > size_ && !flush(socket)) {
+        return -1;
+    }
+
+    if (size_t(length) >= size_) {
+        return socket.write(buf, length);
+    }
+
+    ::memcpy(out_ + used_, buf, size_t(length));
+    used_ += size_t(length);
+    return length;
+}
+
+long TCPStreamBuffer::read(TCPSocket& socket, void* buf, long length) {
+    if (size_ == 0) {
+        return socket.read(buf, length);
+    }
+
+    // The request is complete, send it
+    if (!flush(socket)) {
+        return -1;
+    }
+
+    char* p    = static_cast<char*>(buf);
+    long total = 0;
+
+    while (length > 0) {
+        if (pos_ < end_) {
+            size_t n = std::min(size_t(length), end_ - pos_);
+            ::memcpy(p, in_ + pos_, n);
+            pos_ += n;
+            p += n;
+            total += long(n);
+            length -= long(n);
+            continue;
+        }
+
+        if (size_t(length) >= size_) {
+            long n = socket.read(p, length);
+            return n < 0 ? n : total + n;
+        }
+
+        // Whatever is available, up to the size of the buffer, with the timeouts of TCPSocket::read
+        long n = socket.readSome(in_, long(size_));
+        if (n < 0) {
+            return n;
+        }
+
+        if (n == 0) {
+            break;  // end of file
+        }
+
+        pos_ = 0;
+        end_ = size_t(n);
+    }
+
+    return total;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void TCPStreamBase::flush() {
+    if (!buffer_.flush(socket())) {
+        throw WriteError(name());
+    }
+}
+
+void TCPStreamBase::flushNoThrow() {
+    try {
+        flush();
+    }
+    catch (std::exception& e) {
+        Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+        Log::error() << "** Exception is ignored" << std::endl;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 TCPStream::TCPStream(net::TCPSocket& socket) :
-    socket_(socket) {}
+    TCPStreamBase(TCPStreamBuffer::defaultSize()), socket_(socket) {}
 
-TCPStream::~TCPStream() {}
+TCPStream::~TCPStream() {
+    flushNoThrow();
+}
 
 void TCPStream::closeOutput() {
+    flush();
     socket_.closeOutput();
 }
+
+InstantTCPStream::~InstantTCPStream() {
+    flushNoThrow();
+}
 //----------------------------------------------------------------------------------------------------------------------
 // Tricky solution to be removed when 'mutable' is available
 //
@@ -14,7 +14,9 @@
 #ifndef eckit_TCPStream_h
 #define eckit_TCPStream_h
 
+#include "eckit/io/Buffer.h"
 #include "eckit/memory/Counted.h"
+#include "eckit/memory/NonCopyable.h"
 #include "eckit/net/TCPSocket.h"
 #include "eckit/serialisation/Stream.h"
 
@@ -24,27 +26,82 @@ class TCPServer;
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Send and receive buffers in front of a TCPSocket
+///
+/// A Stream writes each tag and value separately; buffered, they are sent together when the send buffer is full, when
+/// flushed, or before reading (i.e. at the end of a request). Reads are served from a receive buffer, filled by reads
+/// of up to `size` bytes. Larger transfers go straight to the socket. With a size of 0, nothing is buffered.
+///
+/// @note The socket must only be read and written through the buffer
+class TCPStreamBuffer : private NonCopyable {
+public:
+    explicit TCPStreamBuffer(size_t size = 0);
+
+    /// Size of the buffers of TCPStream and Connector (tcpStreamBufferSize or ECKIT_TCP_STREAM_BUFFER_SIZE, default 0)
+    static size_t defaultSize();
+
+    /// @pre nothing buffered
+    void resize(size_t size);
+
+    size_t size() const { return size_; }
+
+    long write(TCPSocket&, const void*, long);
+    long read(TCPSocket&, void*, long);
+
+    /// Send the buffered data
+    /// @returns false on failure, the data is discarded
+    bool flush(TCPSocket&);
+
+    /// Discard the buffered data, e.g. when the connection is reset
+    void reset();
+
+private:
+    size_t size_;
+
+    Buffer out_;
+    size_t used_;  ///< bytes to send
+
+    Buffer in_;
+    size_t pos_;  ///< next byte received to read
+    size_t end_;  ///< end of bytes received
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
 class TCPStreamBase : public Stream {
 public:
-    TCPStreamBase() {}
+    explicit TCPStreamBase(size_t bufferSize = 0) :
+        buffer_(bufferSize) {}
 
     in_addr remoteAddr() { return socket().remoteAddr(); }
 
-    long write(const void* buf, long len) override { return socket().write(buf, len); }
+    /// Buffer writes and reads, see TCPStreamBuffer; 0 to disable
+    void buffered(size_t size) { buffer_.resize(size); }
 
-    long read(void* buf, long len) override { return socket().read(buf, len); }
+    /// Send the buffered writes
+    void flush();
+
+    long write(const void* buf, long len) override { return buffer_.write(socket(), buf, len); }
+
+    long read(void* buf, long len) override { return buffer_.read(socket(), buf, len); }
 
 protected:
     std::string name() const override;
 
+    /// Flush from destructors
+    void flushNoThrow();
 
 private:  // methods
     std::string nonConstName();
     virtual TCPSocket& socket() = 0;
+
+private:  // members
+    TCPStreamBuffer buffer_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Buffered as configured by TCPStreamBuffer::defaultSize()
 class TCPStream : public TCPStreamBase {
 public:
     /// @note Takes ownership of TCPSocket;
@@ -66,12 +123,15 @@ private:
 //----------------------------------------------------------------------------------------------------------------------
 
 
+/// Not buffered unless asked (buffered()), as the socket is often used directly after a handshake through the stream
 class InstantTCPStream : public TCPStreamBase {
 public:
     /// @note  does not take ownership of TCPSocket
     InstantTCPStream(net::TCPSocket& socket) :
         socket_(socket) {}
 
+    ~InstantTCPStream() override;
+
     TCPSocket& socket() override { return socket_; }
 
 private:
@@ -11,27 +11,38 @@
 
 #include <cstring>
 
+#include "eckit/exception/Exceptions.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/io/SharedBuffer.h"
 #include "eckit/serialisation/MemoryStream.h"
 
 
 namespace eckit {
 
 MemoryStream::MemoryStream(const Buffer& buffer) :
-    address_(const_cast<Buffer&>(buffer)), size_(buffer.size()), position_(0) {}
+    address_(const_cast<Buffer&>(buffer)), size_(buffer.size()), position_(0), owner_(nullptr) {}
 
 
 MemoryStream::MemoryStream(Buffer& buffer) :
-    address_(buffer), size_(buffer.size()), position_(0) {}
+    address_(buffer), size_(buffer.size()), position_(0), owner_(nullptr) {}
 
 MemoryStream::MemoryStream(const void* address, size_t size) :
-    address_(const_cast<char*>(reinterpret_cast<const char*>(address))), size_(size), position_(0) {}
+    address_(const_cast<char*>(reinterpret_cast<const char*>(address))), size_(size), position_(0), owner_(nullptr) {}
 
 
 MemoryStream::MemoryStream(void* address, size_t size) :
-    address_(reinterpret_cast<char*>(address)), size_(size), position_(0) {}
+    address_(reinterpret_cast<char*>(address)), size_(size), position_(0), owner_(nullptr) {}
 
-MemoryStream::~MemoryStream() {}
+MemoryStream::MemoryStream(const SharedBuffer& buffer) :
+    address_(*buffer.operator->()), size_(buffer.size()), position_(0), owner_(buffer.operator->()) {
+    owner_->attach();
+}
+
+MemoryStream::~MemoryStream() {
+    if (owner_) {
+        owner_->detach();
+    }
+}
 
 long MemoryStream::read(void* buffer, long length) {
     size_t left = size_ - position_;
@@ -51,6 +62,15 @@ long MemoryStream::write(const void* buffer, long length) {
     return long(size);
 }
 
+SharedBufferView MemoryStream::view(size_t length) {
+    if (length > size_ - position_) {
+        throw ReadError(name());
+    }
+    SharedBufferView v(address_ + position_, length, owner_);
+    position_ += length;
+    return v;
+}
+
 void MemoryStream::rewind() {
     position_ = 0;
 }
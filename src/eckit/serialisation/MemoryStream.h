@@ -20,6 +20,8 @@
 namespace eckit {
 
 class Buffer;
+class CountedBuffer;
+class SharedBuffer;
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -31,6 +33,9 @@ public:
     MemoryStream(const void* address, size_t size);
     MemoryStream(void* address, size_t size);
 
+    /// Views read from the stream keep the buffer alive, see Stream::readView()
+    MemoryStream(const SharedBuffer&);
+
     ~MemoryStream();
 
     long read(void*, long) override;
@@ -40,11 +45,16 @@ public:
 
     size_t position() const;
 
+private:  // methods
+    SharedBufferView view(size_t length) override;
+
 private:  // members
     char* address_;
     const size_t size_;
 
     size_t position_;
+
+    CountedBuffer* owner_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -11,7 +11,9 @@
 
 #include <cstring>
 
+#include "eckit/exception/Exceptions.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/io/SharedBuffer.h"
 #include "eckit/maths/Functions.h"
 #include "eckit/serialisation/ResizableMemoryStream.h"
 
@@ -19,9 +21,18 @@
 namespace eckit {
 
 ResizableMemoryStream::ResizableMemoryStream(Buffer& buffer) :
-    buffer_(buffer), position_(0) {}
+    buffer_(buffer), position_(0), owner_(nullptr) {}
 
-ResizableMemoryStream::~ResizableMemoryStream() {}
+ResizableMemoryStream::ResizableMemoryStream(SharedBuffer& buffer) :
+    buffer_(buffer), position_(0), owner_(buffer.operator->()) {
+    owner_->attach();
+}
+
+ResizableMemoryStream::~ResizableMemoryStream() {
+    if (owner_) {
+        owner_->detach();
+    }
+}
 
 long ResizableMemoryStream::read(void* buffer, long length) {
     size_t left = buffer_.size() - position_;
@@ -50,6 +61,15 @@ long ResizableMemoryStream::write(const void* buffer, long length) {
     return long(written);
 }
 
+SharedBufferView ResizableMemoryStream::view(size_t length) {
+    if (length > buffer_.size() - position_) {
+        throw ReadError(name());
+    }
+    SharedBufferView v(buffer_ + position_, length, owner_);
+    position_ += length;
+    return v;
+}
+
 void ResizableMemoryStream::rewind() {
     position_ = 0;
 }
@@ -19,6 +19,8 @@
 namespace eckit {
 
 class Buffer;
+class CountedBuffer;
+class SharedBuffer;
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -26,6 +28,10 @@ class ResizableMemoryStream : public Stream {
 public:
     ResizableMemoryStream(Buffer&);
 
+    /// Views read from the stream keep the buffer alive, see Stream::readView(), but not its memory if it is resized
+    /// by further writes
+    ResizableMemoryStream(SharedBuffer&);
+
     ~ResizableMemoryStream();
 
     long read(void*, long) override;
@@ -36,10 +42,15 @@ public:
 
     size_t position() const;
 
+private:  // methods
+    SharedBufferView view(size_t length) override;
+
 private:  // members
     Buffer& buffer_;
 
     size_t position_;
+
+    CountedBuffer* owner_;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
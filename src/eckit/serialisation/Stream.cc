@@ -17,12 +17,17 @@
 #include <cassert>
 #include <cstring>
 
+#include "eckit/eckit.h"
+
+#include "eckit/config/Resource.h"
 #include "eckit/exception/Exceptions.h"
 #include "eckit/io/Buffer.h"
+#include "eckit/io/SharedBuffer.h"
 #include "eckit/log/Log.h"
 #include "eckit/maths/Functions.h"
 #include "eckit/os/BackTrace.h"
 #include "eckit/serialisation/BadTag.h"
+#include "eckit/utils/ByteSwap.h"
 
 namespace eckit {
 
@@ -58,13 +63,25 @@ static const char* tag_names[] = {"0",
                                   "start of record",
                                   "end of record",
                                   "end of file",
-                                  "large blob"};
+                                  "large blob",
+                                  "array of char",
+                                  "array of unsigned char",
+                                  "array of short",
+                                  "array of unsigned short",
+                                  "array of int",
+                                  "array of unsigned int",
+                                  "array of long",
+                                  "array of unsigned long",
+                                  "array of long long",
+                                  "array of unsigned long long",
+                                  "array of float",
+                                  "array of double"};
 
 const int tag_count = sizeof(tag_names) / sizeof(tag_names[0]);
 
 
 Stream::Stream() :
-    lastTag_(tag_zero), writeCount_(0) {}
+    lastTag_(tag_zero), writeCount_(0), swapArray_(false) {}
 
 void Stream::print(std::ostream& s) const {
     s << name();
@@ -90,6 +107,28 @@ void Stream::getBytes(void* buf, long len) {
     }
 }
 
+void Stream::putLargeBytes(const void* buf, size_t len) {
+    const size_t n = 0x80000000;
+    const char* p  = static_cast<const char*>(buf);
+    while (len > 0) {
+        size_t l = len > n ? n : len;
+        putBytes(p, l);
+        p += l;
+        len -= l;
+    }
+}
+
+void Stream::getLargeBytes(void* buf, size_t len) {
+    const size_t n = 0x80000000;
+    char* p        = static_cast<char*>(buf);
+    while (len > 0) {
+        size_t l = len > n ? n : len;
+        getBytes(p, l);
+        p += l;
+        len -= l;
+    }
+}
+
 
 void Stream::putChar(unsigned char p) {
     assert(sizeof(unsigned char) == 1);
@@ -396,14 +435,7 @@ void Stream::writeLargeBlob(const void* buffer, size_t size) {
     putLong(len >> 32);
     putLong(len & 0xffffffff);
 
-    long n        = 0x80000000;
-    const char* p = static_cast<const char*>(buffer);
-    while (size > 0) {
-        long l = size > size_t(n) ? n : size;
-        putBytes(p, l);
-        p += l;
-        size -= l;
-    }
+    putLargeBytes(buffer, size);
 }
 
 void Stream::writeBlob(const void* buffer, size_t size) {
@@ -558,16 +590,162 @@ void Stream::readLargeBlob(void* buffer, size_t size) {
 
     // std::cout << "Stream::readLargeBlob " << size << std::endl;
 
-    long n  = 0x80000000;
-    char* p = static_cast<char*>(buffer);
-    while (size > 0) {
-        long l = size > size_t(n) ? n : size;
-        getBytes(p, l);
-        p += l;
-        size -= l;
+    getLargeBytes(buffer, size);
+}
+
+SharedBufferView Stream::readView() {
+    tag t;
+    while ((t = nextTag()) == tag_end_obj) {
+        ;
+    }
+    lastTag_ = t;
+
+    if (t != tag_string && t != tag_large_blob) {
+        t = tag_blob;  // reported by readTag()
+    }
+    readTag(t);
+
+    size_t length;
+    if (t == tag_large_blob) {
+        unsigned long long u1 = getLong();
+        unsigned long long u2 = getLong();
+        length                = (u1 << 32) | u2;
+    }
+    else {
+        long len = getLong();
+        ASSERT(len >= 0);
+        length = len;
+    }
+
+    T("r view", length);
+    return view(length);
+}
+
+SharedBufferView Stream::view(size_t length) {
+    SharedBuffer buffer(length);
+    getLargeBytes(buffer.data(), length);
+    return SharedBufferView(buffer);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+// Byte order of the values of arrays
+enum
+{
+    little_endian = 0,
+    big_endian    = 1
+};
+
+#if ECKIT_LITTLE_ENDIAN
+const unsigned char native_byte_order = little_endian;
+#else
+const unsigned char native_byte_order = big_endian;
+#endif
+
+}  // namespace
+
+bool Stream::writeArrays() {
+    static bool legacy = Resource<bool>("streamLegacyArrays;$ECKIT_STREAM_LEGACY_ARRAYS", false);
+    return !legacy;
+}
+
+template <typename V>
+void Stream::writeArray(const V* values, size_t count) {
+    T("w array", count);
+    writeTag(arrayTag<V>());
+
+    putChar(native_byte_order);
+    putChar(sizeof(V));
+
+    unsigned long long len = count;
+    putLong(len >> 32);
+    putLong(len & 0xffffffff);
+
+    putLargeBytes(values, count * sizeof(V));
+}
+
+template <typename V>
+bool Stream::startArray(size_t& count) {
+    tag t;
+    while ((t = nextTag()) == tag_end_obj) {
+        ;
     }
+
+    if (t != arrayTag<V>()) {
+        lastTag_ = t;
+        return false;
+    }
+
+    unsigned char order = getChar();
+    unsigned char size  = getChar();
+    if (size != sizeof(V)) {
+        std::ostringstream os;
+        os << "Stream: " << t << " of " << int(size) << " bytes values, expected " << sizeof(V) << " bytes";
+        throw BadValue(os.str());
+    }
+    ASSERT(order == little_endian || order == big_endian);
+    swapArray_ = order != native_byte_order;
+
+    unsigned long long u1  = getLong();
+    unsigned long long u2  = getLong();
+    unsigned long long len = (u1 << 32) | u2;
+
+    count = len;
+    ASSERT(count == len);
+    return true;
 }
 
+template <typename V>
+void Stream::readArray(V* values, size_t count) {
+    getLargeBytes(values, count * sizeof(V));
+
+    if constexpr (sizeof(V) > 1) {
+        if (swapArray_) {
+            byteswap(values, count);
+        }
+    }
+    T("r array", count);
+}
+
+// clang-format off
+template <> Stream::tag Stream::arrayTag<char>()               { return tag_array_char; }
+template <> Stream::tag Stream::arrayTag<unsigned char>()      { return tag_array_unsigned_char; }
+template <> Stream::tag Stream::arrayTag<short>()              { return tag_array_short; }
+template <> Stream::tag Stream::arrayTag<unsigned short>()     { return tag_array_unsigned_short; }
+template <> Stream::tag Stream::arrayTag<int>()                { return tag_array_int; }
+template <> Stream::tag Stream::arrayTag<unsigned int>()       { return tag_array_unsigned_int; }
+template <> Stream::tag Stream::arrayTag<long>()               { return tag_array_long; }
+template <> Stream::tag Stream::arrayTag<unsigned long>()      { return tag_array_unsigned_long; }
+template <> Stream::tag Stream::arrayTag<long long>()          { return tag_array_long_long; }
+template <> Stream::tag Stream::arrayTag<unsigned long long>() { return tag_array_unsigned_long_long; }
+template <> Stream::tag Stream::arrayTag<float>()              { return tag_array_float; }
+template <> Stream::tag Stream::arrayTag<double>()             { return tag_array_double; }
+// clang-format on
+
+#define STREAM_ARRAY(V)                                    \
+    template void Stream::writeArray<V>(const V*, size_t); \
+    template bool Stream::startArray<V>(size_t&);          \
+    template void Stream::readArray<V>(V*, size_t);
+
+STREAM_ARRAY(char)
+STREAM_ARRAY(unsigned char)
+STREAM_ARRAY(short)
+STREAM_ARRAY(unsigned short)
+STREAM_ARRAY(int)
+STREAM_ARRAY(unsigned int)
+STREAM_ARRAY(long)
+STREAM_ARRAY(unsigned long)
+STREAM_ARRAY(long long)
+STREAM_ARRAY(unsigned long long)
+STREAM_ARRAY(float)
+STREAM_ARRAY(double)
+
+#undef STREAM_ARRAY
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void Stream::rewind() {
     NOTIMP;
 }
@@ -14,6 +14,7 @@
 #ifndef eckit_Stream_h
 #define eckit_Stream_h
 
+#include <cstddef>
 #include <map>
 #include <string>
 
@@ -31,6 +32,7 @@ class BufferedReader;
 template <class T>
 class IOBuffer;
 class Buffer;
+class SharedBufferView;
 
 class Stream : private NonCopyable {
 public:
@@ -114,6 +116,28 @@ public:
     void writeLargeBlob(const void*, size_t);
     void readLargeBlob(void*, size_t);
 
+    /// Read the next string, blob or large blob without copying it, if the stream is in memory (see MemoryStream)
+    SharedBufferView readView();
+
+    // Arrays of numbers: a single tag and header, then the values in the byte order of the sender (swapped by the
+    // receiver if needed), instead of a tag and a conversion for each value
+
+    /// @returns if vectors, Vector, Matrix and lists of numbers are written as arrays, rather than as previous versions
+    /// do (which cannot read arrays), unless streamLegacyArrays or ECKIT_STREAM_LEGACY_ARRAYS is set during upgrades
+    static bool writeArrays();
+
+    template <typename V>
+    void writeArray(const V*, size_t);
+
+    /// Read the header of an array of V
+    /// @returns false if the next value is not an array of V (e.g. encoded by a previous version), it is left to read
+    template <typename V>
+    bool startArray(size_t& count);
+
+    /// Read the values of the array started by startArray()
+    template <typename V>
+    void readArray(V*, size_t count);
+
     virtual void rewind();
     virtual void closeOutput();
     virtual void closeInput();
@@ -169,6 +193,18 @@ private:
         tag_end_rec,
         tag_eof,
         tag_large_blob,  // For blobs >= 2Gb
+        tag_array_char,
+        tag_array_unsigned_char,
+        tag_array_short,
+        tag_array_unsigned_short,
+        tag_array_int,
+        tag_array_unsigned_int,
+        tag_array_long,
+        tag_array_unsigned_long,
+        tag_array_long_long,
+        tag_array_unsigned_long_long,
+        tag_array_float,
+        tag_array_double,
         last_tag
     };
 
@@ -177,6 +213,7 @@ private:
     tag lastTag_;
     Mutex mutex_;
     long writeCount_;
+    bool swapArray_;  ///< the array being read is in the other byte order
 
     // -- Methods
 
@@ -185,6 +222,9 @@ private:
     virtual long write(const void*, long) = 0;
     virtual long read(void*, long)        = 0;
 
+    /// The next `length` bytes, by default copied
+    virtual SharedBufferView view(size_t length);
+
     unsigned char getChar();
     unsigned long getLong();
 
@@ -199,6 +239,12 @@ private:
     void getBytes(void*, long);
     void putBytes(const void*, long);
 
+    void getLargeBytes(void*, size_t);
+    void putLargeBytes(const void*, size_t);
+
+    template <typename V>
+    static tag arrayTag();
+
     friend std::ostream& operator<<(std::ostream&, tag);
 
     friend class BufferedWriter<Stream>;
@@ -118,8 +118,8 @@ void ThreadPool::waitForThreads() {
 }
 
 void ThreadPool::notifyStart() {
+    // running_ is counted by resize(), so that waitForThreads() also waits for threads not yet started
     AutoLock<MutexCond> lock(done_);
-    running_++;
     done_.signal();
     // Log::info() << "ThreadPool::notifyStart " << name_ << " running: " << running_ << std::endl;
 }
@@ -208,8 +208,21 @@ void ThreadPool::resize(size_t size) {
     }
 
     while (count_ < size) {
-        ThreadControler c(new ThreadPoolThread(*this), true, stack_);
-        c.start();
+        {
+            AutoLock<MutexCond> lock(done_);
+            running_++;
+        }
+        try {
+            ThreadControler c(new ThreadPoolThread(*this), true, stack_);
+            c.start();
+        }
+        catch (...) {
+            // The thread will never notifyEnd()
+            AutoLock<MutexCond> lock(done_);
+            running_--;
+            done_.signal();
+            throw;
+        }
         count_++;
     }
 }
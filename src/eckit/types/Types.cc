@@ -8,6 +8,8 @@
  * does it submit to any jurisdiction.
  */
 
+#include <type_traits>
+
 #include "eckit/types/Types.h"
 #include "eckit/serialisation/Stream.h"
 
@@ -15,8 +17,22 @@ namespace eckit {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/// Vectors of numbers are sent as arrays, for the types with an array tag (see Stream::writeArray)
+template <class T, class... Types>
+constexpr bool is_one_of_v = (std::is_same_v<T, Types> || ...);
+
+template <class T>
+constexpr bool is_stream_array_v = is_one_of_v<T, char, unsigned char, short, unsigned short, int, unsigned int, long,
+                                               unsigned long, long long, unsigned long long, float, double>;
+
 template <class T>
 Stream& operator<<(Stream& s, const std::vector<T>& t) {
+    if constexpr (is_stream_array_v<T>) {
+        if (Stream::writeArrays()) {
+            s.writeArray(t.data(), t.size());
+            return s;
+        }
+    }
     s << Ordinal(t.size());
     for (typename std::vector<T>::const_iterator i = t.begin(); i != t.end(); ++i)
         s << (*i);
@@ -25,6 +41,16 @@ Stream& operator<<(Stream& s, const std::vector<T>& t) {
 
 template <class T>
 Stream& operator>>(Stream& s, std::vector<T>& t) {
+    if constexpr (is_stream_array_v<T>) {
+        size_t size;
+        if (s.startArray<T>(size)) {
+            t.resize(size);
+            s.readArray(t.data(), size);
+            return s;
+        }
+        // Otherwise, encoded by a previous version
+    }
+
     Ordinal size;
     s >> size;
 
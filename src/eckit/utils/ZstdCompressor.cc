@@ -0,0 +1,264 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include "eckit/utils/ZstdCompressor.h"
+
+#include <cstring>
+#include <memory>
+
+#include "zdict.h"
+#include "zstd.h"  // headers include extern c linkage
+
+#include "eckit/config/Resource.h"
+#include "eckit/exception/Exceptions.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/DataHandle.h"
+#include "eckit/log/Log.h"
+#include "eckit/thread/AutoLock.h"
+
+namespace eckit {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+inline size_t ZstdCall(size_t code, const char* zstd_func, const eckit::CodeLocation& loc) {
+    if (ZSTD_isError(code)) {
+        std::ostringstream msg;
+        msg << "returned " << code << " (" << ZSTD_getErrorName(code) << ")";
+        throw FailedLibraryCall("Zstd", zstd_func, msg.str(), loc);
+    }
+    return code;
+}
+
+#define ZSTD_CALL(a) ZstdCall(a, #a, Here())
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ZstdCompressor::ZstdCompressor() :
+    level_(Resource<int>("zstdCompressionLevel;$ECKIT_ZSTD_COMPRESSION_LEVEL", ZSTD_CLEVEL_DEFAULT)),
+    workers_(Resource<size_t>("zstdWorkers;$ECKIT_ZSTD_WORKERS", 0)),
+    threshold_(Resource<size_t>("zstdWorkersThreshold;$ECKIT_ZSTD_WORKERS_THRESHOLD", 8 * 1024 * 1024)),
+    cdict_(nullptr),
+    ddict_(nullptr) {
+    init();
+
+    static std::string path = Resource<std::string>("zstdDictionary;$ECKIT_ZSTD_DICTIONARY", "");
+    if (!path.empty()) {
+        PathName dictionary(path);
+        Buffer dict(size_t(dictionary.size()));
+        std::unique_ptr<DataHandle> dh(dictionary.fileHandle());
+        dh->openForRead();
+        ASSERT(dh->read(dict, long(dict.size())) == long(dict.size()));
+        dh->close();
+        this->dictionary(dict, dict.size());
+    }
+}
+
+ZstdCompressor::ZstdCompressor(int level, size_t workers, size_t threshold) :
+    level_(level),
+    workers_(workers),
+    threshold_(threshold),
+    cdict_(nullptr),
+    ddict_(nullptr) {
+    init();
+}
+
+ZstdCompressor::~ZstdCompressor() {
+    clear();
+    ZSTD_freeCDict(cdict_);
+    ZSTD_freeDDict(ddict_);
+}
+
+void ZstdCompressor::init() {
+    if (level_ < ZSTD_minCLevel() || level_ > ZSTD_maxCLevel()) {
+        std::ostringstream msg;
+        msg << "ZstdCompressor: compression level " << level_ << " not in [" << ZSTD_minCLevel() << ", "
+            << ZSTD_maxCLevel() << "]";
+        throw BadValue(msg.str(), Here());
+    }
+
+    ZSTD_CCtx* cctx = compressionContext();
+
+    if (workers_ > 0 && ZSTD_isError(ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, int(workers_)))) {
+        Log::warning() << "ZstdCompressor: libzstd is not multithreaded, ignoring " << workers_ << " workers"
+                       << std::endl;
+        workers_ = 0;
+    }
+
+    release(cctx);
+}
+
+void ZstdCompressor::clear() {
+    AutoLock<Mutex> lock(mutex_);
+    for (auto* cctx : cctxs_) {
+        ZSTD_freeCCtx(cctx);
+    }
+    for (auto* dctx : dctxs_) {
+        ZSTD_freeDCtx(dctx);
+    }
+    cctxs_.clear();
+    dctxs_.clear();
+}
+
+ZSTD_CCtx* ZstdCompressor::compressionContext() const {
+    {
+        AutoLock<Mutex> lock(mutex_);
+        if (!cctxs_.empty()) {
+            ZSTD_CCtx* cctx = cctxs_.back();
+            cctxs_.pop_back();
+            return cctx;
+        }
+    }
+
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    if (!cctx) {
+        throw OutOfMemory();
+    }
+
+    try {
+        ZSTD_CALL(ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level_));
+        if (cdict_) {
+            ZSTD_CALL(ZSTD_CCtx_refCDict(cctx, cdict_));
+        }
+    }
+    catch (...) {
+        ZSTD_freeCCtx(cctx);
+        throw;
+    }
+
+    return cctx;
+}
+
+ZSTD_DCtx* ZstdCompressor::decompressionContext() const {
+    {
+        AutoLock<Mutex> lock(mutex_);
+        if (!dctxs_.empty()) {
+            ZSTD_DCtx* dctx = dctxs_.back();
+            dctxs_.pop_back();
+            return dctx;
+        }
+    }
+
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    if (!dctx) {
+        throw OutOfMemory();
+    }
+
+    if (ddict_ && ZSTD_isError(ZSTD_DCtx_refDDict(dctx, ddict_))) {
+        ZSTD_freeDCtx(dctx);
+        throw FailedLibraryCall("Zstd", "ZSTD_DCtx_refDDict", "invalid dictionary", Here());
+    }
+
+    return dctx;
+}
+
+void ZstdCompressor::release(ZSTD_CCtx* cctx) const {
+    AutoLock<Mutex> lock(mutex_);
+    cctxs_.push_back(cctx);
+}
+
+void ZstdCompressor::release(ZSTD_DCtx* dctx) const {
+    AutoLock<Mutex> lock(mutex_);
+    dctxs_.push_back(dctx);
+}
+
+void ZstdCompressor::dictionary(const void* dict, size_t size) {
+    // contexts referencing the previous dictionary
+    clear();
+
+    ZSTD_freeCDict(cdict_);
+    ZSTD_freeDDict(ddict_);
+    cdict_ = nullptr;
+    ddict_ = nullptr;
+
+    cdict_ = ZSTD_createCDict(dict, size, level_);
+    ddict_ = ZSTD_createDDict(dict, size);
+    if (!cdict_ || !ddict_) {
+        throw FailedLibraryCall("Zstd", "ZSTD_createCDict", "invalid dictionary", Here());
+    }
+}
+
+Buffer ZstdCompressor::trainDictionary(const Samples& samples, size_t capacity) {
+    size_t total = 0;
+    for (const auto& s : samples) {
+        total += s.second;
+    }
+
+    Buffer in(total);
+    std::vector<size_t> sizes;
+    sizes.reserve(samples.size());
+
+    char* p = in;
+    for (const auto& s : samples) {
+        ::memcpy(p, s.first, s.second);
+        p += s.second;
+        sizes.push_back(s.second);
+    }
+
+    Buffer dict(capacity);
+    size_t size = ZDICT_trainFromBuffer(dict, capacity, in, sizes.data(), unsigned(sizes.size()));
+    if (ZDICT_isError(size)) {
+        throw FailedLibraryCall("Zstd", "ZDICT_trainFromBuffer", ZDICT_getErrorName(size), Here());
+    }
+    dict.resize(size, true);
+
+    return dict;
+}
+
+size_t ZstdCompressor::compress(const void* in, size_t len, Buffer& out) const {
+    const size_t maxcompressed = ZSTD_compressBound(len);
+
+    if (out.size() < maxcompressed) {
+        out.resize(maxcompressed);
+    }
+
+    ZSTD_CCtx* cctx = compressionContext();
+
+    size_t compressed;
+    try {
+        ZSTD_CALL(ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, len >= threshold_ ? int(workers_) : 0));
+        compressed = ZSTD_CALL(ZSTD_compress2(cctx, out, out.size(), in, len));
+    }
+    catch (...) {
+        ZSTD_freeCCtx(cctx);
+        throw;
+    }
+
+    release(cctx);
+    return compressed;
+}
+
+void ZstdCompressor::uncompress(const void* in, size_t len, Buffer& out, size_t outlen) const {
+
+    if (out.size() < outlen) {
+        out.resize(outlen);
+    }
+
+    ZSTD_DCtx* dctx = decompressionContext();
+
+    size_t uncompressed;
+    try {
+        uncompressed = ZSTD_CALL(ZSTD_decompressDCtx(dctx, out, out.size(), in, len));
+    }
+    catch (...) {
+        ZSTD_freeDCtx(dctx);
+        throw;
+    }
+
+    release(dctx);
+
+    ASSERT(uncompressed == outlen);
+}
+
+CompressorBuilder<ZstdCompressor> zstd("zstd");
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit
@@ -0,0 +1,91 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#ifndef eckit_utils_ZstdCompressor_H
+#define eckit_utils_ZstdCompressor_H
+
+#include <utility>
+#include <vector>
+
+#include "eckit/thread/Mutex.h"
+#include "eckit/utils/Compressor.h"
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace eckit {
+
+class Buffer;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Zstandard compression
+///
+/// The compression and decompression contexts are created as needed and reused, so a ZstdCompressor should be kept
+/// for many calls; it can be shared between threads, each call using a context of its own. Buffers of at least
+/// `threshold` bytes are compressed by `workers` threads (if libzstd is multithreaded). A dictionary, trained on
+/// samples of the data, improves the compression of small, similar messages; the same dictionary must be used to
+/// uncompress.
+///
+/// Built by the factory as "zstd", configured by zstdCompressionLevel, zstdWorkers, zstdWorkersThreshold and
+/// zstdDictionary (a path), or ECKIT_ZSTD_COMPRESSION_LEVEL, ECKIT_ZSTD_WORKERS, ECKIT_ZSTD_WORKERS_THRESHOLD and
+/// ECKIT_ZSTD_DICTIONARY.
+class ZstdCompressor : public eckit::Compressor {
+
+public:  // types
+    using Samples = std::vector<std::pair<const void*, size_t>>;
+
+public:  // methods
+    ZstdCompressor();
+
+    explicit ZstdCompressor(int level, size_t workers = 0, size_t threshold = 8 * 1024 * 1024);
+
+    ~ZstdCompressor() override;
+
+    /// Use a dictionary for the following compressions and decompressions (not while other threads use the compressor)
+    void dictionary(const void* dict, size_t size);
+
+    /// Train a dictionary of up to `capacity` bytes on samples of the data to compress
+    static Buffer trainDictionary(const Samples& samples, size_t capacity = 112640);
+
+    int level() const { return level_; }
+
+    size_t compress(const void* in, size_t len, eckit::Buffer& out) const override;
+    void uncompress(const void* in, size_t len, eckit::Buffer& out, size_t outlen) const override;
+
+private:  // methods
+    void init();
+    void clear();
+
+    ZSTD_CCtx_s* compressionContext() const;
+    ZSTD_DCtx_s* decompressionContext() const;
+    void release(ZSTD_CCtx_s*) const;
+    void release(ZSTD_DCtx_s*) const;
+
+private:  // members
+    int level_;
+    size_t workers_;
+    size_t threshold_;
+
+    ZSTD_CDict_s* cdict_;
+    ZSTD_DDict_s* ddict_;
+
+    mutable eckit::Mutex mutex_;  //< protects the contexts not in use
+    mutable std::vector<ZSTD_CCtx_s*> cctxs_;
+    mutable std::vector<ZSTD_DCtx_s*> dctxs_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // end namespace eckit
+
+#endif
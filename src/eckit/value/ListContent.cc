@@ -9,6 +9,8 @@
  */
 
 
+#include <vector>
+
 #include "eckit/value/ListContent.h"
 #include "eckit/log/JSON.h"
 
@@ -26,6 +28,43 @@ ClassSpec ListContent::classSpec_ = {
 Reanimator<ListContent> ListContent::reanimator_;
 
 
+namespace {
+
+// Lists of integers, or of doubles, are sent as arrays
+
+template <typename V>
+bool encodeArray(Stream& s, const ValueList& values, bool (Value::*is)() const) {
+    std::vector<V> array;
+    array.reserve(values.size());
+    for (const Value& v : values) {
+        if (!(v.*is)()) {
+            return false;
+        }
+        array.push_back(v);
+    }
+    s.writeArray(array.data(), array.size());
+    return true;
+}
+
+template <typename V>
+bool decodeArray(Stream& s, ValueList& values) {
+    size_t count;
+    if (!s.startArray<V>(count)) {
+        return false;
+    }
+    std::vector<V> array(count);
+    s.readArray(array.data(), count);
+    values.reserve(count);
+    for (V v : array) {
+        values.push_back(Value(v));
+    }
+    return true;
+}
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
 ListContent::ListContent() {}
 
 ListContent::ListContent(const ValueList& v) {
@@ -38,6 +77,10 @@ ListContent::ListContent(const Value& v) {
 
 ListContent::ListContent(Stream& s) :
     Content(s) {
+    if (decodeArray<long long>(s, value_) || decodeArray<double>(s, value_)) {
+        return;
+    }
+
     long count;
     s >> count;
     for (int i = 0; i < count; i++) {
@@ -56,6 +99,11 @@ Content* ListContent::clone() const {
 
 void ListContent::encode(Stream& s) const {
     Content::encode(s);
+    if (Stream::writeArrays() && !value_.empty()
+        && (encodeArray<long long>(s, value_, &Value::isNumber) || encodeArray<double>(s, value_, &Value::isDouble))) {
+        return;
+    }
+
     long count = value_.size();
     s << count;
     for (int i = 0; i < count; ++i) {
@@ -0,0 +1,112 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+/// Many concurrent short-lived clients against tcp_server_reactor:
+///
+///     sandbox_tcp_load -host localhost -port 9013 -clients 1000 -connections 20 -requests 5
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/log/Log.h"
+#include "eckit/net/TCPClient.h"
+#include "eckit/net/TCPStream.h"
+#include "eckit/runtime/Application.h"
+#include "eckit/thread/AutoLock.h"
+#include "eckit/thread/Mutex.h"
+
+
+using namespace eckit;
+
+using Clock = std::chrono::steady_clock;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class LoadApp : public Application {
+public:
+    LoadApp(int argc, char** argv) :
+        Application(argc, argv, "HOME") {}
+
+private:
+    Mutex mutex_;
+    std::vector<double> latencies_;  ///< seconds from connecting to the last reply, per connection
+    size_t errors_ = 0;
+
+    void client(const std::string& host, int port, size_t connections, size_t requests) {
+        std::vector<double> latencies;
+        size_t errors = 0;
+
+        for (size_t i = 0; i < connections; ++i) {
+            Clock::time_point start = Clock::now();
+            try {
+                net::TCPClient c;
+                net::TCPStream s(c.connect(host, port));
+                for (size_t j = 0; j < requests; ++j) {
+                    std::string reply;
+                    s << "hello";
+                    s >> reply;
+                    ASSERT(reply == "hello");
+                }
+                s << "bye";
+                latencies.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+            }
+            catch (std::exception& e) {
+                Log::error() << "** " << e.what() << " Caught in " << Here() << std::endl;
+                errors++;
+            }
+        }
+
+        AutoLock<Mutex> lock(mutex_);
+        latencies_.insert(latencies_.end(), latencies.begin(), latencies.end());
+        errors_ += errors;
+    }
+
+    void run() override {
+
+        std::string host   = Resource<std::string>("-host", "localhost");
+        int port           = Resource<int>("-port", 9013);
+        size_t clients     = Resource<size_t>("-clients", 100);
+        size_t connections = Resource<size_t>("-connections", 10);
+        size_t requests    = Resource<size_t>("-requests", 1);
+
+        Clock::time_point start = Clock::now();
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < clients; ++i) {
+            threads.emplace_back([=] { client(host, port, connections, requests); });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::sort(latencies_.begin(), latencies_.end());
+        auto percentile = [this](double p) {
+            return latencies_.empty() ? 0 : latencies_[size_t(p * (latencies_.size() - 1))];
+        };
+
+        Log::info() << clients << " clients, " << latencies_.size() << " connections, " << errors_ << " errors in "
+                    << elapsed << "s, " << latencies_.size() / elapsed << " connections/s" << std::endl;
+        Log::info() << "Latency p50 " << percentile(0.5) * 1000 << "ms, p90 " << percentile(0.9) * 1000 << "ms, p99 "
+                    << percentile(0.99) * 1000 << "ms, max " << percentile(1) * 1000 << "ms" << std::endl;
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    LoadApp app(argc, argv);
+    app.start();
+    return 0;
+}
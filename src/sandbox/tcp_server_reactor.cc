@@ -0,0 +1,98 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <unistd.h>
+
+#include "eckit/config/Resource.h"
+#include "eckit/log/Log.h"
+#include "eckit/net/NetService.h"
+#include "eckit/net/NetUser.h"
+#include "eckit/net/SocketOptions.h"
+#include "eckit/runtime/Application.h"
+#include "eckit/serialisation/Stream.h"
+#include "eckit/thread/ThreadControler.h"
+
+
+using namespace eckit;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Echoes requests until "bye", the protocol of tcp_load
+class EchoUser : public net::NetUser {
+public:
+    EchoUser(net::TCPSocket& protocol) :
+        net::NetUser(protocol) {}
+
+private:
+    void serve(Stream& s, std::istream&, std::ostream&) override {
+        for (;;) {
+            std::string request;
+            s >> request;
+            if (request == "bye") {
+                break;
+            }
+            s << request;
+        }
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Run with -threaded to compare with a thread per connection
+class EchoService : public net::NetService {
+public:
+    EchoService(int port) :
+        net::NetService(port, true, net::SocketOptions::server().listenBacklog(1024)) {}
+
+private:
+    net::NetUser* newUser(net::TCPSocket& protocol) const override { return new EchoUser(protocol); }
+
+    std::string name() const override { return "echo"; }
+
+    bool preferToRunAsReactor() const override { return !Resource<bool>("-threaded", false); }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class EchoApp : public Application {
+public:
+    EchoApp(int argc, char** argv) :
+        Application(argc, argv, "HOME") {}
+
+private:
+    void run() override {
+
+        int port = Resource<int>("-port", 9013);
+
+        auto* service = new EchoService(port);
+        eckit::ThreadControler tc(service, false);
+        tc.start();
+
+        for (;;) {
+            ::sleep(10);
+            net::NetService::Statistics s = service->statistics();
+            Log::info() << "accepted " << s.accepted_ << ", active " << s.active_ << ", served " << s.served_
+                        << ", failed " << s.failed_ << ", limited " << s.limited_;
+            if (s.served_ + s.failed_) {
+                Log::info() << ", average wait " << s.waiting_ / (s.served_ + s.failed_) << "s, average service "
+                            << s.serving_ / (s.served_ + s.failed_) << "s";
+            }
+            Log::info() << std::endl;
+        }
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    EchoApp app(argc, argv);
+    app.start();
+    return 0;
+}
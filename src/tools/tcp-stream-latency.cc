@@ -0,0 +1,151 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+#include "eckit/log/Log.h"
+#include "eckit/log/Timer.h"
+#include "eckit/net/TCPClient.h"
+#include "eckit/net/TCPServer.h"
+#include "eckit/net/TCPStream.h"
+#include "eckit/option/CmdArgs.h"
+#include "eckit/option/SimpleOption.h"
+#include "eckit/runtime/Tool.h"
+
+using eckit::Log;
+using eckit::Stream;
+using eckit::net::TCPClient;
+using eckit::net::TCPServer;
+using eckit::net::TCPStream;
+
+/// Measures the latency of request/response exchanges of many small values over a local TCPStream, with and
+/// without buffering (see TCPStreamBuffer)
+class TCPStreamLatency : public eckit::Tool {
+public:
+    TCPStreamLatency(int argc, char** argv) :
+        Tool(argc, argv) {
+        options_.push_back(new eckit::option::SimpleOption<long>("trips", "number of round trips (default 200)"));
+        options_.push_back(
+            new eckit::option::SimpleOption<long>("count", "name/value pairs per request and reply (default 150)"));
+        options_.push_back(
+            new eckit::option::SimpleOption<long>("buffer", "size of the buffers, in bytes (default 65536)"));
+    }
+
+    void run() override;
+
+    std::vector<eckit::option::Option*> options_;
+};
+
+static void usage(const std::string& tool) {
+    Log::info() << "Usage: " << tool << " [-trips=N] [-count=N] [-buffer=BYTES]" << std::endl;
+}
+
+static void serve(TCPServer& server, size_t bufferSize) {
+    TCPStream s(server.accept());
+    s.buffered(bufferSize);
+
+    for (;;) {
+        std::string request;
+        s >> request;
+        if (request == "quit") {
+            break;
+        }
+
+        long count;
+        s >> count;
+
+        double sum = 0;
+        std::vector<std::string> names;
+        for (long i = 0; i < count; ++i) {
+            double value;
+            std::string name;
+            s >> value;
+            s >> name;
+            sum += value;
+            names.push_back(name);
+        }
+
+        s << request;
+        s << sum;
+        for (const auto& name : names) {
+            s << name;
+        }
+    }
+}
+
+static void roundTrip(Stream& s, long count) {
+    s << std::string("request");
+    s << count;
+    double sum = 0;
+    for (long i = 0; i < count; ++i) {
+        s << double(i);
+        s << "name-" + std::to_string(i);
+        sum += double(i);
+    }
+
+    std::string reply;
+    double replySum;
+    s >> reply;
+    s >> replySum;
+    ASSERT(replySum == sum);
+    for (long i = 0; i < count; ++i) {
+        std::string name;
+        s >> name;
+    }
+}
+
+/// @returns microseconds per round trip
+static double exchange(size_t bufferSize, long trips, long count) {
+    TCPServer server(0);
+    std::thread thread([&server, bufferSize] { serve(server, bufferSize); });
+
+    double elapsed;
+    {
+        TCPClient client;
+        TCPStream s(client.connect("localhost", server.localPort()));
+        s.buffered(bufferSize);
+
+        eckit::Timer timer("exchange", Log::debug());
+        for (long i = 0; i < trips; ++i) {
+            roundTrip(s, count);
+        }
+        elapsed = timer.elapsed();
+
+        s << "quit";
+        s.flush();
+    }
+
+    thread.join();
+    return elapsed * 1e6 / double(trips);
+}
+
+void TCPStreamLatency::run() {
+    eckit::option::CmdArgs args(&usage, options_, 0, 0);
+
+    long trips  = args.getLong("trips", 200);
+    long count  = args.getLong("count", 150);
+    long buffer = args.getLong("buffer", 64 * 1024);
+
+    double unbuffered = exchange(0, trips, count);
+    double buffered   = exchange(size_t(buffer), trips, count);
+
+    Log::info() << "Round trip of " << 2 * count << " values: unbuffered " << unbuffered << " us, buffered "
+                << buffered << " us" << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+    TCPStreamLatency tool(argc, argv);
+    return tool.start();
+}
@@ -0,0 +1,111 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "eckit/container/MPMCQueue.h"
+#include "eckit/container/Queue.h"
+#include "eckit/log/Timer.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define NELEMS 200000
+#define QSIZE 1024
+
+/// Push NELEMS elements through a queue with nthreads producers and nthreads consumers
+/// @returns elapsed time
+template <typename QUEUE>
+double benchmark_queue(size_t nthreads, size_t batch) {
+    QUEUE q(QSIZE);
+
+    const size_t perProducer = NELEMS / nthreads;
+    std::atomic<size_t> sum{0};
+    std::atomic<size_t> count{0};
+
+    Timer timer;
+
+    std::vector<std::thread> consumers;
+    for (size_t id = 0; id < nthreads; ++id) {
+        consumers.emplace_back([&q, &sum, &count, batch] {
+            std::vector<size_t> elems(batch);
+            size_t s = 0;
+            size_t c = 0;
+            for (long n; (n = q.pop(elems)) >= 0;) {
+                for (long i = 0; i < n; ++i) {
+                    s += elems[i];
+                }
+                c += size_t(n);
+            }
+            sum += s;
+            count += c;
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (size_t id = 0; id < nthreads; ++id) {
+        producers.emplace_back([&q, id, perProducer] {
+            for (size_t j = 0; j < perProducer; ++j) {
+                q.push(id * perProducer + j);
+            }
+        });
+    }
+
+    for (auto& p : producers) {
+        p.join();
+    }
+    q.close();
+
+    for (auto& c : consumers) {
+        c.join();
+    }
+
+    double elapsed = timer.elapsed();
+
+    const size_t n = perProducer * nthreads;
+    ASSERT(count == n);
+    ASSERT(sum == n * (n - 1) / 2);
+
+    return elapsed;
+}
+
+CASE("benchmark_queue_contention") {
+    std::cout << std::setw(8) << "threads" << std::setw(8) << "batch" << std::setw(14) << "Queue [s]"
+              << std::setw(14) << "MPMCQueue [s]" << std::setw(10) << "speedup" << std::endl;
+
+    for (size_t nthreads : {1, 2, 4, 8, 16, 32, 64}) {
+        for (size_t batch : {1, 16}) {
+            double locked   = benchmark_queue<Queue<size_t>>(nthreads, batch);
+            double lockfree = benchmark_queue<MPMCQueue<size_t>>(nthreads, batch);
+
+            std::cout << std::setw(8) << nthreads << std::setw(8) << batch << std::setw(14) << locked
+                      << std::setw(14) << lockfree << std::setw(10) << locked / lockfree << std::endl;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -8,6 +8,7 @@
  * does it submit to any jurisdiction.
  */
 
+#include "eckit/container/MPMCQueue.h"
 #include "eckit/container/Queue.h"
 #include "eckit/log/Log.h"
 #include "eckit/testing/Test.h"
@@ -80,6 +81,99 @@ CASE("Multi Producer Multi Consumer Queue access size = 1") {
     }
 }
 
+CASE("Lock-free Multi Producer Multi Consumer Queue") {
+
+    const size_t nprod = 13;
+    const size_t ncons = 7;
+    const int count    = 1000;
+
+    for (size_t depth : {1, 3, 64}) {
+        eckit::MPMCQueue<int> q(depth);
+        EXPECT(q.maxSize() >= depth);
+
+        std::vector<std::thread> producers;
+        for (int id = 0; id < int(nprod); ++id) {
+            producers.emplace_back([&q, id, count] {
+                for (int j = 0; j < count; ++j) {
+                    q.push(count * id + j);
+                }
+            });
+        }
+
+        std::mutex mutex;
+        std::vector<int> popped;
+
+        std::vector<std::thread> consumers;
+        for (size_t id = 0; id < ncons; ++id) {
+            consumers.emplace_back([&, id] {
+                std::vector<int> mine;
+                std::vector<int> batch(id % 2 == 0 ? 1 : 5);
+                for (;;) {
+                    long n = q.pop(batch);
+                    if (n < 0) {
+                        break;
+                    }
+                    mine.insert(mine.end(), batch.begin(), batch.begin() + n);
+                }
+                std::lock_guard<std::mutex> locker(mutex);
+                popped.insert(popped.end(), mine.begin(), mine.end());
+            });
+        }
+
+        for (auto& p : producers) {
+            p.join();
+        }
+        q.close();
+
+        for (auto& c : consumers) {
+            c.join();
+        }
+
+        // every element popped exactly once
+        EXPECT_EQUAL(popped.size(), nprod * count);
+        std::sort(popped.begin(), popped.end());
+        for (size_t i = 0; i < popped.size(); ++i) {
+            EXPECT_EQUAL(popped[i], int(i));
+        }
+        EXPECT(q.empty());
+    }
+}
+
+CASE("Lock-free queue close and interrupt") {
+
+    eckit::MPMCQueue<std::string> q(4);
+    EXPECT(q.maxSize() == 4);
+
+    q.push("a");
+    q.emplace(3, 'b');
+    EXPECT(q.size() == 2);
+
+    // elements pushed before closing can be popped
+    q.close();
+    EXPECT(q.closed());
+    EXPECT_THROWS_AS(q.push("c"), AssertionFailed);
+
+    std::string e;
+    EXPECT(q.pop(e) == 1);
+    EXPECT_EQUAL(e, "a");
+    EXPECT(q.pop(e) == 0);
+    EXPECT_EQUAL(e, "bbb");
+    EXPECT(q.pop(e) == -1);
+
+    // waiting consumers see the interruption
+    eckit::MPMCQueue<int> r(2);
+    std::thread consumer([&r] {
+        int i;
+        EXPECT_THROWS_AS(r.pop(i), SeriousBug);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    r.interrupt(std::make_exception_ptr(SeriousBug("interrupted")));
+    consumer.join();
+
+    EXPECT(r.closed());
+    EXPECT_THROWS_AS(r.push(1), SeriousBug);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
@@ -8,6 +8,7 @@
  * does it submit to any jurisdiction.
  */
 
+#include <fstream>
 #include <list>
 
 #include "eckit/container/KDTree.h"
@@ -354,6 +355,214 @@ CASE("test_kdtree_mapped") {
     }
 }
 
+CASE("test_kdtree_mapped_layout") {
+    using Tree  = KDTreeMapped<TestTreeTrait>;
+    using Point = Tree::PointType;
+
+    std::vector<Tree::Value> points;
+    for (size_t i = 0; i < 5000; ++i) {
+        points.emplace_back(Point(double((i * 7919) % 1009), double((i * 104729) % 997)), double(i));
+    }
+
+    std::vector<Point> queries;
+    for (size_t i = 0; i < 200; ++i) {
+        queries.emplace_back(double((i * 389) % 1013) + 0.25, double((i * 883) % 1019) - 0.5);
+    }
+
+    auto passTest = [&](Tree& kd) -> bool {
+        for (const auto& q : queries) {
+            auto nn = kd.kNearestNeighbours(q, 4);
+            auto bf = kd.kNearestNeighboursBruteForce(q, 4);
+            if (nn.size() != bf.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < nn.size(); ++i) {
+                if (nn[i].distance() != bf[i].distance()) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    for (auto layout : {KDMapped::CREATION_ORDER, KDMapped::VAN_EMDE_BOAS}) {
+        eckit::PathName path("test_kdtree_mapped_layout.kdtree");
+        if (path.exists()) {
+            path.unlink();
+        }
+
+        {
+            Tree kd(path, points.size(), 0, layout);
+            kd.build(points);
+            EXPECT_EQUAL(kd.size(), points.size());
+            EXPECT(passTest(kd));
+        }
+
+        {
+            Tree kd(path, 0, 0);
+            EXPECT_EQUAL(kd.size(), points.size());
+            EXPECT(passTest(kd));
+        }
+    }
+
+    // files written before the header was versioned
+    {
+        eckit::PathName path("test_kdtree_mapped_layout.kdtree");
+        if (path.exists()) {
+            path.unlink();
+        }
+
+        {
+            Tree kd(path, points.size(), 0);
+            kd.build(points);
+        }
+
+        // an unversioned header is shorter, with the nodes starting at the same offset (if nodes are large enough)
+        ASSERT(sizeof(Tree::Node) >= sizeof(KDMappedHeader));
+        {
+            size_t headerSize = KDMappedHeader::HEADER_SIZE_V0;
+            std::fstream f(path.localPath(), std::ios::in | std::ios::out | std::ios::binary);
+            f.write(reinterpret_cast<const char*>(&headerSize), sizeof(headerSize));
+        }
+
+        {
+            Tree kd(path, 0, 0);
+            EXPECT_EQUAL(kd.size(), points.size());
+            EXPECT(passTest(kd));
+        }
+
+        path.unlink();
+    }
+}
+
+CASE("test_kdtree_build_large") {
+    using Tree  = KDTreeMemory<TestTreeTrait>;
+    using Point = Tree::PointType;
+
+    // large enough for subtrees to be built concurrently
+    std::vector<Tree::Value> points;
+    for (size_t i = 0; i < 100000; ++i) {
+        points.emplace_back(Point(double((i * 7919) % 1009), double((i * 104729) % 997) + 0.001 * double(i % 13)),
+                            double(i));
+    }
+
+    Tree kd;
+    kd.build(points);
+    EXPECT_EQUAL(kd.size(), points.size());
+
+    // nodes from insert coexist with nodes from build
+    kd.insert(Tree::Value(Point(-1., -1.), -1.));
+    EXPECT_EQUAL(kd.size(), points.size() + 1);
+
+    for (const auto& p : {Point(0., 0.), Point(500.5, 250.25), Point(-2., -2.), Point(2000., 10.)}) {
+        EXPECT(kd.nearestNeighbour(p).point() == kd.nearestNeighbourBruteForce(p).point());
+
+        auto nn = kd.kNearestNeighbours(p, 5);
+        auto bf = kd.kNearestNeighboursBruteForce(p, 5);
+        EXPECT_EQUAL(nn.size(), bf.size());
+        for (size_t i = 0; i < nn.size(); ++i) {
+            EXPECT(nn[i].distance() == bf[i].distance());
+        }
+    }
+}
+
+CASE("test_kdtree_batch_queries") {
+    using Tree  = KDTreeMemory<TestTreeTrait>;
+    using Point = Tree::PointType;
+
+    std::vector<Tree::Value> points;
+    for (size_t i = 0; i < 20000; ++i) {
+        points.emplace_back(Point(double((i * 7919) % 1009), double((i * 104729) % 997)), double(i));
+    }
+
+    Tree kd;
+    kd.build(points);
+
+    std::vector<Point> queries;
+    for (size_t i = 0; i < 3000; ++i) {
+        queries.emplace_back(double((i * 389) % 1013) + 0.25, double((i * 883) % 1019) - 0.5);
+    }
+
+    for (bool sort : {false, true}) {
+        const size_t k = 7;
+        std::vector<Tree::NodeInfo> nn(queries.size() * k);
+        kd.kNearestNeighbours(queries.begin(), queries.end(), k, nn.data(), sort);
+
+        std::vector<size_t> offsets;
+        Tree::NodeList found;
+        const double radius = 6.;
+        kd.findInSphere(queries.begin(), queries.end(), radius, offsets, found, sort);
+        EXPECT_EQUAL(offsets.size(), queries.size() + 1);
+        EXPECT_EQUAL(offsets.back(), found.size());
+
+        for (size_t i = 0; i < queries.size(); ++i) {
+            auto ref = kd.kNearestNeighbours(queries[i], k);
+            EXPECT_EQUAL(ref.size(), k);
+            for (size_t j = 0; j < k; ++j) {
+                EXPECT(nn[i * k + j].distance() == ref[j].distance());
+            }
+
+            ref = kd.findInSphere(queries[i], radius);
+            EXPECT_EQUAL(offsets[i + 1] - offsets[i], ref.size());
+            for (size_t j = 0; j < ref.size(); ++j) {
+                EXPECT(found[offsets[i] + j].distance() == ref[j].distance());
+            }
+        }
+    }
+
+    // fewer points than neighbours requested
+    Tree small;
+    small.build(points.begin(), points.begin() + 3);
+    std::vector<Tree::NodeInfo> nn(2 * 5);
+    small.kNearestNeighbours(queries.begin(), queries.begin() + 2, 5, nn.data());
+    EXPECT(nn[2].node_ != nullptr);
+    EXPECT(nn[3].node_ == nullptr);
+    EXPECT(nn[9].node_ == nullptr);
+}
+
+CASE("test_kdtree_batch_queries_throw") {
+    using Tree  = KDTreeMemory<TestTreeTrait>;
+    using Point = Tree::PointType;
+
+    // Query points, one of which fails
+    struct Queries {
+        const Point* points_;
+        size_t failing_;
+        const Point& operator[](size_t i) const {
+            if (i == failing_) {
+                throw BadValue("failing query");
+            }
+            return points_[i];
+        }
+        std::ptrdiff_t operator-(const Queries& other) const { return points_ - other.points_; }
+    };
+
+    std::vector<Tree::Value> points;
+    std::vector<Point> queries;
+    for (size_t i = 0; i < 1000; ++i) {
+        points.emplace_back(Point(double((i * 7919) % 1009), double((i * 104729) % 997)), double(i));
+        queries.emplace_back(double((i * 389) % 1013), double((i * 883) % 1019));
+    }
+
+    Tree kd;
+    kd.build(points);
+
+    Queries begin{queries.data(), 500};
+    Queries end{queries.data() + queries.size(), 500};
+
+    std::vector<Tree::NodeInfo> nn(queries.size());
+    EXPECT_THROWS_AS(kd.kNearestNeighbours(begin, end, 1, nn.data(), false), BadValue);
+    EXPECT(kd.alloc_.statsEnabled());
+
+    // ordering the queries fails
+    EXPECT_THROWS_AS(kd.kNearestNeighbours(begin, end, 1, nn.data()), BadValue);
+
+    std::vector<size_t> offsets;
+    Tree::NodeList found;
+    EXPECT_THROWS_AS(kd.findInSphere(begin, end, 6., offsets, found, false), BadValue);
+    EXPECT(kd.alloc_.statsEnabled());
+}
+
 CASE("test_kdtree_iterate_empty") {
     using Tree = KDTreeMemory<TestTreeTrait>;
 
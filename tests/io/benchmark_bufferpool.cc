@@ -0,0 +1,91 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/io/BufferPool.h"
+#include "eckit/log/Timer.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#define NBYTES (size_t(2) << 30)
+
+/// Each of nthreads threads takes, fills and returns buffers of `size` bytes, until NBYTES are transferred in total
+/// (as AsyncHandle or DblBuffer do for each transfer)
+/// @returns elapsed time
+template <typename ALLOCATE>
+double benchmark_buffers(size_t nthreads, size_t size, ALLOCATE allocate) {
+    const size_t count = std::max<size_t>(NBYTES / size / nthreads, 1);
+
+    Timer timer;
+
+    std::vector<std::thread> threads;
+    for (size_t id = 0; id < nthreads; ++id) {
+        threads.emplace_back([count, size, &allocate] {
+            for (size_t i = 0; i < count; ++i) {
+                auto buffer = allocate(size);
+                ::memset(buffer.data(), int(i), size);
+            }
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    return timer.elapsed();
+}
+
+CASE("benchmark_bufferpool") {
+    BufferPool unretained(0, 0);
+    BufferPool retained(0, 64 * 1024 * 1024, 64, false, 16 * 1024 * 1024);
+
+    // speedups of the default pool over Buffer (the allocator), and over a pool retaining nothing
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "size" << std::setw(14) << "Buffer [s]"
+              << std::setw(14) << "no reuse [s]" << std::setw(14) << "default [s]" << std::setw(12) << "vs Buffer"
+              << std::setw(12) << "vs no reuse" << std::endl;
+
+    for (size_t nthreads : {1, 4}) {
+        for (size_t size : {64 * 1024, 1024 * 1024, 10 * 1024 * 1024}) {
+            double buffer = benchmark_buffers(nthreads, size, [](size_t n) { return Buffer(n); });
+            double none   = benchmark_buffers(nthreads, size, [&](size_t n) { return PooledBuffer(n, unretained); });
+            double pooled = benchmark_buffers(nthreads, size, [&](size_t n) { return PooledBuffer(n, retained); });
+
+            std::cout << std::setw(8) << nthreads << std::setw(12) << size << std::setw(14) << buffer
+                      << std::setw(14) << none << std::setw(14) << pooled << std::setw(12) << buffer / pooled
+                      << std::setw(12) << none / pooled << std::endl;
+        }
+    }
+
+    auto s = retained.statistics();
+    std::cout << s << std::endl;
+    EXPECT(s.reuseRatio() > 0.9);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,216 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "eckit/io/AsyncHandle.h"
+#include "eckit/io/BufferPool.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Buffers are recycled by size class") {
+    BufferPool pool(0, 1024 * 1024);
+
+    char* first = nullptr;
+    {
+        PooledBuffer b(5000, pool);
+        EXPECT(b.size() == 5000);
+        EXPECT(b.capacity() == 8192);
+        EXPECT(reinterpret_cast<uintptr_t>(b.data()) % 64 == 0);
+        ::memset(b.data(), 1, b.capacity());
+        first = b;
+    }
+
+    {
+        PooledBuffer b(8000, pool);
+        EXPECT(b.capacity() == 8192);
+        EXPECT(static_cast<char*>(b) == first);
+
+        // other size class
+        PooledBuffer c(100, pool);
+        EXPECT(c.capacity() == 4096);
+
+        // moved buffers are returned once
+        PooledBuffer d(std::move(c));
+        EXPECT(c.data() == nullptr);
+        d = std::move(b);
+    }
+
+    auto s = pool.statistics();
+    EXPECT(s.acquired_ == 3);
+    EXPECT(s.reused_ == 1);
+    EXPECT(s.allocated_ == 2);
+    EXPECT(s.inUse_ == 0);
+    EXPECT(s.retained_ == 8192 + 4096);
+    EXPECT(s.reuseRatio() > 0.3);
+
+    pool.purge();
+    EXPECT(pool.statistics().retained_ == 0);
+    EXPECT(pool.statistics().freed_ == 2);
+}
+
+CASE("Retained memory is bounded") {
+    BufferPool pool(0, 10000);
+
+    {
+        PooledBuffer a(4096, pool);
+        PooledBuffer b(4096, pool);
+        PooledBuffer c(4096, pool);
+    }
+
+    auto s = pool.statistics();
+    EXPECT(s.retained_ == 8192);
+    EXPECT(s.freed_ == 1);
+
+    // not pooled
+    {
+        PooledBuffer large((size_t(1) << 30) + 1, pool);
+        EXPECT(large.capacity() == large.size());
+    }
+    EXPECT(pool.statistics().retained_ == 8192);
+}
+
+CASE("Capacity applies back-pressure") {
+    BufferPool pool(3 * 4096, 0);
+
+    PooledBuffer a(4096, pool);
+    PooledBuffer b(4096, pool);
+    PooledBuffer c(4096, pool);
+
+    std::atomic<bool> acquired{false};
+    std::thread t([&] {
+        PooledBuffer d(4096, pool);
+        acquired = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT(!acquired);
+
+    a.reset();
+    t.join();
+    EXPECT(acquired);
+    EXPECT(pool.statistics().waits_ == 1);
+
+    // a single request larger than the capacity does not wait forever
+    b.reset();
+    c.reset();
+    PooledBuffer large(5 * 4096, pool);
+    EXPECT(large.size() == 5 * 4096);
+}
+
+CASE("Capacity applies to buffers released by other threads") {
+    BufferPool pool(2 * 4096, 0);
+
+    PooledBuffer a(4096, pool);
+    PooledBuffer b(4096, pool);
+
+    // e.g. AsyncHandle, whose writer thread releases the buffers
+    std::thread writer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        a.reset();
+    });
+
+    PooledBuffer c(4096, pool);
+    writer.join();
+    EXPECT(pool.statistics().waits_ == 1);
+    EXPECT(pool.statistics().inUse_ == 2 * 4096);
+}
+
+CASE("Acquiring without waiting") {
+    BufferPool pool(2 * 4096, 0);
+
+    // e.g. a read-ahead window, released by the thread that fills it
+    PooledBuffer a(4096, pool);
+    PooledBuffer b(4096, pool);
+    PooledBuffer c(4096, BufferPool::Wait::No, pool);
+    EXPECT(pool.statistics().waits_ == 0);
+    EXPECT(pool.statistics().inUse_ == 3 * 4096);
+}
+
+CASE("Nothing is retained by default") {
+    BufferPool pool;
+    {
+        PooledBuffer b(4096, pool);
+    }
+    EXPECT(pool.statistics().retained_ == 0);
+    EXPECT(pool.statistics().freed_ == 1);
+}
+
+CASE("The eckit pool retains buffers of up to 16 MiB by default") {
+    BufferPool& pool = BufferPool::instance();
+    pool.purge();
+
+    {
+        PooledBuffer small(64 * 1024);
+        PooledBuffer large(32 * 1024 * 1024);
+    }
+    auto s = pool.statistics();
+    EXPECT(s.retained_ == 64 * 1024);
+
+    {
+        PooledBuffer small(64 * 1024);
+    }
+    EXPECT(pool.statistics().reused_ == s.reused_ + 1);
+
+    pool.purge();
+}
+
+CASE("Huge pages") {
+    BufferPool pool(0, 64 * 1024 * 1024, 64, true);
+    PooledBuffer b(3 * 1024 * 1024, pool);
+    EXPECT(b.capacity() == 4 * 1024 * 1024);
+    ::memset(b.data(), 0, b.capacity());
+}
+
+CASE("AsyncHandle draws buffers from the pool") {
+    std::vector<char> data(1024 * 1024);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = char(i * 7);
+    }
+
+    auto before = BufferPool::instance().statistics();
+
+    MemoryHandle out(data.size());
+    {
+        AsyncHandle h(out, 256 * 1024, 4096);
+        h.openForWrite(0);
+        for (size_t i = 0; i < data.size(); i += 10000) {
+            long n = long(std::min<size_t>(10000, data.size() - i));
+            EXPECT(h.write(data.data() + i, n) == n);
+        }
+        h.close();
+    }
+
+    auto after = BufferPool::instance().statistics();
+    EXPECT(after.acquired_ - before.acquired_ == 105);
+    EXPECT(after.reused_ - before.reused_ > 50);
+
+    EXPECT(::memcmp(out.data(), data.data(), data.size()) == 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,168 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+#include <vector>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/CompressedHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/utils/Compressor.h"
+#include "eckit/testing/Test.h"
+#include "util.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<std::string> compressors() {
+    std::vector<std::string> result;
+    for (const std::string& name : {"none", "snappy", "lz4", "bzip2"}) {
+        if (CompressorFactory::instance().has(name)) {
+            result.push_back(name);
+        }
+    }
+    return result;
+}
+
+std::vector<char> compress(const std::vector<char>& data, const std::string& compressor, size_t blockSize,
+                           size_t threads, long chunk) {
+    MemoryHandle out;
+    {
+        CompressedHandle h(out, compressor, blockSize, threads);
+        h.openForWrite(0);
+        AutoClose closer(h);
+        for (size_t i = 0; i < data.size(); i += chunk) {
+            long n = long(std::min<size_t>(chunk, data.size() - i));
+            EXPECT(h.write(data.data() + i, n) == n);
+        }
+        EXPECT(h.position() == Offset(data.size()));
+    }
+    const char* p = static_cast<const char*>(out.data());
+    return std::vector<char>(p, p + size_t(out.size()));
+}
+
+/// A handle that cannot seek, such as a socket
+class StreamHandle : public MemoryHandle {
+public:
+    StreamHandle(const std::vector<char>& data) :
+        MemoryHandle(data.data(), data.size()) {}
+    bool canSeek() const override { return false; }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("CompressedHandle round trips") {
+    auto data = makeData(1000003);
+
+    for (const auto& compressor : compressors()) {
+        for (size_t threads : {1, 4}) {
+            for (long chunk : {1000, 65536, 1000003}) {
+                auto compressed = compress(data, compressor, 65536, threads, chunk);
+
+                CompressedHandle h(new MemoryHandle(compressed.data(), compressed.size()));
+                EXPECT(h.openForRead() == Length(data.size()));
+                AutoClose closer(h);
+                EXPECT(h.compressor() == compressor);
+
+                std::vector<char> out;
+                std::vector<char> buffer(chunk);
+                for (long n; (n = h.read(buffer.data(), chunk)) > 0;) {
+                    out.insert(out.end(), buffer.begin(), buffer.begin() + n);
+                }
+
+                EXPECT(out == data);
+                EXPECT(h.read(buffer.data(), chunk) == 0);
+            }
+        }
+    }
+}
+
+CASE("CompressedHandle empty stream") {
+    std::vector<char> data;
+    auto compressed = compress(data, "none", 1024, 2, 100);
+
+    CompressedHandle h(new MemoryHandle(compressed.data(), compressed.size()));
+    EXPECT(h.openForRead() == Length(0));
+    char c;
+    EXPECT(h.read(&c, 1) == 0);
+    h.close();
+}
+
+CASE("CompressedHandle random access") {
+    auto data       = makeData(300000);
+    auto compressed = compress(data, "none", 10000, 3, 4096);
+
+    CompressedHandle h(new MemoryHandle(compressed.data(), compressed.size()), "", 10000, 3);
+    h.openForRead();
+    AutoClose closer(h);
+
+    EXPECT(h.canSeek());
+
+    std::vector<char> buffer(25000);
+
+    auto check = [&](long long offset, long length) {
+        EXPECT(h.position() == Offset(offset));
+        EXPECT(h.read(buffer.data(), length) == length);
+        EXPECT(std::equal(buffer.begin(), buffer.begin() + length, data.begin() + offset));
+    };
+
+    check(0, 100);
+
+    // within the blocks decompressed ahead, then far forward, backwards, across blocks
+    h.seek(20500);
+    check(20500, 100);
+    h.seek(250000);
+    check(250000, 25000);
+    h.seek(15);
+    check(15, 25000);
+    h.skip(9985);
+    check(35000, 1000);
+
+    h.rewind();
+    check(0, 100);
+
+    h.seek(data.size());
+    EXPECT(h.read(buffer.data(), 100) == 0);
+    h.seek(data.size() - 50);
+    EXPECT(h.read(buffer.data(), 100) == 50);
+}
+
+CASE("CompressedHandle reads streams that cannot seek") {
+    auto data       = makeData(100000);
+    auto compressed = compress(data, "none", 4096, 2, 10000);
+
+    CompressedHandle h(new StreamHandle(compressed));
+    EXPECT(h.openForRead() == Length(0));
+    AutoClose closer(h);
+
+    std::vector<char> buffer(1000);
+    h.skip(50000);
+    EXPECT(h.read(buffer.data(), 1000) == 1000);
+    EXPECT(std::equal(buffer.begin(), buffer.end(), data.begin() + 50000));
+}
+
+CASE("CompressedHandle rejects other data") {
+    auto data = makeData(1000);
+    CompressedHandle h(new MemoryHandle(data.data(), data.size()));
+    EXPECT_THROWS_AS(h.openForRead(), BadValue);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -94,6 +94,24 @@ public:
     PathName path3_;
 };
 
+/// Fails when read, after the data of the handles before it
+class FailingHandle : public MemoryHandle {
+public:
+    FailingHandle() :
+        MemoryHandle(buf1, sizeof(buf1) - 1) {}
+    long read(void*, long) override { throw ReadError("FailingHandle"); }
+};
+
+std::string readAll(DataHandle& dh, long chunk) {
+    std::string result;
+    Buffer buff(chunk);
+    long n;
+    while ((n = dh.read(buff, chunk)) > 0) {
+        result.append(buff, n);
+    }
+    return result;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 CASE("Multihandle") {
@@ -373,6 +391,116 @@ CASE("Multihandle") {
     }
 }
 
+CASE("Multihandle prefetch") {
+
+    Tester test;
+
+    OffsetList ol1 = {0, 2, 6, 13, 23};
+    LengthList ll1 = {1, 2, 4, 6, 8};
+    OffsetList ol2 = {2, 4, 8, 16, 32};
+    LengthList ll2 = {1, 2, 4, 8, 16};
+
+    auto build = [&](MultiHandle& mh) {
+        for (int i = 0; i < 10; i++) {
+            mh += new PartFileHandle(test.path1_, ol1, ll1);
+            mh += new MemoryHandle(0);
+            mh += new FileHandle(test.path2_);
+            mh += new PartFileHandle(test.path3_, ol2, ll2);
+        }
+    };
+
+    MultiHandle sequential;
+    build(sequential);
+    sequential.prefetch(0);
+    sequential.openForRead();
+    const std::string expect = readAll(sequential, 1000);
+    sequential.close();
+
+    EXPECT(expect.size() == size_t(10 * (21 + 0 + 62 + 31)));
+
+    SECTION("Data is read in order") {
+        // Buffers smaller than the handles, so that the reading tasks wait for the consumer
+        for (size_t count : {1, 3, 100}) {
+            for (size_t bufferSize : {1, 5, 4096}) {
+                for (long chunk : {1, 7, 1000}) {
+                    MultiHandle mh;
+                    build(mh);
+                    mh.prefetch(count, bufferSize);
+                    EXPECT(mh.openForRead() == Length(expect.size()));
+                    EXPECT(readAll(mh, chunk) == expect);
+                    EXPECT(mh.position() == Offset(expect.size()));
+                    mh.close();
+                }
+            }
+        }
+    }
+
+    SECTION("Seek, skip, position and rewind") {
+        MultiHandle mh;
+        build(mh);
+        mh.prefetch(2, 5);
+        mh.openForRead();
+
+        Buffer buff = Tester::makeBuffer();
+
+        for (long long offset : {10, 100, 21, 0, 83, 500, 1139}) {
+            EXPECT_NO_THROW(mh.seek(offset));
+            EXPECT(mh.position() == Offset(offset));
+            long r = mh.read(buff, 20);
+            EXPECT(r == std::min<long>(20, expect.size() - offset));
+            EXPECT(std::string(buff, r) == expect.substr(offset, r));
+            EXPECT(mh.position() == Offset(offset + r));
+        }
+
+        EXPECT_THROWS_AS(mh.seek(expect.size() + 1), AssertionFailed);  // Seek beyond EOF throws
+        EXPECT(mh.read(buff, 10) == 0);
+
+        mh.seek(30);
+        EXPECT_NO_THROW(mh.skip(40));
+        EXPECT(mh.position() == Offset(70));
+        EXPECT(readAll(mh, 3) == expect.substr(70));
+
+        mh.rewind();
+        EXPECT(mh.position() == Offset(0));
+        EXPECT(readAll(mh, 11) == expect);
+
+        mh.close();
+    }
+
+    SECTION("Errors are reported in order") {
+        MultiHandle mh;
+        mh += new FileHandle(test.path1_);
+        mh += new FileHandle(test.path2_);
+        mh += new FailingHandle();
+        mh += new FileHandle(test.path3_);
+        mh.prefetch(3, 10);
+        mh.openForRead();
+
+        Buffer buff(31 * 3);
+        EXPECT(mh.read(buff, 31 * 3) == 31 * 3);
+        EXPECT_THROWS_AS(mh.read(buff, 1), ReadError);
+        mh.close();
+    }
+
+    SECTION("Data read before an error is returned") {
+        MultiHandle mh;
+        mh += new FileHandle(test.path1_);
+        mh += new FileHandle(test.path2_);
+        mh += new FailingHandle();
+        mh += new FileHandle(test.path3_);
+        mh.prefetch(3, 10);
+        mh.openForRead();
+
+        // Across the failure point, the good bytes are returned first
+        Buffer buff(200);
+        EXPECT(mh.read(buff, 50) == 50);
+        EXPECT(mh.read(buff, 200) == 31 * 3 - 50);
+        EXPECT(mh.position() == Offset(31 * 3));
+        EXPECT_THROWS_AS(mh.read(buff, 1), ReadError);
+        mh.close();
+    }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
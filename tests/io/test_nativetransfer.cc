@@ -0,0 +1,244 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <unistd.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/BufferPool.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/io/NativeTransfer.h"
+#include "eckit/io/PartFileHandle.h"
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class Tester {
+public:
+    Tester(size_t size) :
+        data_(size) {
+        std::string base = Resource<std::string>("$TMPDIR", "/tmp");
+        in_              = PathName::unique(base + "/native") + ".in";
+        out_             = PathName::unique(base + "/native") + ".out";
+
+        for (size_t i = 0; i < size; ++i) {
+            data_[i] = char(i * 13 + i / 251);
+        }
+
+        FileHandle f(in_);
+        f.openForWrite(0);
+        AutoClose closer(f);
+        f.write(data_.data(), long(size));
+    }
+
+    ~Tester() {
+        for (auto& p : {in_, out_}) {
+            if (p.exists()) {
+                p.unlink(false);
+            }
+        }
+    }
+
+    std::vector<char> output() const {
+        std::vector<char> out(size_t(out_.size()));
+        FileHandle f(out_);
+        f.openForRead();
+        AutoClose closer(f);
+        EXPECT(f.read(out.data(), long(out.size())) == long(out.size()));
+        return out;
+    }
+
+    std::vector<char> data_;
+    PathName in_;
+    PathName out_;
+};
+
+/// Counts the bytes, and whether the data was seen
+struct Counter : public TransferWatcher {
+    Counter(bool needsData) :
+        needsData_(needsData) {}
+    void watch(const void* data, long length) override {
+        bytes_ += length;
+        (data ? buffered_ : native_) += length;
+    }
+    bool needsData() const override { return needsData_; }
+
+    bool needsData_;
+    long bytes_    = 0;
+    long native_   = 0;
+    long buffered_ = 0;
+};
+
+/// Reads from a pipe, exposing its read end as a stream descriptor
+class PipeHandle : public DataHandle {
+public:
+    PipeHandle(int fd) :
+        fd_(fd) {}
+    ~PipeHandle() override { ::close(fd_); }
+
+    void print(std::ostream& s) const override { s << "PipeHandle[" << fd_ << "]"; }
+    Length openForRead() override { return 0; }
+    long read(void* buffer, long length) override { return ::read(fd_, buffer, size_t(length)); }
+    void close() override {}
+
+    int nativeReadFd(off_t& offset, long long& length) override {
+        offset = -1;
+        length = -1;
+        return fd_;
+    }
+
+private:
+    int fd_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("File to file, with and without native transfers") {
+
+    Tester test(5 * 1024 * 1024 + 1234);
+
+    for (bool needsData : {false, true}) {
+        Counter watcher(needsData);
+        FileHandle in(test.in_);
+        FileHandle out(test.out_);
+
+        EXPECT(in.saveInto(out, watcher) == Length(test.data_.size()));
+        EXPECT(test.output() == test.data_);
+        EXPECT(watcher.bytes_ == long(test.data_.size()));
+        EXPECT((needsData ? watcher.buffered_ : watcher.native_) == watcher.bytes_);
+    }
+}
+
+CASE("Native transfers to the end do not take a buffer") {
+
+    Tester test(3 * 1024 * 1024 + 17);
+
+    size_t acquired = BufferPool::instance().statistics().acquired_;
+
+    {
+        Counter watcher(false);
+        FileHandle in(test.in_);
+        FileHandle out(test.out_);
+        EXPECT(in.saveInto(out, watcher) == Length(test.data_.size()));
+        EXPECT(watcher.native_ == long(test.data_.size()));
+    }
+
+    {
+        Counter watcher(false);
+        FileHandle in(test.in_);
+        FileHandle out(test.out_);
+        EXPECT(in.copyTo(out, 1024 * 1024, -1, watcher) == Length(test.data_.size()));
+        EXPECT(watcher.native_ == long(test.data_.size()));
+    }
+
+    EXPECT(test.output() == test.data_);
+    EXPECT(BufferPool::instance().statistics().acquired_ == acquired);
+}
+
+CASE("copyTo from parts of a file, with a maximum size") {
+
+    Tester test(1024 * 1024);
+
+    OffsetList offset{500000, 10, 200000};
+    LengthList length{300000, 1000, 123456};
+
+    std::vector<char> expected;
+    for (size_t i = 0; i < offset.size(); ++i) {
+        auto begin = test.data_.begin() + (long long)offset[i];
+        expected.insert(expected.end(), begin, begin + (long long)length[i]);
+    }
+
+    SECTION("all parts") {
+        PartFileHandle in(test.in_, offset, length);
+        FileHandle out(test.out_);
+        Counter watcher(false);
+
+        EXPECT(in.copyTo(out, 65536, -1, watcher) == Length(expected.size()));
+        EXPECT(test.output() == expected);
+        EXPECT(watcher.native_ == long(expected.size()));
+    }
+
+    SECTION("up to a maximum size") {
+        PartFileHandle in(test.in_, offset, length);
+        FileHandle out(test.out_);
+
+        EXPECT(in.copyTo(out, 65536, 300500) == Length(300500));
+        EXPECT(test.output() == std::vector<char>(expected.begin(), expected.begin() + 300500));
+    }
+}
+
+CASE("Append falls back to buffered copies") {
+
+    Tester test(100000);
+
+    {
+        MemoryHandle in(test.data_.data(), 1000);
+        FileHandle out(test.out_);
+        in.saveInto(out);
+    }
+
+    FileHandle in(test.in_);
+    FileHandle out(test.out_);
+    in.openForRead();
+    AutoClose closer1(in);
+    out.openForAppend(0);
+    AutoClose closer2(out);
+    EXPECT(!NativeTransfer::possible(in, out, TransferWatcher::dummy()));
+}
+
+CASE("Stream to file through splice") {
+
+    Tester test(3 * 1024 * 1024 + 17);
+
+    int fd[2];
+    EXPECT(::pipe(fd) == 0);
+
+    std::thread writer([&] {
+        const char* p = test.data_.data();
+        size_t left   = test.data_.size();
+        while (left > 0) {
+            ssize_t n = ::write(fd[1], p, left);
+            ASSERT(n > 0);
+            p += n;
+            left -= size_t(n);
+        }
+        ::close(fd[1]);
+    });
+
+    PipeHandle in(fd[0]);
+    FileHandle out(test.out_);
+    Counter watcher(false);
+
+    EXPECT(in.saveInto(out, watcher) == Length(test.data_.size()));
+    writer.join();
+
+    EXPECT(test.output() == test.data_);
+    EXPECT(watcher.native_ == long(test.data_.size()));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -9,6 +9,8 @@
  */
 
 #include <cstring>
+#include <string>
+#include <vector>
 
 #include "eckit/config/Resource.h"
 #include "eckit/filesystem/PathName.h"
@@ -17,6 +19,8 @@
 #include "eckit/io/MemoryHandle.h"
 #include "eckit/io/MultiHandle.h"
 #include "eckit/io/PartFileHandle.h"
+#include "eckit/io/PooledFile.h"
+#include "eckit/io/ReadPlan.h"
 #include "eckit/log/Log.h"
 #include "eckit/memory/Zero.h"
 #include "eckit/runtime/Tool.h"
@@ -186,6 +190,106 @@ CASE("PartFileHandle with multiple parts") {
     ph.close();
 }
 
+CASE("PartFileHandle reads ahead only dense parts") {
+
+    std::string base = Resource<std::string>("$TMPDIR", "/tmp");
+    PathName path    = PathName::unique(base + "/dense");
+
+    std::vector<char> data(1024 * 1024);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = char('a' + i % 26);
+    }
+    {
+        FileHandle f(path);
+        f.openForWrite(0);
+        f.write(data.data(), long(data.size()));
+        f.close();
+    }
+
+    auto read = [&path](const OffsetList& ol, const LengthList& ll) {
+        PartFileHandle ph(path, ol, ll);
+        ph.openForRead();
+        Buffer buff(1024);
+        std::string out;
+        for (long r; (r = ph.read(buff, 7)) > 0;) {
+            out.append(buff, r);
+        }
+        ph.close();
+        return out;
+    };
+
+    auto opens = [] { return PooledFile::statistics().opens_; };
+
+    // far apart: read one by one
+    size_t before = opens();
+    EXPECT_EQUAL(read({0, 256 * 1024 + 1, 512 * 1024 + 2, 768 * 1024 + 3}, {4, 4, 4, 4}), "abcdnopqabcdnopq");
+    EXPECT(opens() == before);
+
+    // close together: read ahead
+    before = opens();
+    EXPECT_EQUAL(read({0, 101, 202, 303}, {4, 4, 4, 4}), "abcdxyzauvwxrstu");
+    EXPECT(opens() == before + 1);
+
+    path.unlink();
+}
+
+CASE("ReadPlan coalesces nearby parts") {
+
+    OffsetList ol = {23, 0, 2, 6, 8, 30};
+    LengthList ll = {8, 1, 2, 4, 2, 0};
+
+    // gap of 1: [0,1) [2,4) are coalesced; [6,10) and [8,10) overlap
+    ReadPlan plan(ol, ll, 1);
+    EXPECT(plan.size() == 17);
+    EXPECT(plan.blocks().size() == 4);
+    EXPECT(plan.blocks()[0].ranges_ == std::vector<size_t>({1, 2}));
+
+    EXPECT(ReadPlan(ol, ll, 0).blocks().size() == 5);
+    EXPECT(ReadPlan(ol, ll, 1024).blocks().size() == 2);
+}
+
+CASE("PartFileHandle with unordered and overlapping parts") {
+
+    Tester test;
+
+    OffsetList ol = {23, 0, 2, 6, 8, 13, 30};
+    LengthList ll = {8, 1, 2, 4, 2, 6, 0};
+
+    PartFileHandle ph(test.path1_, ol, ll);
+    ph.openForRead();
+
+    Buffer buff = Tester::makeBuffer();
+    EXPECT(ph.read(buff, 40) == 23);
+    std::string first(buff);
+    EXPECT_EQUAL(first, "xyz01234acdghijijnopqrs");
+
+    // reads smaller than the parts
+    ph.rewind();
+    std::string read;
+    for (long r; (r = ph.read(buff, 3)) > 0;) {
+        read.append(buff, r);
+    }
+    EXPECT_EQUAL(read, "xyz01234acdghijijnopqrs");
+
+    ph.close();
+
+    // handles on the same file are merged when compressed
+    std::vector<DataHandle*> v{new MemoryHandle(buf1, 2)};
+    for (size_t i = 0; i < ol.size(); ++i) {
+        v.push_back(new PartFileHandle(test.path1_, ol[i], ll[i]));
+    }
+    MultiHandle mh(v);
+    EXPECT(mh.compress());
+
+    mh.openForRead();
+    Buffer all(64);
+    all.zero();
+    EXPECT(mh.read(all, 40) == 25);
+    std::string merged(all);
+    EXPECT_EQUAL(merged, "abxyz01234acdghijijnopqrs");
+    mh.close();
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
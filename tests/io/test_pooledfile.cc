@@ -9,6 +9,9 @@
  */
 
 #include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include "eckit/config/Resource.h"
 #include "eckit/filesystem/PathName.h"
@@ -255,6 +258,108 @@ CASE("Seeking to location") {
     }
 }
 
+CASE("Pool statistics") {
+
+    Tester test;
+
+    auto before = PooledFile::statistics();
+    {
+        PooledFile f1(test.path1_);
+        PooledFile f2(test.path1_);
+        auto c1 = closer(f1);
+        auto c2 = closer(f2);
+
+        f1.open();
+        f2.open();
+    }
+    auto after = PooledFile::statistics();
+
+    EXPECT(after.opens_ - before.opens_ == 1);
+    EXPECT(after.hits_ - before.hits_ == 1);
+    EXPECT(after.evictions_ - before.evictions_ == 1);
+}
+
+CASE("Concurrent positional reads on a shared descriptor") {
+
+    Tester test;
+
+    // created in this thread, so all in the same pool and sharing one file descriptor
+    std::vector<std::unique_ptr<PooledFile>> files;
+    auto before = PooledFile::statistics();
+    for (size_t i = 0; i < 8; ++i) {
+        files.emplace_back(new PooledFile(test.path1_));
+        files.back()->open();
+    }
+    EXPECT(PooledFile::statistics().opens_ - before.opens_ == 1);
+
+    std::vector<std::thread> threads;
+    std::vector<std::string> results(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        threads.emplace_back([&files, &results, i] {
+            // reads are positional, so the files do not interfere
+            PooledFile& g = *files[i];
+            char b[4];
+            for (size_t j = 0; j < 100; ++j) {
+                g.seek(off_t((i + j) % 20));
+                EXPECT(g.read(b, 4) == 4);
+                results[i] = std::string(b, 4);
+            }
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (auto& f : files) {
+        f->close();
+    }
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT(results[i] == std::string(test.message + (i + 99) % 20, 4));
+    }
+}
+
+CASE("Per-thread or process-wide pool") {
+
+    Tester test;
+
+    PooledFile f(test.path1_);
+    auto c = closer(f);
+    f.open();
+
+    auto before = PooledFile::statistics();
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i) {
+        threads.emplace_back([&test] {
+            PooledFile g(test.path1_);
+            auto c = closer(g);
+            g.open();
+            char b[4];
+            EXPECT(g.read(b, 4) == 4);
+            EXPECT(std::string(b, 4) == std::string(test.message, 4));
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    auto after = PooledFile::statistics();
+
+    static const bool global = Resource<bool>("PooledFileGlobalPool;$ECKIT_POOLED_FILE_GLOBAL_POOL", false);
+    if (global) {
+        // the threads share the descriptor opened by this one
+        EXPECT(after.opens_ - before.opens_ == 0);
+        EXPECT(after.hits_ - before.hits_ == 4);
+    }
+    else {
+        EXPECT(after.opens_ - before.opens_ == 4);
+        EXPECT(after.hits_ - before.hits_ == 0);
+    }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 }  // namespace eckit::test
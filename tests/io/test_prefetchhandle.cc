@@ -0,0 +1,146 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <vector>
+
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/MemoryHandle.h"
+#include "eckit/io/PrefetchHandle.h"
+#include "eckit/testing/Test.h"
+#include "util.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Fails after a number of bytes
+class FailingHandle : public MemoryHandle {
+public:
+    FailingHandle(const std::vector<char>& data, long limit) :
+        MemoryHandle(data.data(), data.size()), limit_(limit) {}
+
+    long read(void* buffer, long length) override {
+        if (position() >= Offset(limit_)) {
+            throw ReadError("FailingHandle");
+        }
+        return MemoryHandle::read(buffer, length);
+    }
+
+private:
+    long limit_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("PrefetchHandle reads sequentially") {
+    auto data = makeData(1000003);
+
+    for (size_t count : {1, 3}) {
+        for (long chunk : {1000, 4096, 100000}) {
+            PrefetchHandle h(new MemoryHandle(data.data(), data.size()), count, 4096);
+            EXPECT(h.openForRead() == Length(data.size()));
+            AutoClose closer(h);
+
+            std::vector<char> out;
+            std::vector<char> buffer(chunk);
+            for (long n; (n = h.read(buffer.data(), chunk)) > 0;) {
+                out.insert(out.end(), buffer.begin(), buffer.begin() + n);
+            }
+
+            EXPECT(out == data);
+            EXPECT(h.position() == Offset(data.size()));
+            EXPECT(h.read(buffer.data(), chunk) == 0);
+        }
+    }
+}
+
+CASE("PrefetchHandle seeks and skips") {
+    auto data = makeData(100000);
+
+    PrefetchHandle h(new MemoryHandle(data.data(), data.size()), 4, 1000);
+    h.openForRead();
+    AutoClose closer(h);
+
+    std::vector<char> buffer(100);
+
+    auto check = [&](long long offset) {
+        EXPECT(h.position() == Offset(offset));
+        EXPECT(h.read(buffer.data(), 100) == 100);
+        EXPECT(std::equal(buffer.begin(), buffer.end(), data.begin() + offset));
+    };
+
+    check(0);
+
+    // forward, likely within the data read ahead
+    h.seek(500);
+    check(500);
+    h.skip(1400);
+    check(2000);
+
+    // far forward, backwards
+    h.seek(90000);
+    check(90000);
+    h.seek(10);
+    check(10);
+
+    h.rewind();
+    check(0);
+
+    // to the end
+    h.seek(data.size());
+    EXPECT(h.read(buffer.data(), 100) == 0);
+
+    EXPECT(h.stallTime() >= 0);
+}
+
+CASE("PrefetchHandle reports read errors after the data read") {
+    auto data = makeData(10000);
+
+    PrefetchHandle h(new FailingHandle(data, 5000), 2, 1000);
+    h.openForRead();
+
+    std::vector<char> buffer(10000);
+    EXPECT(h.read(buffer.data(), 5000) == 5000);
+    EXPECT(std::equal(buffer.begin(), buffer.begin() + 5000, data.begin()));
+    EXPECT_THROWS_AS(h.read(buffer.data(), 10), ReadError);
+
+    // restarting clears the error
+    h.seek(0);
+    EXPECT(h.read(buffer.data(), 100) == 100);
+    h.close();
+}
+
+CASE("PrefetchHandle returns the data read before an error") {
+    auto data = makeData(10000);
+
+    PrefetchHandle h(new FailingHandle(data, 5000), 2, 1000);
+    h.openForRead();
+
+    // Across the failure point, the good bytes are returned first
+    std::vector<char> buffer(10000);
+    EXPECT(h.read(buffer.data(), 4500) == 4500);
+    EXPECT(h.read(buffer.data() + 4500, 1000) == 500);
+    EXPECT(std::equal(buffer.begin(), buffer.begin() + 5000, data.begin()));
+    EXPECT(h.position() == Offset(5000));
+    EXPECT_THROWS_AS(h.read(buffer.data(), 10), ReadError);
+    h.close();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,205 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/RawFileHandle.h"
+#include "eckit/testing/Test.h"
+#include "util.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<char> readAll(DataHandle& h, long chunk) {
+    std::vector<char> out;
+    std::vector<char> buffer(chunk);
+    h.openForRead();
+    AutoClose closer(h);
+    for (long n; (n = h.read(buffer.data(), chunk)) > 0;) {
+        out.insert(out.end(), buffer.begin(), buffer.begin() + n);
+    }
+    return out;
+}
+
+/// Memory aligned for O_DIRECT
+struct AlignedBuffer {
+    char* data_;
+    AlignedBuffer(size_t size) {
+        void* p = nullptr;
+        EXPECT(::posix_memalign(&p, 4096, size) == 0);
+        data_ = static_cast<char*>(p);
+    }
+    ~AlignedBuffer() { ::free(data_); }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Direct writes and reads, with an unaligned tail") {
+    PathName path("test_rawfilehandle.data");
+
+    for (size_t size : {0, 100, 4096, 1000003, 10 * 1024 * 1024 + 5}) {
+        auto data = makeData(size);
+
+        for (long chunk : {1000, 65536, 1 << 20}) {
+            path.unlink(true);
+            {
+                RawFileHandle h(path, false, true);
+                h.openForWrite(0);
+                AutoClose closer(h);
+                for (size_t i = 0; i < data.size(); i += chunk) {
+                    long n = long(std::min<size_t>(chunk, data.size() - i));
+                    EXPECT(h.write(data.data() + i, n) == n);
+                }
+                EXPECT(h.position() == Offset(data.size()));
+            }
+
+            EXPECT(path.size() == Length(data.size()));
+
+            RawFileHandle direct(path, false, true);
+            EXPECT(readAll(direct, chunk) == data);
+
+            FileHandle buffered(path);
+            EXPECT(readAll(buffered, chunk) == data);
+        }
+    }
+
+    path.unlink();
+}
+
+CASE("Aligned memory bypasses the buffer") {
+    PathName path("test_rawfilehandle.data");
+    path.unlink(true);
+
+    const size_t size = 3 * 1024 * 1024 + 4096;
+    auto data         = makeData(size);
+
+    AlignedBuffer buffer(size);
+    ::memcpy(buffer.data_, data.data(), size);
+
+    {
+        RawFileHandle h(path, false, true);
+        h.openForWrite(0);
+        AutoClose closer(h);
+        EXPECT(h.write(buffer.data_, 1024 * 1024) == 1024 * 1024);
+        EXPECT(h.write(buffer.data_ + 1024 * 1024, size - 1024 * 1024 - 10) == long(size - 1024 * 1024 - 10));
+        EXPECT(h.write(buffer.data_ + size - 10, 10) == 10);
+    }
+
+    ::memset(buffer.data_, 0, size);
+    {
+        RawFileHandle h(path, false, true);
+        h.openForRead();
+        AutoClose closer(h);
+        EXPECT(h.read(buffer.data_, long(size)) == long(size));
+        EXPECT(h.read(buffer.data_, 4096) == 0);
+    }
+
+    EXPECT(::memcmp(buffer.data_, data.data(), size) == 0);
+
+    path.unlink();
+}
+
+CASE("Direct reads seek and skip") {
+    PathName path("test_rawfilehandle.data");
+    path.unlink(true);
+
+    auto data = makeData(100000);
+    {
+        FileHandle h(path);
+        h.openForWrite(0);
+        AutoClose closer(h);
+        h.write(data.data(), long(data.size()));
+    }
+
+    RawFileHandle h(path, false, true);
+    h.openForRead();
+    AutoClose closer(h);
+
+    std::vector<char> buffer(5000);
+
+    auto check = [&](long long offset, long length) {
+        EXPECT(h.position() == Offset(offset));
+        EXPECT(h.read(buffer.data(), length) == length);
+        EXPECT(std::equal(buffer.begin(), buffer.begin() + length, data.begin() + offset));
+    };
+
+    check(0, 10);
+    h.seek(5000);
+    check(5000, 5000);
+    h.skip(12345);
+    check(22345, 100);
+    h.seek(3);
+    check(3, 5000);
+
+    h.seek(data.size() - 7);
+    EXPECT(h.read(buffer.data(), 5000) == 7);
+    EXPECT(h.read(buffer.data(), 5000) == 0);
+
+    path.unlink();
+}
+
+CASE("Writing an unaligned tail stops bypassing the page cache") {
+    PathName path("test_rawfilehandle.data");
+    path.unlink(true);
+
+    auto data = makeData(4096 + 10);
+
+    RawFileHandle h(path, false, true);
+    h.openForWrite(0);
+    bool direct = h.direct();  // unless the filesystem rejects O_DIRECT
+    EXPECT(h.write(data.data(), long(data.size())) == long(data.size()));
+    EXPECT(h.direct() == direct);
+    h.close();
+    EXPECT(!h.direct());
+
+    h.openForRead();
+    EXPECT(h.direct() == direct);
+    h.close();
+
+    path.unlink();
+}
+
+CASE("Buffered writes are unchanged") {
+    PathName path("test_rawfilehandle.data");
+    path.unlink(true);
+
+    auto data = makeData(12345);
+    {
+        RawFileHandle h(path);
+        h.openForWrite(0);
+        AutoClose closer(h);
+        EXPECT(!h.direct());
+        EXPECT(h.write(data.data(), long(data.size())) == long(data.size()));
+    }
+
+    RawFileHandle h(path);
+    EXPECT(readAll(h, 1000) == data);
+
+    path.unlink();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
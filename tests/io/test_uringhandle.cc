@@ -0,0 +1,187 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/FileHandle.h"
+#include "eckit/io/UringHandle.h"
+#include "eckit/log/Log.h"
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class Tester {
+public:
+    Tester(size_t size) :
+        data_(size) {
+        std::string base = Resource<std::string>("$TMPDIR", "/tmp");
+        path_            = PathName::unique(base + "/uring");
+        path_ += ".dat";
+
+        for (size_t i = 0; i < size; ++i) {
+            data_[i] = char(i * 7 + i / 4099);
+        }
+    }
+
+    ~Tester() {
+        if (path_.exists()) {
+            path_.unlink(false);
+        }
+    }
+
+    void write(DataHandle& h, size_t chunk) {
+        h.openForWrite(0);
+        AutoClose closer(h);
+        for (size_t i = 0; i < data_.size(); i += chunk) {
+            size_t n = std::min(chunk, data_.size() - i);
+            EXPECT(h.write(data_.data() + i, long(n)) == long(n));
+        }
+    }
+
+    std::vector<char> read(DataHandle& h, size_t chunk) {
+        std::vector<char> out;
+        std::vector<char> buffer(chunk);
+
+        h.openForRead();
+        AutoClose closer(h);
+        for (long n; (n = h.read(buffer.data(), long(chunk))) > 0;) {
+            out.insert(out.end(), buffer.begin(), buffer.begin() + n);
+        }
+        return out;
+    }
+
+    std::vector<char> data_;
+    PathName path_;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("UringHandle writes and reads") {
+
+    if (!UringHandle::available()) {
+        Log::warning() << "io_uring not available, skipping test" << std::endl;
+        return;
+    }
+
+    // size not a multiple of the buffer size, nor of the block size
+    Tester test(3 * 1024 * 1024 + 12345);
+
+    for (bool direct : {false, true}) {
+        for (size_t depth : {1, 4}) {
+            SECTION("write with UringHandle, read with FileHandle") {
+                UringHandle out(test.path_, depth, 64 * 1024, true, direct);
+                test.write(out, 10000);
+                EXPECT(test.path_.size() == Length(test.data_.size()));
+
+                FileHandle in(test.path_);
+                EXPECT(test.read(in, 65536) == test.data_);
+            }
+
+            SECTION("write with FileHandle, read with UringHandle") {
+                FileHandle out(test.path_);
+                test.write(out, 65536);
+
+                UringHandle in(test.path_, depth, 64 * 1024, false, direct);
+                EXPECT(test.read(in, 7777) == test.data_);
+            }
+        }
+    }
+}
+
+CASE("UringHandle flush, append and rewind") {
+
+    if (!UringHandle::available()) {
+        return;
+    }
+
+    Tester test(200000);
+
+    {
+        UringHandle out(test.path_, 4, 16 * 1024);
+        out.openForWrite(0);
+        AutoClose closer(out);
+        out.write(test.data_.data(), 100000);
+        out.flush();
+        EXPECT(test.path_.size() == Length(100000));
+    }
+
+    {
+        UringHandle out(test.path_, 4, 16 * 1024);
+        out.openForAppend(0);
+        AutoClose closer(out);
+        out.write(test.data_.data() + 100000, 100000);
+        EXPECT(out.position() == Offset(200000));
+    }
+
+    UringHandle in(test.path_, 2, 8 * 1024);
+    in.openForRead();
+    AutoClose closer(in);
+
+    std::vector<char> buffer(test.data_.size());
+    EXPECT(in.read(buffer.data(), 1000) == 1000);
+    in.rewind();
+    EXPECT(in.read(buffer.data(), long(buffer.size()) + 10) == long(buffer.size()));
+    EXPECT(buffer == test.data_);
+    EXPECT(in.read(buffer.data(), 10) == 0);
+}
+
+CASE("UringHandle saveInto") {
+
+    if (!UringHandle::available()) {
+        return;
+    }
+
+    Tester test(1000003);
+    {
+        FileHandle out(test.path_);
+        test.write(out, 65536);
+    }
+
+    // estimate() is called before the handle is opened
+    UringHandle in(test.path_, 4, 64 * 1024);
+    EXPECT(in.estimate() == Length(test.data_.size()));
+
+    PathName copy(test.path_ + ".copy");
+    {
+        FileHandle out(copy);
+        EXPECT(in.saveInto(out) == Length(test.data_.size()));
+    }
+
+    FileHandle check(copy);
+    EXPECT(test.read(check, 65536) == test.data_);
+    copy.unlink();
+}
+
+CASE("UringHandle::create") {
+    Tester test(1000);
+
+    std::unique_ptr<DataHandle> out(UringHandle::create(test.path_));
+    test.write(*out, 100);
+    EXPECT(test.path_.size() == Length(1000));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
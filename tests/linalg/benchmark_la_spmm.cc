@@ -0,0 +1,119 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation
+ * nor does it submit to any jurisdiction.
+ */
+
+#include <iostream>
+#include <vector>
+
+#include "eckit/config/Resource.h"
+#include "eckit/linalg/LinearAlgebraSparse.h"
+#include "eckit/log/Timer.h"
+#include "util.h"
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Apply one sparse matrix to many fields: N times spmv, spmm (column-major) and spmm of row-major fields
+
+CASE("benchmark spmm of many fields") {
+    using namespace linalg;
+
+    const auto Ni = Resource<Size>("-rows", 100000);
+    const auto Nj = Resource<Size>("-cols", 50000);
+    const auto Nk = Resource<Size>("-fields", 64);
+
+    // interpolation-like matrix, 4 non-zeros per row
+    std::vector<Triplet> triplets;
+    triplets.reserve(Ni * 4);
+    for (Size i = 0; i < Ni; ++i) {
+        const auto j = (i * Nj) / Ni;
+        for (Size c = 0; c < 4; ++c) {
+            triplets.emplace_back(i, (j + c * 7) % Nj, 0.25);
+        }
+    }
+    std::sort(triplets.begin(), triplets.end());
+    const SparseMatrix A(Ni, Nj, triplets);
+
+    Matrix X(Nj, Nk);
+    TensorDouble Xd({Nj, Nk}, TensorDouble::Layout::RowMajor);
+    TensorFloat Xf({Nj, Nk}, TensorFloat::Layout::RowMajor);
+    for (Size j = 0; j < Nj; ++j) {
+        for (Size k = 0; k < Nk; ++k) {
+            X(j, k)        = Scalar((j + k) % 17);
+            Xd[j * Nk + k] = X(j, k);
+            Xf[j * Nk + k] = static_cast<float>(X(j, k));
+        }
+    }
+
+    const auto& linalg = LinearAlgebraSparse::backend();
+    Log::info() << linalg << ", " << A << ", fields=" << Nk << std::endl;
+
+    // results (touched, so that page faults are not timed)
+    Matrix Y(Ni, Nk);
+    Matrix Z(Ni, Nk);
+    TensorDouble Yd({Ni, Nk}, TensorDouble::Layout::RowMajor);
+    TensorFloat Yf({Ni, Nk}, TensorFloat::Layout::RowMajor);
+    Vector y(Ni);
+    Y.setZero();
+    Z.setZero();
+    Yd.zero();
+    Yf.zero();
+    y.setZero();
+
+    Timer timer;
+
+    timer.start();
+    for (Size k = 0; k < Nk; ++k) {
+        Vector x(X.data() + k * Nj, Nj);
+        linalg.spmv(A, x, y);
+        std::copy(y.begin(), y.end(), Y.data() + k * Ni);
+    }
+    timer.stop();
+    const auto spmv = timer.elapsed();
+    Log::info() << Nk << " x spmv: " << spmv << "s" << std::endl;
+
+    timer.start();
+    linalg.spmm(A, X, Z);
+    timer.stop();
+    Log::info() << "spmm (column-major): " << timer.elapsed() << "s" << std::endl;
+    EXPECT(equal_dense_matrix(Y, Z));
+
+    timer.start();
+    linalg.spmm(A, Xd, Yd);
+    timer.stop();
+    const auto rowMajor = timer.elapsed();
+    Log::info() << "spmm (row-major, double): " << rowMajor << "s, speedup " << spmv / rowMajor << std::endl;
+
+    timer.start();
+    linalg.spmm(A, Xf, Yf);
+    timer.stop();
+    Log::info() << "spmm (row-major, float): " << timer.elapsed() << "s, speedup " << spmv / timer.elapsed()
+                << std::endl;
+
+    for (Size i = 0; i < Ni; ++i) {
+        for (Size k = 0; k < Nk; ++k) {
+            EXPECT(Yd[i * Nk + k] == Y(i, k));
+            EXPECT(Yf[i * Nk + k] == static_cast<float>(Y(i, k)));
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    eckit::Main::initialise(argc, argv);
+
+    // Set sparse linear algebra backend
+    eckit::linalg::LinearAlgebraSparse::backend(eckit::Resource<std::string>("-linearAlgebraSparseBackend", "generic"));
+
+    return eckit::testing::run_tests(argc, argv, false);
+}
@@ -24,6 +24,7 @@ CASE("list") {
 
     auto dense_backends = {
         "generic",
+        "blocked",
 #if eckit_HAVE_ARMADILLO
         "armadillo",
 #endif
@@ -49,6 +50,7 @@ CASE("list") {
 
     auto sparse_backends = {
         "generic",
+        "sell",
 #if eckit_HAVE_CUDA
         "cuda",
 #endif
@@ -20,6 +20,8 @@ namespace eckit::test {
 
 CASE("test backend") {
     using linalg::Matrix;
+    using linalg::Scalar;
+    using linalg::Size;
     using linalg::Vector;
 
     Matrix A = M(2, 2, 1., -2., -4., 2.);
@@ -64,6 +66,53 @@ CASE("test backend") {
 
         EXPECT(equal_dense_matrix(C, C_check));
     }
+
+    SECTION("gemv/gemm - sizes not multiple of blocking") {
+        const Size Ni = 131;
+        const Size Nj = 17;
+        const Size Nk = 259;
+
+        auto value = [](Size i, Size j) { return static_cast<Scalar>(static_cast<int>((3 * i + 5 * j) % 7) - 3); };
+
+        Matrix A(Ni, Nk);
+        Matrix B(Nk, Nj);
+        Vector x(Nk);
+        for (Size k = 0; k < Nk; ++k) {
+            for (Size i = 0; i < Ni; ++i) {
+                A(i, k) = value(i, k);
+            }
+            for (Size j = 0; j < Nj; ++j) {
+                B(k, j) = value(k, j + 1);
+            }
+            x[k] = value(k, 2);
+        }
+
+        Matrix C(Ni, Nj);
+        Matrix C_check(Ni, Nj);
+        Vector y(Ni);
+        Vector y_check(Ni);
+        for (Size i = 0; i < Ni; ++i) {
+            for (Size j = 0; j < Nj; ++j) {
+                Scalar sum = 0.;
+                for (Size k = 0; k < Nk; ++k) {
+                    sum += A(i, k) * B(k, j);
+                }
+                C_check(i, j) = sum;
+            }
+
+            Scalar sum = 0.;
+            for (Size k = 0; k < Nk; ++k) {
+                sum += A(i, k) * x[k];
+            }
+            y_check[i] = sum;
+        }
+
+        linalg.gemm(A, B, C);
+        EXPECT(equal_dense_matrix(C, C_check));
+
+        linalg.gemv(A, x, y);
+        EXPECT(equal_dense_matrix(y, y_check));
+    }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -101,6 +101,34 @@ CASE("test backend") {
         EXPECT_THROWS_AS(linalg.spmm(A, Matrix(2, 2), C), AssertionFailed);
     }
 
+    SECTION("spmm - sparse 3x3 x row-major fields 3x2 = row-major fields 3x2") {
+        using Layout = linalg::TensorDouble::Layout;
+
+        double x[] = {1., 2., 3., 4., 5., 6.};
+        double z[] = {-13., -14., 6., 8., 10., 12.};
+
+        linalg::TensorDouble X({3, 2}, Layout::RowMajor);
+        linalg::TensorDouble Y({3, 2}, Layout::RowMajor);
+        std::copy(x, x + 6, X.data());
+
+        linalg.spmm(A, X, Y);
+        EXPECT(equal_array(Y.data(), z, 6));
+
+        linalg::TensorFloat Xf({3, 2}, linalg::TensorFloat::Layout::RowMajor);
+        linalg::TensorFloat Yf({3, 2}, linalg::TensorFloat::Layout::RowMajor);
+        std::copy(x, x + 6, Xf.data());
+
+        linalg.spmm(A, Xf, Yf);
+        for (size_t i = 0; i < 6; ++i) {
+            EXPECT(Yf[i] == static_cast<float>(z[i]));
+        }
+
+        Log::info() << "spmm of sparse matrix and fields of non-matching sizes should fail" << std::endl;
+        linalg::TensorDouble W({2, 2}, Layout::RowMajor);
+        EXPECT_THROWS_AS(linalg.spmm(A, W, Y), AssertionFailed);
+        EXPECT_THROWS_AS(linalg.spmm(A, X, W), AssertionFailed);
+    }
+
     SECTION("dsptd - diagonal 3 x sparse 3x3 x diagonal 3 = sparse 3x3") {
         SparseMatrix B;
         linalg.dsptd(x, A, x, B);
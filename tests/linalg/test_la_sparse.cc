@@ -8,7 +8,18 @@
  * nor does it submit to any jurisdiction.
  */
 
+#include <unistd.h>
+
+#include <cstdint>
+#include <fstream>
+
 #include "eckit/config/Resource.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/linalg/LinearAlgebraSparse.h"
+#include "eckit/linalg/SparseMatrixFloat.h"
+#include "eckit/linalg/SparseMatrixSELL.h"
+#include "eckit/linalg/allocator/MappedAllocator.h"
+#include "eckit/linalg/sparse/LinearAlgebraSELL.h"
 #include "util.h"
 
 using namespace eckit::linalg;
@@ -242,6 +253,333 @@ CASE("creation with unassigned triplets ( ECKIT-361 )") {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+CASE("creation from unsorted triplets") {
+    const Size Ni = 97;
+    const Size Nj = 53;
+
+    // reference: row-sorted triplets, without duplicates
+    std::vector<Triplet> sorted;
+    for (Size i = 0; i < Ni; ++i) {
+        for (Size j = i % 3; j < Nj; j += 1 + (i + j) % 11) {
+            sorted.emplace_back(i, j, Scalar(1 + (i * j) % 7));
+        }
+    }
+    const SparseMatrix A(Ni, Nj, sorted);
+
+    // split entries into duplicates (exactly representable halves) and zeros, in reverse order
+    std::vector<Triplet> triplets;
+    for (auto t = sorted.rbegin(); t != sorted.rend(); ++t) {
+        triplets.emplace_back(t->row(), t->col(), t->value() * 0.5);
+        triplets.emplace_back(t->row(), (t->col() + 1) % Nj, 0.);
+    }
+    for (const auto& t : sorted) {
+        triplets.emplace_back(t.row(), t.col(), t.value() * 0.5);
+    }
+
+    auto B = SparseMatrix::fromTriplets(Ni, Nj, triplets);
+    EXPECT(B.rows() == Ni);
+    EXPECT(B.cols() == Nj);
+    EXPECT(B.nonZeros() == A.nonZeros());
+    EXPECT(equal_sparse_matrix(B, A.outer(), A.inner(), A.data()));
+    EXPECT(B.footprint() == A.footprint());
+
+    SECTION("transpose") {
+        std::vector<Triplet> transposed;
+        for (const auto& t : sorted) {
+            transposed.emplace_back(t.col(), t.row(), t.value());
+        }
+        std::sort(transposed.begin(), transposed.end());
+        const SparseMatrix At(Nj, Ni, transposed);
+
+        EXPECT(equal_sparse_matrix(B.transpose(), At.outer(), At.inner(), At.data()));
+        EXPECT(equal_sparse_matrix(B.transpose(), A.outer(), A.inner(), A.data()));
+    }
+
+    SECTION("transpose with duplicates") {
+        // the triplets constructor keeps duplicates, transpose sums them
+        std::vector<Triplet> duplicates;
+        for (const auto& t : sorted) {
+            duplicates.emplace_back(t.row(), t.col(), t.value() * 0.5);
+            duplicates.emplace_back(t.row(), t.col(), t.value() * 0.5);
+        }
+        SparseMatrix C(Ni, Nj, duplicates);
+        EXPECT(C.nonZeros() == 2 * A.nonZeros());
+
+        C.transpose().transpose();
+        EXPECT(C.nonZeros() == A.nonZeros());
+        EXPECT(C.footprint() == A.footprint());
+        EXPECT(equal_sparse_matrix(C, A.outer(), A.inner(), A.data()));
+    }
+
+    SECTION("invalid triplets") {
+        EXPECT_THROWS(SparseMatrix::fromTriplets(Ni, Nj, {{Ni, 0, 1.}}));
+        EXPECT_THROWS(SparseMatrix::fromTriplets(Ni, Nj, {{0, Nj, 1.}}));
+        EXPECT_THROWS(SparseMatrix::fromTriplets(Ni, Nj, {{0, 0, 0.}}));
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("SELL-C-sigma format") {
+    // irregular row lengths (0 to 6 non-zeros), including empty rows
+    const Size Ni = 37;
+    const Size Nj = 11;
+    const Size Nk = 3;
+
+    std::vector<Triplet> triplets;
+    for (Size i = 0; i < Ni; ++i) {
+        for (Size j = 0; j < (i * 5) % 7; ++j) {
+            triplets.emplace_back(i, (i + 3 * j) % Nj, Scalar(1 + (i + j) % 4));
+        }
+    }
+    std::sort(triplets.begin(), triplets.end());
+    SparseMatrix A(Ni, Nj, triplets);
+
+    Vector x(Nj);
+    Matrix X(Nj, Nk);
+    for (Size j = 0; j < Nj; ++j) {
+        x[j] = Scalar(j + 1);
+        for (Size k = 0; k < Nk; ++k) {
+            X(j, k) = Scalar(j + 2 * k);
+        }
+    }
+
+    const auto& generic = LinearAlgebraSparse::getBackend("generic");
+
+    Vector y_check(Ni);
+    Matrix Y_check(Ni, Nk);
+    generic.spmv(A, x, y_check);
+    generic.spmm(A, X, Y_check);
+
+    for (Size C : {1, 4, 8, 32}) {
+        for (Size sigma : {Size(1), C, 4 * C}) {
+            SparseMatrixSELL B(A, C, sigma);
+            Log::info() << B << std::endl;
+
+            EXPECT(B.rows() == Ni);
+            EXPECT(B.cols() == Nj);
+            EXPECT(B.nonZeros() == A.nonZeros());
+            EXPECT(B.storedSize() >= B.nonZeros());
+
+            Vector y(Ni);
+            B.spmv(x, y);
+            EXPECT(equal_dense_matrix(y, y_check));
+
+            Matrix Y(Ni, Nk);
+            B.spmm(X, Y);
+            EXPECT(equal_dense_matrix(Y, Y_check));
+        }
+    }
+
+    EXPECT_THROWS_AS(SparseMatrixSELL(A, 3), BadParameter);
+    EXPECT_THROWS_AS(SparseMatrixSELL(A, 8, 12), BadParameter);
+}
+
+CASE("SELL-C-sigma backend caches conversions") {
+    const auto& sell = LinearAlgebraSparse::getBackend("sell");
+    sparse::LinearAlgebraSELL::clearCache();
+
+    SparseMatrix A(3, 3, {{0, 0, 2.}, {1, 2, 3.}, {2, 1, 4.}});
+    Vector x = V(3, 1., 2., 3.);
+    Vector y(3);
+
+    for (size_t i = 0; i < 3; ++i) {
+        sell.spmv(A, x, y);
+        EXPECT(equal_dense_matrix(y, V(3, 2., 9., 8.)));
+    }
+
+    // Same shape and storage size, different entries
+    SparseMatrix B(3, 3, {{0, 1, 1.}, {1, 1, 1.}, {2, 2, 1.}});
+    sell.spmv(B, x, y);
+    EXPECT(equal_dense_matrix(y, V(3, 2., 2., 3.)));
+
+    // Modified in place
+    for (auto it = A.begin(); it != A.end(); ++it) {
+        *it = 1.;
+    }
+    sell.spmv(A, x, y);
+    EXPECT(equal_dense_matrix(y, V(3, 1., 3., 2.)));
+
+    // Modified in place, one entry of many
+    {
+        const Size N = 1000;
+        std::vector<Triplet> triplets;
+        for (Size i = 0; i < N; ++i) {
+            triplets.emplace_back(i, i, 1.);
+        }
+        SparseMatrix D(N, N, triplets);
+        Vector ones(N);
+        ones.fill(1.);
+        Vector d(N);
+
+        sell.spmv(D, ones, d);
+        EXPECT(d[N / 2] == 1.);
+
+        auto it = D.begin(N / 2);
+        *it     = 3.;
+        sell.spmv(D, ones, d);
+        EXPECT(d[N / 2] == 3.);
+    }
+
+    // Empty rows are padded with a column accessed by their slice
+    SparseMatrix E(4, 2, {{3, 1, 5.}});
+    Vector e(4);
+    sell.spmv(E, V(2, 1., 2.), e);
+    EXPECT(equal_dense_matrix(e, V(4, 0., 0., 0., 10.)));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("single precision format") {
+    // entries exactly representable in single precision, so products compare exactly
+    const Size Ni = 37;
+    const Size Nj = 11;
+    const Size Nk = 20;
+
+    std::vector<Triplet> triplets;
+    for (Size i = 0; i < Ni; ++i) {
+        for (Size j = 0; j < (i * 5) % 7; ++j) {
+            triplets.emplace_back(i, (i + 3 * j) % Nj, Scalar(1 + (i + j) % 4) * 0.25);
+        }
+    }
+    std::sort(triplets.begin(), triplets.end());
+    SparseMatrix A(Ni, Nj, triplets);
+
+    Vector x(Nj);
+    Matrix X(Nj, Nk);
+    TensorDouble Xd({Nj, Nk}, TensorDouble::Layout::RowMajor);
+    TensorFloat Xf({Nj, Nk}, TensorFloat::Layout::RowMajor);
+    for (Size j = 0; j < Nj; ++j) {
+        x[j] = Scalar(j + 1);
+        for (Size k = 0; k < Nk; ++k) {
+            X(j, k)        = Scalar(j + 2 * k);
+            Xd[j * Nk + k] = X(j, k);
+            Xf[j * Nk + k] = static_cast<float>(X(j, k));
+        }
+    }
+
+    const auto& generic = LinearAlgebraSparse::getBackend("generic");
+
+    Vector y_check(Ni);
+    Matrix Y_check(Ni, Nk);
+    generic.spmv(A, x, y_check);
+    generic.spmm(A, X, Y_check);
+
+    for (bool delta : {false, true}) {
+        SparseMatrixFloat B(A, delta);
+        Log::info() << B << std::endl;
+
+        EXPECT(B.rows() == Ni);
+        EXPECT(B.cols() == Nj);
+        EXPECT(B.nonZeros() == A.nonZeros());
+        EXPECT(B.deltaIndices() == delta);
+        EXPECT(B.footprint() < A.footprint());
+
+        Vector y(Ni);
+        B.spmv(x, y);
+        EXPECT(equal_dense_matrix(y, y_check));
+
+        Matrix Y(Ni, Nk);
+        B.spmm(X, Y);
+        EXPECT(equal_dense_matrix(Y, Y_check));
+
+        TensorDouble Yd({Ni, Nk}, TensorDouble::Layout::RowMajor);
+        TensorFloat Yf({Ni, Nk}, TensorFloat::Layout::RowMajor);
+        B.spmm(Xd, Yd);
+        B.spmm(Xf, Yf);
+        for (Size i = 0; i < Ni; ++i) {
+            for (Size k = 0; k < Nk; ++k) {
+                EXPECT(Yd[i * Nk + k] == Y_check(i, k));
+                EXPECT(Yf[i * Nk + k] == static_cast<float>(Y_check(i, k)));
+            }
+        }
+
+        // round trips
+        EXPECT(equal_sparse_matrix(B.toSparseMatrix(), A.outer(), A.inner(), A.data()));
+
+        PathName path = PathName::unique("matrix");
+        B.save(path);
+
+        SparseMatrixFloat C;
+        C.load(path);
+        path.unlink();
+
+        EXPECT(C.nonZeros() == B.nonZeros());
+        EXPECT(C.deltaIndices() == delta);
+        EXPECT(equal_sparse_matrix(C.toSparseMatrix(), A.outer(), A.inner(), A.data()));
+    }
+
+    SECTION("column indices too far apart for delta-encoding") {
+        const Index big = 100000;
+        SparseMatrix D(2, big + 1, {{0, 0, 1.}, {0, Size(big), 2.}, {1, 1, 3.}});
+
+        SparseMatrixFloat B(D, true);
+        EXPECT(!B.deltaIndices());
+        EXPECT(B.nonZeros() == 3);
+        EXPECT(equal_sparse_matrix(B.toSparseMatrix(), D.outer(), D.inner(), D.data()));
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("memory-mapped loading") {
+    using allocator::MappedAllocator;
+
+    SparseMatrix A(S(3, 3, 4, 0, 0, 2., 0, 2, -3., 1, 1, 2., 2, 2, 2.));
+
+    PathName path = PathName::unique("matrix");
+    MappedAllocator::save(A, path);
+    EXPECT(MappedAllocator::isMappable(path));
+
+    for (bool verify : {false, true}) {
+        SparseMatrix B(new MappedAllocator(path, verify));
+        Log::info() << B << std::endl;
+
+        EXPECT(B.inSharedMemory());
+        EXPECT(B.rows() == A.rows());
+        EXPECT(B.cols() == A.cols());
+        EXPECT(equal_sparse_matrix(B, A.outer(), A.inner(), A.data()));
+
+        // sections are page-aligned
+        EXPECT(reinterpret_cast<uintptr_t>(B.outer()) % ::sysconf(_SC_PAGESIZE) == 0);
+        EXPECT(reinterpret_cast<uintptr_t>(B.inner()) % ::sysconf(_SC_PAGESIZE) == 0);
+        EXPECT(reinterpret_cast<uintptr_t>(B.data()) % ::sysconf(_SC_PAGESIZE) == 0);
+
+        Vector x(V(3, 1., 2., 3.));
+        Vector y(3);
+        LinearAlgebraSparse::getBackend("generic").spmv(B, x, y);
+        EXPECT(equal_dense_matrix(y, V(3, -7., 4., 6.)));
+    }
+
+    SECTION("corrupt files") {
+        // stream format is not mappable
+        PathName other = PathName::unique("matrix");
+        A.save(other);
+        EXPECT(!MappedAllocator::isMappable(other));
+        EXPECT_THROWS_AS(MappedAllocator{other}, BadValue);
+        other.unlink();
+
+        // modified entries fail checksum verification only
+        {
+            std::fstream f(path.localPath(), std::ios::in | std::ios::out | std::ios::binary);
+            f.seekp(-1, std::ios::end);
+            f.put('x');
+        }
+        SparseMatrix B(new MappedAllocator(path));
+        EXPECT(B.nonZeros() == A.nonZeros());
+        EXPECT_THROWS_AS(MappedAllocator(path, true), BadValue);
+
+        // truncated
+        EXPECT(::truncate(path.localPath(), static_cast<off_t>(path.size()) - 1) == 0);
+        EXPECT(!MappedAllocator::isMappable(path));
+        EXPECT_THROWS_AS(MappedAllocator{path}, BadValue);
+    }
+
+    path.unlink();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 }  // namespace eckit::test
 
 int main(int argc, char** argv) {
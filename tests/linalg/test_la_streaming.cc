@@ -66,6 +66,32 @@ CASE("test_stream_matrix") {
     stream_test(M(3, 3, 1., 2., 3., 4., 5., 6., 7., 8., 9.));
 }
 
+CASE("test_stream_previous_versions") {
+    // Vector and Matrix values used to be sent as blobs
+    const double values[] = {1., 2., 3., 4., 5., 6.};
+
+    PathName filename = PathName::unique("data");
+    {
+        FileStream sout(filename, "w");
+        auto c = closer(sout);
+        sout << linalg::Size(6);
+        sout.writeBlob(values, sizeof(values));
+        sout << linalg::Size(2) << linalg::Size(3);
+        sout.writeBlob(values, sizeof(values));
+    }
+    {
+        FileStream sin(filename, "r");
+        auto c = closer(sin);
+        linalg::Vector v(sin);
+        test(v, linalg::Vector(values, 6));
+        linalg::Matrix m(sin);
+        test(m, linalg::Matrix(values, 2, 3));
+    }
+    if (filename.exists()) {
+        filename.unlink();
+    }
+}
+
 CASE("test_stream_sparsematrix") {
     std::vector<eckit::linalg::Triplet> triplets;
 
@@ -0,0 +1,126 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "eckit/io/cluster/NodeInfo.h"
+#include "eckit/net/Connector.h"
+#include "eckit/net/MemoizeCache.h"
+#include "eckit/net/TCPServer.h"
+#include "eckit/net/TCPStream.h"
+#include "eckit/utils/StringTools.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::net;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Replies to strings with the same string in upper case, for one connection
+class Server {
+public:
+    Server() :
+        server_(0), requests_(0), thread_([this] { run(); }) {}
+
+    ~Server() { thread_.join(); }
+
+    int port() const { return server_.localPort(); }
+    size_t requests() const { return requests_; }
+
+private:
+    TCPServer server_;
+    std::atomic<size_t> requests_;
+    std::thread thread_;
+
+    void run() {
+        try {
+            InstantTCPStream s(server_.accept());
+            NodeInfo::acceptLogin(s);
+            for (;;) {
+                std::string request;
+                s >> request;
+                requests_++;
+                s << StringTools::upper(request);
+            }
+        }
+        catch (std::exception&) {
+            // the client has left
+        }
+    }
+};
+
+class TestConnector : public Connector {
+public:
+    TestConnector(int port) :
+        Connector("localhost", port, "test") {}
+};
+
+std::string ask(Connector& c, const std::string& request) {
+    AutoMemoize m(c, 60);
+    c << request;
+    std::string reply;
+    c >> reply;
+    return reply;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Connectors memoise replies") {
+    Server server;
+    TestConnector c(server.port());
+
+    EXPECT(ask(c, "hello") == "HELLO");
+    EXPECT(ask(c, "hello") == "HELLO");
+    EXPECT(ask(c, "world") == "WORLD");
+    EXPECT(server.requests() == 2);
+
+    auto stats = c.memoizeCache().statistics();
+    EXPECT(stats.hits_ == 1);
+    EXPECT(stats.inserted_ == 2);
+
+    c.reset();
+}
+
+CASE("Shared caches are not cleared by another connector's reset") {
+    // ECKIT_CONNECTOR_MEMOIZE_SHARED is set by the test
+    Server server;
+    TestConnector a(server.port());
+    TestConnector b(server.port());
+    EXPECT(&a.memoizeCache() == &b.memoizeCache());
+
+    EXPECT(ask(a, "hello") == "HELLO");
+    EXPECT(server.requests() == 1);
+
+    // from the cache, without connecting
+    EXPECT(ask(b, "hello") == "HELLO");
+    EXPECT(server.requests() == 1);
+
+    b.reset();
+    EXPECT(a.memoizeCache().size() == 1);
+    EXPECT(ask(a, "hello") == "HELLO");
+    EXPECT(server.requests() == 1);
+
+    a.reset();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,184 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/net/MemoizeCache.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::net;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string request(size_t i) {
+    return "request " + std::to_string(i);
+}
+
+std::string reply(size_t i) {
+    return std::string(100, char('a' + i % 26)) + std::to_string(i);
+}
+
+void insert(MemoizeCache& cache, size_t i, time_t life = 3600) {
+    std::string q = request(i);
+    std::string r = reply(i);
+    cache.insert(q.data(), q.size(), r.data(), r.size(), life);
+}
+
+MemoizeCache::Reply find(MemoizeCache& cache, size_t i, time_t life = 3600) {
+    std::string q = request(i);
+    return cache.find(q.data(), q.size(), life);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Replies are found by request") {
+    MemoizeCache cache(1000, 1024 * 1024);
+
+    for (size_t i = 0; i < 100; ++i) {
+        insert(cache, i);
+    }
+    EXPECT(cache.size() == 100);
+
+    for (size_t i = 0; i < 100; ++i) {
+        auto r = find(cache, i);
+        EXPECT(r);
+        EXPECT(*r == reply(i));
+    }
+    EXPECT(!find(cache, 100));
+
+    // Prefixes of requests are other requests
+    std::string q = request(1) + "0";
+    EXPECT(*cache.find(q.data(), q.size(), 3600) == reply(10));
+    EXPECT(!cache.find(q.data(), q.size() - 2, 3600));
+
+    auto stats = cache.statistics();
+    EXPECT(stats.hits_ == 101);
+    EXPECT(stats.misses_ == 2);
+    EXPECT(stats.inserted_ == 100);
+
+    // Replaced
+    std::string r = "other";
+    q             = request(5);
+    cache.insert(q.data(), q.size(), r.data(), r.size(), 3600);
+    EXPECT(*find(cache, 5) == "other");
+    EXPECT(cache.size() == 100);
+
+    cache.clear();
+    EXPECT(cache.size() == 0);
+    EXPECT(cache.bytes() == 0);
+    EXPECT(!find(cache, 1));
+}
+
+CASE("Least recently used entries are evicted") {
+    MemoizeCache cache(10, 1024 * 1024);
+
+    for (size_t i = 0; i < 10; ++i) {
+        insert(cache, i);
+    }
+
+    // 0 is the most recently used
+    EXPECT(find(cache, 0));
+
+    insert(cache, 10);
+    insert(cache, 11);
+    EXPECT(cache.size() == 10);
+    EXPECT(find(cache, 0));
+    EXPECT(!find(cache, 1));
+    EXPECT(!find(cache, 2));
+    EXPECT(find(cache, 3));
+    EXPECT(cache.statistics().evicted_ == 2);
+
+    // Replies in use outlive their entries
+    auto r = find(cache, 3);
+    cache.clear();
+    EXPECT(*r == reply(3));
+}
+
+CASE("Caches are limited in bytes") {
+    const size_t entry = request(10).size() + reply(10).size();
+    MemoizeCache cache(1000, 5 * entry);
+
+    for (size_t i = 10; i < 30; ++i) {
+        insert(cache, i);
+        EXPECT(cache.bytes() <= 5 * entry);
+    }
+    EXPECT(cache.size() == 5);
+    EXPECT(find(cache, 29));
+    EXPECT(!find(cache, 24));
+
+    // Too large to be cached
+    std::string q = "large";
+    std::string r(6 * entry, 'x');
+    cache.insert(q.data(), q.size(), r.data(), r.size(), 3600);
+    EXPECT(!cache.find(q.data(), q.size(), 3600));
+    EXPECT(cache.size() == 5);
+}
+
+CASE("Entries expire") {
+    MemoizeCache cache(1000, 1024 * 1024);
+
+    insert(cache, 1, 0);
+    insert(cache, 2, 3600);
+    insert(cache, 3, 3600);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+
+    // The life of the entry
+    EXPECT(!find(cache, 1, 3600));
+
+    // The life of the lookup
+    EXPECT(!find(cache, 2, 1));
+    EXPECT(find(cache, 3, 3600));
+
+    EXPECT(cache.statistics().expired_ == 2);
+    EXPECT(cache.size() == 1);
+}
+
+CASE("Caches are thread-safe") {
+    MemoizeCache cache(50, 1024 * 1024);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, t] {
+            for (size_t i = 0; i < 10000; ++i) {
+                size_t k = (i * 7 + t) % 100;
+                if (auto r = find(cache, k)) {
+                    EXPECT(*r == reply(k));
+                }
+                else {
+                    insert(cache, k);
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT(cache.size() <= 50);
+    auto stats = cache.statistics();
+    EXPECT(stats.hits_ + stats.misses_ == 40000);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,87 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+#include "eckit/net/MultiSocket.h"
+#include "eckit/net/TCPServer.h"
+#include "eckit/net/TCPStream.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::net;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int freePort() {
+    TCPServer server(0);
+    return server.localPort();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Raw data following the handshake is not read ahead") {
+    // ECKIT_TCP_STREAM_BUFFER_SIZE is set by the test
+    EXPECT(TCPStreamBuffer::defaultSize() > 0);
+
+    const size_t streams     = 2;
+    const size_t messageSize = 1024;
+
+    std::vector<char> data(4 * streams * messageSize);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = char(i * 7 + i / 251);
+    }
+
+    int port = freePort();
+    MultiSocket server(port);
+
+    long written = 0;
+    std::thread client([port, &data, &written] {
+        MultiSocket c(streams, messageSize);
+        c.connect("localhost", port);
+        written = c.write(data.data(), long(data.size()));
+        c.close();
+    });
+
+    // The handshakes and the data are all waiting when accepting
+    ::usleep(200000);
+    MultiSocket& s = server.accept();
+
+    std::vector<char> received(data.size());
+    long total = 0;
+    while (total < long(received.size())) {
+        long len = s.read(received.data() + total, long(received.size()) - total);
+        if (len <= 0) {
+            break;
+        }
+        total += len;
+    }
+
+    client.join();
+    EXPECT(written == long(data.size()));
+    EXPECT(total == long(data.size()));
+    EXPECT(received == data);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,237 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/eckit.h"
+#include "eckit/net/NetService.h"
+#include "eckit/net/NetUser.h"
+#include "eckit/net/TCPClient.h"
+#include "eckit/net/TCPStream.h"
+#include "eckit/serialisation/Stream.h"
+#include "eckit/thread/ThreadControler.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::net;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Echoes strings until "bye"
+class EchoUser : public NetUser {
+public:
+    EchoUser(TCPSocket& protocol) :
+        NetUser(protocol) {}
+
+private:
+    void serve(Stream& s, std::istream&, std::ostream&) override {
+        for (;;) {
+            std::string request;
+            s >> request;
+            if (request == "bye") {
+                break;
+            }
+            s << request;
+        }
+    }
+};
+
+class EchoService : public NetService {
+public:
+    EchoService(size_t maxConnections) :
+        NetService(0), maxConnections_(maxConnections) {}
+
+private:
+    size_t maxConnections_;
+
+    NetUser* newUser(TCPSocket& protocol) const override { return new EchoUser(protocol); }
+    std::string name() const override { return "echo"; }
+
+    bool preferToRunAsReactor() const override { return true; }
+    size_t workers() const override { return 4; }
+    size_t maxConnections() const override { return maxConnections_; }
+};
+
+/// Runs the service in its own thread, until the end of the scope
+class Running {
+public:
+    Running(size_t maxConnections) :
+        service_(new EchoService(maxConnections)), controler_(service_, false) {
+        controler_.start();
+    }
+
+    ~Running() {
+        controler_.stop();
+        controler_.wait();
+    }
+
+    int port() const { return service_->port(); }
+
+    NetService::Statistics statistics() const { return service_->statistics(); }
+
+    /// Statistics, once the condition holds or after 10 seconds
+    NetService::Statistics wait(const std::function<bool(const NetService::Statistics&)>& condition) const {
+        for (size_t i = 0; i < 1000; ++i) {
+            NetService::Statistics stats = statistics();
+            if (condition(stats)) {
+                return stats;
+            }
+            ::usleep(10000);
+        }
+        return statistics();
+    }
+
+private:
+    EchoService* service_;
+    ThreadControler controler_;
+};
+
+void echo(TCPStream& s, const std::string& request) {
+    s << request;
+    std::string reply;
+    s >> reply;
+    EXPECT(reply == request);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+#if eckit_HAVE_EPOLL
+
+CASE("Many short-lived clients") {
+    Running service(1024);
+
+    std::vector<std::thread> clients;
+    for (size_t i = 0; i < 8; ++i) {
+        clients.emplace_back([&service, i] {
+            for (size_t j = 0; j < 25; ++j) {
+                TCPClient client;
+                TCPStream s(client.connect("localhost", service.port()));
+                echo(s, "hello " + std::to_string(i) + " " + std::to_string(j));
+                echo(s, "again");
+                s << "bye";
+            }
+        });
+    }
+    for (auto& t : clients) {
+        t.join();
+    }
+
+    auto stats = service.wait([](const NetService::Statistics& s) { return s.served_ == 200; });
+    EXPECT(stats.accepted_ == 200);
+    EXPECT(stats.served_ == 200);
+    EXPECT(stats.failed_ == 0);
+    EXPECT(stats.active_ == 0);
+    EXPECT(stats.limited_ == 0);
+}
+
+CASE("Connections above the limit wait in the backlog") {
+    Running service(2);
+
+    std::vector<std::unique_ptr<TCPStream>> streams;
+    for (size_t i = 0; i < 4; ++i) {
+        TCPClient client;
+        streams.emplace_back(new TCPStream(client.connect("localhost", service.port())));
+    }
+
+    auto stats = service.wait([](const NetService::Statistics& s) { return s.accepted_ == 2; });
+    ::usleep(100000);
+    stats = service.statistics();
+    EXPECT(stats.accepted_ == 2);
+    EXPECT(stats.active_ == 2);
+    EXPECT(stats.limited_ == 1);
+
+    // The waiting clients are accepted as the first ones leave
+    for (auto& s : streams) {
+        echo(*s, "hello");
+        *s << "bye";
+    }
+
+    stats = service.wait([](const NetService::Statistics& s) { return s.served_ == 4; });
+    EXPECT(stats.accepted_ == 4);
+    EXPECT(stats.served_ == 4);
+    EXPECT(stats.active_ == 0);
+}
+
+CASE("Clients leaving without a request") {
+    Running service(16);
+
+    {
+        TCPClient client;
+        TCPStream s(client.connect("localhost", service.port()));
+    }
+
+    {
+        TCPClient client;
+        TCPStream s(client.connect("localhost", service.port()));
+        echo(s, "hello");
+    }
+
+    auto stats = service.wait([](const NetService::Statistics& s) { return s.active_ == 0 && s.accepted_ == 2; });
+    EXPECT(stats.accepted_ == 2);
+    EXPECT(stats.abandoned_ == 1);  // without a request
+    EXPECT(stats.failed_ == 1);     // without "bye"
+    EXPECT(stats.active_ == 0);
+}
+
+CASE("Clients reset before being accepted") {
+    Running service(1);
+
+    TCPClient first;
+    TCPStream s(first.connect("localhost", service.port()));
+    echo(s, "hello");
+
+    // Waits in the backlog, as the limit is reached, and resets
+    {
+        TCPClient client;
+        TCPSocket& socket = client.connect("localhost", service.port());
+        linger l{1, 0};
+        EXPECT(::setsockopt(socket.socket(), SOL_SOCKET, SO_LINGER, &l, sizeof(l)) == 0);
+        socket.close();
+    }
+
+    s << "bye";
+
+    // The service carries on
+    {
+        TCPClient client;
+        TCPStream t(client.connect("localhost", service.port()));
+        echo(t, "again");
+        t << "bye";
+    }
+
+    auto stats = service.wait([](const NetService::Statistics& s) { return s.served_ == 2 && s.active_ == 0; });
+    EXPECT(stats.served_ == 2);
+    EXPECT(stats.failed_ == 0);
+    EXPECT(stats.active_ == 0);
+    // if the kernel had not dropped it, the client was accepted, and found closed
+    EXPECT(stats.accepted_ == 2 + stats.abandoned_);
+}
+
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,173 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/log/Log.h"
+#include "eckit/log/Timer.h"
+#include "eckit/net/TCPClient.h"
+#include "eckit/net/TCPServer.h"
+#include "eckit/net/TCPStream.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::net;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Answers requests of many small values, as a typical client/server protocol does, until "quit"
+class Server {
+public:
+    Server(size_t bufferSize) :
+        server_(0), thread_([this, bufferSize] { serve(bufferSize); }) {}
+
+    ~Server() { thread_.join(); }
+
+    int port() const { return server_.localPort(); }
+
+private:
+    void serve(size_t bufferSize) {
+        TCPStream s(server_.accept());
+        s.buffered(bufferSize);
+
+        for (;;) {
+            std::string request;
+            s >> request;
+            if (request == "quit") {
+                break;
+            }
+
+            long count;
+            s >> count;
+
+            double sum = 0;
+            std::vector<std::string> names;
+            for (long i = 0; i < count; ++i) {
+                double value;
+                std::string name;
+                s >> value;
+                s >> name;
+                sum += value;
+                names.push_back(name);
+            }
+
+            std::string blob;
+            s >> blob;
+
+            s << request;
+            s << sum;
+            for (const auto& name : names) {
+                s << name;
+            }
+            s << blob;
+        }
+    }
+
+    TCPServer server_;
+    std::thread thread_;
+};
+
+/// Sends a request and checks the reply
+void roundTrip(Stream& s, long count, size_t blobSize = 10) {
+    std::string request = "request-" + std::to_string(count);
+    std::string blob(blobSize, 'x');
+    for (size_t i = 0; i < blobSize; ++i) {
+        blob[i] = char(i % 251);
+    }
+
+    s << request;
+    s << count;
+    double sum = 0;
+    for (long i = 0; i < count; ++i) {
+        s << double(i);
+        s << "name-" + std::to_string(i);
+        sum += double(i);
+    }
+    s << blob;
+
+    std::string reply;
+    double replySum;
+    s >> reply;
+    s >> replySum;
+    EXPECT(reply == request);
+    EXPECT(replySum == sum);
+    for (long i = 0; i < count; ++i) {
+        std::string name;
+        s >> name;
+        EXPECT(name == "name-" + std::to_string(i));
+    }
+    std::string replyBlob;
+    s >> replyBlob;
+    EXPECT(replyBlob == blob);
+}
+
+/// @returns microseconds per round trip
+double exchange(size_t clientBufferSize, size_t serverBufferSize, size_t trips, long count, size_t blobSize = 10) {
+    Server server(serverBufferSize);
+
+    TCPClient client;
+    TCPStream s(client.connect("localhost", server.port()));
+    s.buffered(clientBufferSize);
+
+    Timer timer("exchange", Log::debug());
+    for (size_t i = 0; i < trips; ++i) {
+        roundTrip(s, count, blobSize);
+    }
+    double elapsed = timer.elapsed();
+
+    s << "quit";
+    s.flush();
+
+    return elapsed * 1e6 / double(trips);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Buffered and unbuffered streams interoperate") {
+    const size_t sizes[] = {0, 16, 4096, 64 * 1024};
+    for (size_t client : sizes) {
+        for (size_t server : sizes) {
+            exchange(client, server, 3, 50);
+        }
+    }
+}
+
+CASE("Values larger than the buffer") {
+    for (size_t blob : {size_t(1000), size_t(4096), size_t(5000), size_t(3 * 1024 * 1024 + 7)}) {
+        exchange(4096, 4096, 2, 10, blob);
+        exchange(0, 4096, 2, 10, blob);
+        exchange(4096, 0, 2, 10, blob);
+    }
+}
+
+CASE("Buffered writes are sent when the stream is destroyed") {
+    Server server(4096);
+    {
+        TCPClient client;
+        TCPStream s(client.connect("localhost", server.port()));
+        s.buffered(4096);
+        s << "quit";
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
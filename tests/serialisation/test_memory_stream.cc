@@ -0,0 +1,185 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <cstring>
+#include <string>
+
+#include "eckit/filesystem/PathName.h"
+#include "eckit/io/AutoCloser.h"
+#include "eckit/io/Buffer.h"
+#include "eckit/io/SharedBuffer.h"
+#include "eckit/serialisation/BadTag.h"
+#include "eckit/serialisation/FileStream.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/serialisation/ResizableMemoryStream.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string payload(size_t size) {
+    std::string s(size, 0);
+    for (size_t i = 0; i < size; ++i) {
+        s[i] = char(i * 31 + i / 256);
+    }
+    return s;
+}
+
+/// A message with a string, a blob and a large blob
+void encode(Stream& s, const std::string& data) {
+    s << std::string("header");
+    s << data;
+    s.writeBlob(data.data(), data.size());
+    s.writeLargeBlob(data.data(), data.size());
+    s << std::string("trailer");
+}
+
+bool inside(const SharedBufferView& v, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    const char* q = static_cast<const char*>(v.data());
+    return q >= p && q + v.size() <= p + size;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Views of a MemoryStream point into its memory") {
+    const std::string data = payload(100000);
+
+    Buffer buffer(64);
+    ResizableMemoryStream out(buffer);
+    encode(out, data);
+
+    MemoryStream s(buffer.data(), out.position());
+
+    std::string header;
+    s >> header;
+    EXPECT(header == "header");
+
+    for (int i = 0; i < 3; ++i) {
+        SharedBufferView v = s.readView();
+        EXPECT(v.size() == data.size());
+        EXPECT(v.str() == data);
+        EXPECT(inside(v, buffer.data(), out.position()));
+    }
+
+    std::string trailer;
+    s >> trailer;
+    EXPECT(trailer == "trailer");
+}
+
+CASE("Views keep a SharedBuffer alive") {
+    const std::string data = payload(1000);
+
+    SharedBufferView view;
+    SharedBufferView slice;
+    {
+        SharedBuffer buffer(64);
+        size_t size;
+        {
+            ResizableMemoryStream out(buffer);
+            encode(out, data);
+            size = out.position();
+        }
+
+        MemoryStream s(buffer);
+        std::string header;
+        s >> header;
+        view = s.readView();
+        EXPECT(inside(view, buffer.data(), size));
+
+        slice = view.slice(10, 20);
+        EXPECT(buffer->count() == 4);  // buffer, stream, view and slice
+    }
+
+    // The buffer is only referenced by the views
+    EXPECT(view.str() == data);
+    EXPECT(slice.str() == data.substr(10, 20));
+
+    SharedBufferView copy(slice);
+    slice = SharedBufferView();
+    view  = copy;
+    EXPECT(view.str() == data.substr(10, 20));
+}
+
+CASE("Views of a ResizableMemoryStream") {
+    const std::string data = payload(5000);
+
+    SharedBuffer buffer(64);
+    ResizableMemoryStream s(buffer);
+    encode(s, data);
+    s.rewind();
+
+    std::string header;
+    s >> header;
+    SharedBufferView v = s.readView();
+    EXPECT(v.str() == data);
+    EXPECT(inside(v, buffer.data(), buffer.size()));
+    EXPECT(buffer->count() == 3);
+}
+
+CASE("Views of other streams are copies") {
+    const std::string data = payload(10000);
+
+    PathName path = PathName::unique("data");
+    {
+        FileStream out(path, "w");
+        auto c = closer(out);
+        encode(out, data);
+    }
+
+    {
+        FileStream s(path, "r");
+        auto c = closer(s);
+        std::string header;
+        s >> header;
+        for (int i = 0; i < 3; ++i) {
+            EXPECT(s.readView().str() == data);
+        }
+        std::string trailer;
+        s >> trailer;
+        EXPECT(trailer == "trailer");
+    }
+
+    path.unlink();
+}
+
+CASE("Views of other values are refused") {
+    Buffer buffer(64);
+    ResizableMemoryStream out(buffer);
+    out << 42;
+
+    MemoryStream s(buffer.data(), out.position());
+    EXPECT_THROWS_AS(s.readView(), BadTag);
+}
+
+CASE("Views of truncated messages are refused") {
+    const std::string data = payload(1000);
+
+    Buffer buffer(64);
+    ResizableMemoryStream out(buffer);
+    out << data;
+
+    MemoryStream s(buffer.data(), out.position() - 1);
+    EXPECT_THROWS_AS(s.readView(), ReadError);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,208 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/serialisation/ResizableMemoryStream.h"
+#include "eckit/types/Types.h"
+#include "eckit/value/Value.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T>
+std::vector<T> values(size_t count) {
+    std::vector<T> v(count);
+    for (size_t i = 0; i < count; ++i) {
+        v[i] = T(i * 7 + 1) - (i % 3 == 0 ? T(i / 2) : T(0));
+    }
+    if (count > 0) {
+        v.back() = std::numeric_limits<T>::max();
+    }
+    return v;
+}
+
+/// @returns the number of bytes of the encoding
+template <typename T>
+size_t roundTrip(const T& in) {
+    Buffer buffer(64);
+    ResizableMemoryStream out(buffer);
+    out << in;
+    out << std::string("end");
+
+    MemoryStream s(buffer.data(), out.position());
+    T result;
+    s >> result;
+    EXPECT(result == in);
+
+    std::string end;
+    s >> end;
+    EXPECT(end == "end");
+
+    return out.position();
+}
+
+template <typename T>
+void roundTrips() {
+    for (size_t count : {0, 1, 2, 1000, 100003}) {
+        auto v       = values<T>(count);
+        size_t bytes = roundTrip(v);
+        // tag, byte order, size of values, count and the values, and "end"
+        EXPECT(bytes == 1 + 1 + 1 + 8 + count * sizeof(T) + 1 + 4 + 3);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Vectors of numbers are sent as arrays") {
+    roundTrips<char>();
+    roundTrips<unsigned char>();
+    roundTrips<short>();
+    roundTrips<unsigned short>();
+    roundTrips<int>();
+    roundTrips<unsigned int>();
+    roundTrips<long>();
+    roundTrips<unsigned long>();
+    roundTrips<long long>();
+    roundTrips<unsigned long long>();
+    roundTrips<float>();
+    roundTrips<double>();
+
+    // Not numbers
+    roundTrip(std::vector<std::string>{"a", "bc", "def"});
+    roundTrip(std::vector<bool>{true, false, true});
+}
+
+CASE("Vectors of other numbers are sent element by element") {
+    // no array tag for signed char, sent as int values
+    std::vector<signed char> in{-1, 2, -3};
+
+    Buffer buffer(64);
+    ResizableMemoryStream out(buffer);
+    out << in;
+
+    MemoryStream s(buffer.data(), out.position());
+    std::vector<int> result;
+    s >> result;
+    EXPECT(result == std::vector<int>({-1, 2, -3}));
+}
+
+CASE("Vectors encoded by previous versions are decoded") {
+    auto doubles = values<double>(1000);
+    auto ints    = values<int>(1000);
+
+    Buffer buffer(64);
+    ResizableMemoryStream out(buffer);
+
+    out << Ordinal(doubles.size());
+    for (double d : doubles) {
+        out << d;
+    }
+    out << Ordinal(ints.size());
+    for (int i : ints) {
+        out << i;
+    }
+
+    MemoryStream s(buffer.data(), out.position());
+    std::vector<double> d;
+    std::vector<int> i;
+    s >> d;
+    s >> i;
+    EXPECT(d == doubles);
+    EXPECT(i == ints);
+}
+
+CASE("Arrays of the other byte order are swapped") {
+    auto v = values<int>(1000);
+
+    Buffer buffer(64);
+    ResizableMemoryStream out(buffer);
+    out << v;
+
+    // The sender had the other byte order: flip the flag and swap the values
+    const size_t header = 1 + 1 + 1 + 8;
+    char* p             = buffer;
+    p[1]                = char(1 - p[1]);
+    for (size_t i = 0; i < v.size(); ++i) {
+        std::reverse(p + header + i * sizeof(int), p + header + (i + 1) * sizeof(int));
+    }
+
+    MemoryStream s(buffer.data(), out.position());
+    std::vector<int> result;
+    s >> result;
+    EXPECT(result == v);
+}
+
+CASE("Arrays of other types are not read") {
+    Buffer buffer(64);
+    ResizableMemoryStream out(buffer);
+    out << values<int>(10);
+
+    MemoryStream s(buffer.data(), out.position());
+
+    size_t count;
+    EXPECT(!s.startArray<double>(count));
+    EXPECT(!s.startArray<long>(count));
+    EXPECT(s.startArray<int>(count));
+    EXPECT(count == 10);
+
+    std::vector<int> v(count);
+    s.readArray(v.data(), count);
+    EXPECT(v == values<int>(10));
+}
+
+CASE("Lists of numbers in Values") {
+    ValueList integers;
+    ValueList doubles;
+    ValueList mixed;
+    for (int i = 0; i < 100; ++i) {
+        integers.push_back(Value(i * 1000000000LL));
+        doubles.push_back(Value(i * 0.5));
+        mixed.push_back(i % 2 ? Value(i) : Value(std::to_string(i)));
+    }
+
+    for (const auto& list : {integers, doubles, mixed, ValueList{}}) {
+        Value v(list);
+
+        Buffer buffer(64);
+        ResizableMemoryStream out(buffer);
+        out << v;
+
+        MemoryStream s(buffer.data(), out.position());
+        Value result(s);
+        EXPECT(result == v);
+        EXPECT(result.size() == list.size());
+        for (size_t i = 0; i < list.size(); ++i) {
+            EXPECT(result[i].isNumber() == list[i].isNumber());
+            EXPECT(result[i].isDouble() == list[i].isDouble());
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -0,0 +1,110 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/linalg/Matrix.h"
+#include "eckit/linalg/Vector.h"
+#include "eckit/serialisation/MemoryStream.h"
+#include "eckit/serialisation/ResizableMemoryStream.h"
+#include "eckit/types/Types.h"
+#include "eckit/value/Value.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// ECKIT_STREAM_LEGACY_ARRAYS is set by the test, as during an upgrade, so that previous versions can read
+
+CASE("Vectors are written element by element") {
+    EXPECT(!Stream::writeArrays());
+
+    std::vector<int> in{1, -2, 3};
+
+    Buffer buffer(64);
+    ResizableMemoryStream out(buffer);
+    out << in;
+
+    MemoryStream s(buffer.data(), out.position());
+    size_t count;
+    EXPECT(!s.startArray<int>(count));
+
+    Ordinal size;
+    s >> size;
+    EXPECT(size == 3);
+    for (int i : in) {
+        int v;
+        s >> v;
+        EXPECT(v == i);
+    }
+}
+
+CASE("Vector and Matrix are written as blobs") {
+    linalg::Vector v(3);
+    v.fill(2.);
+    linalg::Matrix m(2, 2);
+    m.fill(3.);
+
+    Buffer buffer(64);
+    ResizableMemoryStream out(buffer);
+    out << v;
+    out << m;
+
+    MemoryStream s(buffer.data(), out.position());
+    linalg::Size length;
+    s >> length;
+    EXPECT(length == 3);
+
+    size_t count;
+    EXPECT(!s.startArray<linalg::Scalar>(count));
+
+    std::vector<linalg::Scalar> values(3);
+    s.readBlob(values.data(), values.size() * sizeof(linalg::Scalar));
+    EXPECT(values == std::vector<linalg::Scalar>(3, 2.));
+
+    // and read back
+    linalg::Matrix result(s);
+    EXPECT(result.rows() == 2);
+    EXPECT(result(1, 1) == 3.);
+}
+
+CASE("Lists of numbers in Values are written element by element") {
+    ValueList values;
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(Value(i));
+    }
+    Value list(values);
+
+    Buffer buffer(64);
+    ResizableMemoryStream out(buffer);
+    out << list;
+
+    MemoryStream s(buffer.data(), out.position());
+    Value result(s);
+    EXPECT(result == list);
+
+    // each value with its class and tags, rather than 8 bytes as an array
+    EXPECT(out.position() > 1000 * 16);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char** argv) {
+    return run_tests(argc, argv);
+}
@@ -98,7 +98,7 @@ CASE("Test compression performance") {
     data.emplace_back("u-v_6ml.grib", "GRIB u/v layers (10-15)");
     data.emplace_back("q_6ml_regrid.grib", "GRIB q 6 layers (10-15) re-gridded");
 
-    std::vector<std::string> compressors{"none", "lz4", "snappy", "aec", "bzip2"};
+    std::vector<std::string> compressors{"none", "lz4", "snappy", "aec", "bzip2", "zstd"};
 
     constexpr int N = 5;  // Number of iterations to use for each case
 
@@ -0,0 +1,160 @@
+/*
+ * (C) Copyright 1996- ECMWF.
+ *
+ * This software is licensed under the terms of the Apache Licence Version 2.0
+ * which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+ * In applying this licence, ECMWF does not waive the privileges and immunities
+ * granted to it by virtue of its status as an intergovernmental organisation nor
+ * does it submit to any jurisdiction.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eckit/io/Buffer.h"
+#include "eckit/utils/ZstdCompressor.h"
+
+#include "eckit/testing/Test.h"
+
+using namespace std;
+using namespace eckit;
+using namespace eckit::testing;
+
+namespace eckit::test {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/// Small, similar messages, such as metadata records
+std::vector<std::string> messages(size_t count) {
+    std::vector<std::string> result;
+    for (size_t i = 0; i < count; ++i) {
+        std::ostringstream s;
+        s << "{\"class\":\"od\",\"expver\":\"0001\",\"stream\":\"oper\",\"date\":\"2024" << (i % 12 + 10) << "01\","
+          << "\"time\":\"" << (i % 4) * 6 << "00\",\"type\":\"fc\",\"levtype\":\"pl\",\"levelist\":\"" << (i % 37) * 25
+          << "\",\"param\":\"" << 129 + i % 7 << "\",\"step\":\"" << i % 240 << "\",\"domain\":\"g\"}";
+        result.push_back(s.str());
+    }
+    return result;
+}
+
+size_t roundTrip(const ZstdCompressor& c, const void* in, size_t len) {
+    Buffer compressed;
+    Buffer uncompressed;
+    size_t clen = c.compress(in, len, compressed);
+    c.uncompress(compressed, clen, uncompressed, len);
+    EXPECT(std::memcmp(uncompressed, in, len) == 0);
+    return clen;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+CASE("Compression levels") {
+    std::vector<char> data(1024 * 1024);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = char((i * i) % 251 / 16);
+    }
+
+    size_t fast = roundTrip(ZstdCompressor(1), data.data(), data.size());
+    size_t best = roundTrip(ZstdCompressor(19), data.data(), data.size());
+    EXPECT(best <= fast);
+    EXPECT(fast < data.size());
+
+    roundTrip(ZstdCompressor(-5), data.data(), data.size());
+
+    EXPECT_THROWS_AS(ZstdCompressor(1000), BadValue);
+}
+
+CASE("Contexts are reused") {
+    ZstdCompressor c(3);
+    for (const auto& m : messages(100)) {
+        roundTrip(c, m.data(), m.size());
+    }
+}
+
+CASE("Compressors shared between threads") {
+    auto samples = messages(500);
+
+    ZstdCompressor c(3);
+    std::atomic<size_t> failed(0);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 8; ++t) {
+        threads.emplace_back([&c, &samples, &failed] {
+            Buffer compressed;
+            Buffer uncompressed;
+            for (const auto& m : samples) {
+                size_t clen = c.compress(m.data(), m.size(), compressed);
+                c.uncompress(compressed, clen, uncompressed, m.size());
+                if (std::memcmp(uncompressed, m.data(), m.size()) != 0) {
+                    failed++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT(failed == 0);
+}
+
+CASE("Large buffers with workers") {
+    std::vector<char> data(16 * 1024 * 1024);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = char(i / 1000 + i % 7);
+    }
+
+    // Whether libzstd is multithreaded or not, the output is the same
+    ZstdCompressor c(3, 4, 1024 * 1024);
+    roundTrip(c, data.data(), data.size());
+}
+
+CASE("Trained dictionaries") {
+    auto samples = messages(2000);
+
+    ZstdCompressor::Samples s;
+    for (const auto& m : samples) {
+        s.emplace_back(m.data(), m.size());
+    }
+
+    Buffer dict = ZstdCompressor::trainDictionary(s, 16 * 1024);
+    EXPECT(dict.size() > 0);
+    EXPECT(dict.size() <= 16 * 1024);
+
+    ZstdCompressor plain(3);
+    ZstdCompressor trained(3);
+    trained.dictionary(dict, dict.size());
+
+    size_t plainSize   = 0;
+    size_t trainedSize = 0;
+    for (const auto& m : messages(50)) {
+        plainSize += roundTrip(plain, m.data(), m.size());
+        trainedSize += roundTrip(trained, m.data(), m.size());
+    }
+
+    EXPECT(trainedSize < plainSize);
+
+    // Another compressor with the same dictionary can uncompress
+    ZstdCompressor other(1);
+    other.dictionary(dict, dict.size());
+
+    const auto& m = samples.front();
+    Buffer compressed;
+    Buffer uncompressed;
+    size_t clen = trained.compress(m.data(), m.size(), compressed);
+    other.uncompress(compressed, clen, uncompressed, m.size());
+    EXPECT(std::memcmp(uncompressed, m.data(), m.size()) == 0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+}  // namespace eckit::test
+
+int main(int argc, char* argv[]) {
+    return run_tests(argc, argv);
+}